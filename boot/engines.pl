@@ -38,12 +38,17 @@
             engine_next_reified/2, % +Engine, -Term
             engine_yield/1,        % +Term
             engine_self/1,         % -Engine
-            current_engine/1       % ?Engine
+            current_engine/1,      % ?Engine
+            engine_pool_create/2,  % +Pool, +Options
+            engine_pool_destroy/1, % +Pool
+            engine_checkout/4,     % +Pool, ?Template, :Goal, -Engine
+            engine_checkin/1       % +Engine
           ]).
 
 :- meta_predicate
     engine_create(?, 0, -),
-    engine_create(?, 0, -, +).
+    engine_create(?, 0, -, +),
+    engine_checkout(+, ?, 0, -).
 
 /** <module> Engine (interactor) support
 
@@ -138,6 +143,106 @@ engine_self(E) :-
 current_engine(E) :-
     thread_property(E, engine(true)).
 
+
+		 /*******************************
+		 *            POOLS		*
+		 *******************************/
+
+:- dynamic
+    engine_pool/3,                  % Pool, Queue, EngineOptions
+    pooled_engine/2.                % Engine, Pool
+:- volatile
+    engine_pool/3,
+    pooled_engine/2.
+
+%!  engine_pool_create(+Pool, +Options) is det.
+%
+%   Create a pool of reusable engines named Pool.  Idle engines are kept
+%   in a message queue that is bounded   by  the size(Count) option. The
+%   stack_limit(Bytes) option is passed to the engines of the pool.
+
+engine_pool_create(Pool, Options) :-
+    '$must_be'(atom, Pool),
+    '$must_be'(list, Options),
+    '$option'(size(Size), Options, 8),
+    '$must_be'(integer, Size),
+    (   Size >= 1
+    ->  true
+    ;   '$domain_error'(not_less_than_one, Size)
+    ),
+    (   '$option'(stack_limit(Limit), Options)
+    ->  EngineOptions = [stack_limit(Limit)]
+    ;   EngineOptions = []
+    ),
+    with_mutex('$engine_pool',
+               create_engine_pool(Pool, Size, EngineOptions)).
+
+create_engine_pool(Pool, _, _) :-
+    engine_pool(Pool, _, _),
+    !,
+    '$permission_error'(create, engine_pool, Pool).
+create_engine_pool(Pool, Size, EngineOptions) :-
+    message_queue_create(Queue, [max_size(Size)]),
+    assertz(engine_pool(Pool, Queue, EngineOptions)).
+
+%!  engine_pool_destroy(+Pool) is det.
+%
+%   Destroy Pool and its idle engines.   Engines of Pool that are checked
+%   out are destroyed when they are checked in.
+
+engine_pool_destroy(Pool) :-
+    '$must_be'(atom, Pool),
+    (   retract(engine_pool(Pool, Queue, _))
+    ->  destroy_idle_engines(Queue),
+        message_queue_destroy(Queue)
+    ;   '$existence_error'(engine_pool, Pool)
+    ).
+
+destroy_idle_engines(Queue) :-
+    (   thread_get_message(Queue, Engine, [timeout(0)])
+    ->  discard_engine(Engine),
+        destroy_idle_engines(Queue)
+    ;   true
+    ).
+
+discard_engine(Engine) :-
+    retractall(pooled_engine(Engine, _)),
+    engine_destroy(Engine).
+
+%!  engine_checkout(+Pool, ?Template, :Goal, -Engine) is det.
+%
+%   As engine_create/3, using an idle engine from Pool if available.
+
+engine_checkout(Pool, Template, Goal, Engine) :-
+    (   engine_pool(Pool, Queue, EngineOptions)
+    ->  true
+    ;   '$existence_error'(engine_pool, Pool)
+    ),
+    (   thread_get_message(Queue, Engine0, [timeout(0)])
+    ->  '$engine_reset'(Engine0, Template+Goal)
+    ;   '$engine_create'(Engine0, Template+Goal,
+                         [reusable(true)|EngineOptions]),
+        assertz(pooled_engine(Engine0, Pool))
+    ),
+    Engine = Engine0.
+
+%!  engine_checkin(+Engine) is det.
+%
+%   Reset Engine and return it to its pool. If the pool is full or no
+%   longer exists, Engine is destroyed.
+
+engine_checkin(Engine) :-
+    (   pooled_engine(Engine, Pool)
+    ->  '$engine_reset'(Engine),
+        (   engine_pool(Pool, Queue, _),
+            catch(thread_send_message(Queue, Engine, [timeout(0)]),
+                  error(existence_error(_,_), _), fail)
+        ->  true
+        ;   discard_engine(Engine)
+        )
+    ;   '$existence_error'(pooled_engine, Engine)
+    ).
+
 %!  '$engine_yield'(?Term, +Code:integer)
 %
 %   Cause PL_next_solution() to return with   Code, providing access
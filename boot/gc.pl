@@ -41,7 +41,9 @@ system:'$gc' :-
 %!  gc_loop
 %
 %   Wait for signals from other threads  to perform global GC operations
-%   and do them for them.
+%   and do them for them.  The request is cleared before processing
+%   it such that an incremental clause GC slice can ask for the next
+%   slice.
 %
 %   When using [tcmalloc](https://github.com/google/tcmalloc)   we  call
 %   MallocExtension_MarkThreadIdle() to transfer the   collected  memory
@@ -52,14 +54,15 @@ gc_loop :-
     thread_idle('$gc_wait'(Action), short),
     (   Action == abort
     ->  true
-    ;   process(Action)
-    ->  '$gc_clear'(Action),
-        fail
-    ;   print_message(warning, gc(ignored(Action))),
+    ;   '$gc_clear'(Action),
+        (   process(Action)
+        ->  true
+        ;   print_message(warning, gc(ignored(Action)))
+        ),
         fail
     ).
 
 process(garbage_collect_atoms) :-
     garbage_collect_atoms.
 process(garbage_collect_clauses) :-
-    garbage_collect_clauses.
+    '$cgc_slice'.
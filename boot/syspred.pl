@@ -75,6 +75,7 @@
             call_with_inference_limit/3,        % :Goal, +Limit, -Result
             rule/2,                             % :Head, -Rule
             rule/3,                             % :Head, -Rule, ?Ref
+            range_call/4,                       % :Head, +Arg, ?Low, ?High
             numbervars/3,                       % +Term, +Start, -End
             term_string/3,                      % ?Term, ?String, +Options
             nb_setval/2,                        % +Var, +Value
@@ -88,6 +89,7 @@
             snapshot/1,                         % :Goal
             undo/1,                             % :Goal
             set_prolog_gc_thread/1,		% +Status
+            memory_usage/2,                     % ?Object, -Usage
 
             '$wrap_predicate'/5                 % :Head, +Name, -Closure, -Wrapped, +Body
           ]).
@@ -99,6 +101,7 @@
     snapshot(0),
     rule(:, -),
     rule(:, -, ?),
+    range_call(:, +, ?, ?),
     sig_block(:),
     sig_unblock(:).
 
@@ -1329,6 +1332,79 @@ stack_property(min_free).
 stack_property(low).
 stack_property(factor).
 
+%!  memory_usage(?Object, -Usage) is nondet.
+%
+%   Usage is a list of Category-Bytes  pairs   that  describe the memory
+%   accounted to Object, ending  in   total-Bytes.  Object is one of
+%
+%     - predicate(:PI)
+%       Memory used by the live clauses, clause indexes and code of a
+%       predicate.
+%     - module(?Module)
+%       Roll-up of all predicates defined in Module and the module's
+%       own tables.
+%     - thread(?Thread)
+%       Breakdown of thread_property(Thread, size(Bytes)).
+%     - system
+%       Global memory.  If known, total is statistics(heapused).
+%
+%   If the argument of Object is unbound, the  objects are enumerated.
+%   The accounting  is  maintained  incrementally,  so  this  does  not
+%   traverse clause lists.
+
+memory_usage(Object, Usage) :-
+    memory_object(Object),
+    object_memory(Object, Usage0),
+    sum_usage(Usage0, 0, Sum),
+    (   Object == system
+    ->  statistics(heapused, Heap),
+        Total is max(Heap, Sum)
+    ;   Total = Sum
+    ),
+    '$append'(Usage0, [total-Total], Usage).
+
+memory_object(predicate(PI)) :-
+    (   var(PI)
+    ->  current_predicate(M:Name/Arity),
+        functor(Head, Name, Arity),
+        \+ predicate_property(M:Head, imported_from(_)),
+        PI = M:Name/Arity
+    ;   true
+    ).
+memory_object(module(M)) :-
+    current_module(M).
+memory_object(thread(T)) :-
+    current_prolog_flag(threads, true),
+    (   var(T)
+    ->  thread_property(T, status(running))
+    ;   true
+    ).
+memory_object(system).
+
+object_memory(predicate(PI), [clauses-C, indexes-I, code-P]) :-
+    strip_module(user:PI, M, PI1),
+    '$pi_head'(M:PI1, Head),
+    '$predicate_memory'(Head, memory(C, I, P)).
+object_memory(module(M), [clauses-C, indexes-I, code-P, module-T]) :-
+    '$module_memory'(M, memory(C, I, P, T)).
+object_memory(thread(Id), [ stacks-S, predicates-P, tables-T,
+                            queue-Q, thread-D
+                          ]) :-
+    '$thread_memory'(Id, memory(S, P, T, Q, D)).
+object_memory(system, [ atoms-A, functors-F, stacks-S,
+                        erased_clauses-E, slab_free-SF
+                      ]) :-
+    statistics(atom_space, A),
+    statistics(functor_space, F),
+    statistics(stack, S),
+    statistics(erased_space, E),
+    statistics(slab_free, SF).
+
+sum_usage([], Sum, Sum).
+sum_usage([_-V|T], Sum0, Sum) :-
+    Sum1 is Sum0+V,
+    sum_usage(T, Sum1, Sum).
+
 
 		 /*******************************
 		 *            CLAUSE		*
@@ -1372,6 +1448,49 @@ split_on_cut(_, _, _) =>
     fail.
 
 
+                 /*******************************
+                 *         RANGE QUERIES        *
+                 *******************************/
+
+%!  range_call(:Head, +Arg, ?Low, ?High) is nondet.
+%
+%   Call Head, restricted to solutions where the Arg-th argument of Head
+%   is in the range Low..High (inclusive, using the standard order of
+%   terms).  An unbound Low or High makes the range open at that side.
+%   This is the same as
+%
+%       call(Head), arg(Arg, Head, A), Low @=< A, A @=< High
+%
+%   but uses an ordered index on  Arg   to  only  consider clauses that
+%   may be in the range.  Solutions are  enumerated in standard order
+%   of the argument rather than in clause order.
+
+range_call(M:Head, Arg, Low, High) :-
+    (   '$define_predicate'(M:Head)
+    ->  true
+    ;   true
+    ),
+    (   '$get_predicate_attribute'(M:Head, imported, DM)
+    ->  true
+    ;   DM = M
+    ),
+    '$range_clause'(M:Head, Arg, Low, High, Ref),
+    '$clause'(DM:Head, Body, Ref, _Bindings),
+    DM:Body,
+    arg(Arg, Head, A),
+    in_range(Low, A, High).
+
+in_range(Low, A, High) :-
+    (   var(Low)
+    ->  true
+    ;   Low @=< A
+    ),
+    (   var(High)
+    ->  true
+    ;   A @=< High
+    ).
+
+
                  /*******************************
                  *             TERM             *
                  *******************************/
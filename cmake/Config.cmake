@@ -437,6 +437,9 @@ endif()
 if(VMI_FUNCTIONS)
   set(O_VMI_FUNCTIONS 1)
 endif()
+if(VMI_PAIR_PROFILE)
+  set(O_VMI_PAIR_PROFILE 1)
+endif()
 if(STATIC_EXTENSIONS)
   set(O_STATIC_EXTENSIONS 1)
 endif()
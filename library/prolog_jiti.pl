@@ -35,14 +35,16 @@
 
 :- module(prolog_jiti,
           [ jiti_list/0,
-            jiti_list/1                         % +Spec
+            jiti_list/1,                        % +Spec
+            index_statistics/2                  % :Head, -Stats
           ]).
-:- autoload(library(apply),[maplist/2]).
+:- autoload(library(apply),[maplist/2, maplist/3]).
 :- autoload(library(dcg/basics),[number/3]).
 
 
 :- meta_predicate
-    jiti_list(:).
+    jiti_list(:),
+    index_statistics(:, -).
 
 /** <module> Just In Time Indexing (JITI) utilities
 
@@ -156,3 +158,67 @@ deep_list([H|T]) -->
 
 iflags(true)  --> "L".
 iflags(false) --> "".
+
+
+%!  index_statistics(:Head, -Stats:dict) is semidet.
+%
+%   Provide usage statistics on the JIT   indexes of the predicate Head.
+%   This can be used to find predicates with poor indexes or that thrash
+%   between index variants.  Fails if the predicate has no indexes. Stats
+%   is a dict with the keys below.
+%
+%     - created
+%       Number of indexes created for the predicate, including deep
+%       indexes and indexes that have been deleted.  A count that is
+%       much higher than the number of current indexes indicates
+%       the predicate repeatedly creates and deletes indexes.
+%     - indexes
+%       List of Where-Dict for each current index, where Where is
+%       as for the predicate_property/2 property `indexed` and Dict
+%       has the keys below.
+%       - buckets
+%         Number of buckets of the hash table.
+%       - speedup
+%         Estimated selectivity of the index.
+%       - lookups
+%         Number of calls that used the index to find the first clause.
+%       - misses
+%         Number of lookups that found no candidate clause.
+%       - avg_scan
+%         Average number of bucket entries inspected per lookup.
+%       - lookahead_stops
+%         Number of lookups where the search for a second candidate
+%         was stopped after inspecting the maximum number of clauses,
+%         leaving a choicepoint that may be useless.
+%       - rebuilds
+%         Number of times the index was rebuilt with more buckets.
+%       - build_time
+%         Wall time in seconds used to fill the index.
+%
+%   The keys `lookups`, `misses`,  `avg_scan`   and  `lookahead_stops`
+%   are only maintained while the Prolog flag `index_statistics` is
+%   `true` in the calling thread.  The counters are updated without
+%   synchronization and are thus approximate if multiple threads use the
+%   predicate.
+
+index_statistics(M:Head, Stats) :-
+    callable(Head),
+    '$index_statistics'(M:Head, Created, Indexes0),
+    maplist(index_stats, Indexes0, Indexes),
+    Stats = _{created:Created, indexes:Indexes}.
+
+index_stats(Where-index_stats(Buckets, Speedup, Lookups, Misses, Scanned,
+                              Lookahead, Rebuilds, BuildTime),
+            Where-_{ buckets:Buckets,
+                     speedup:Speedup,
+                     lookups:Lookups,
+                     misses:Misses,
+                     avg_scan:AvgScan,
+                     lookahead_stops:Lookahead,
+                     rebuilds:Rebuilds,
+                     build_time:BuildTime
+                   }) :-
+    (   Lookups > 0
+    ->  AvgScan is Scanned/Lookups
+    ;   AvgScan = 0
+    ).
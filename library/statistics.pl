@@ -39,6 +39,8 @@
           [ statistics/0,
             statistics/1,               % -Stats
             thread_statistics/2,        % ?Thread, -Stats
+            gc_telemetry/2,             % +Scope, -Telemetry
+            gc_telemetry_prometheus/2,  % +Out, +Scope
             time/1,                     % :Goal
             call_time/2,                % :Goal, -Time
             call_time/3                 % :Goal, -Time, -Result
@@ -267,6 +269,130 @@ thread_stats(Thread, Stacks,
     thread_stack_statistics(Thread, Stacks).
 
 
+%!  gc_telemetry(+Scope, -Telemetry:dict) is det.
+%
+%   Telemetry is a dict holding histograms about the garbage collectors.
+%   Scope is one of `thread`,  for  the   calling  thread,  or  `process`
+%   for all threads together.  Atom and  clause garbage collection run
+%   in the `gc` thread if this is enabled.  The keys are:
+%
+%     - gc_pause, shift_pause, agc_pause, cgc_pause
+%       Histograms of the wall time in seconds of stack garbage
+%       collections, stack shifts, atom garbage collections and clause
+%       garbage collections.
+%     - gc_reclaimed
+%       Histogram of the bytes reclaimed per stack garbage collection.
+%     - alloc_rate
+%       Histogram of the global stack allocation rate in bytes per
+%       second between two stack garbage collections.
+%     - allocated
+%       Total number of bytes allocated on the global stack.
+%     - shifts
+%       Total number of stack shifts.
+%
+%   A histogram is a dict histogram{count:Count, sum:Sum, max:Max,
+%   buckets:Buckets}, where Buckets is a list UpperBound-Count.
+%   UpperBound doubles for each bucket and Count is the number of
+%   observations that are larger than the previous bound and at most
+%   UpperBound.
+
+gc_telemetry(Scope, Telemetry) :-
+    '$gc_telemetry'(Scope, List),
+    maplist(telemetry_pair, List, Pairs),
+    dict_pairs(Telemetry, gc_telemetry, Pairs).
+
+telemetry_pair(Term, Name-Value) :-
+    Term =.. [Name, Value0],
+    (   Value0 = histogram(Count, Sum0, Max0, Buckets0)
+    ->  telemetry_scale(Name, Scale),
+        Sum is Sum0/Scale,
+        Max is Max0/Scale,
+        bucket_bounds(Buckets0, 0, Scale, Buckets),
+        Value = histogram{count:Count, sum:Sum, max:Max, buckets:Buckets}
+    ;   Value = Value0
+    ).
+
+telemetry_scale(Name, 1000000) :-
+    sub_atom(Name, _, _, 0, '_pause'),
+    !.
+telemetry_scale(_, 1).
+
+bucket_bounds([], _, _, []).
+bucket_bounds([N|T0], I, Scale, [Le-N|T]) :-
+    Le is ((1<<I)-1)/Scale,
+    I2 is I+1,
+    bucket_bounds(T0, I2, Scale, T).
+
+%!  gc_telemetry_prometheus(+Out, +Scope) is det.
+%
+%   Write the garbage collection telemetry for  Scope in the Prometheus
+%   text exposition format to the  stream   Out.  See gc_telemetry/2 for
+%   Scope and the available data. The   metrics are prefixed `swipl_`.
+%   For the `thread` scope, they are  labeled   with  the  thread alias or
+%   identifier.
+
+gc_telemetry_prometheus(Out, Scope) :-
+    gc_telemetry(Scope, Telemetry),
+    prometheus_labels(Scope, Labels),
+    dict_pairs(Telemetry, _, Pairs),
+    forall(member(Name-Value, Pairs),
+           prometheus_metric(Out, Name, Value, Labels)).
+
+prometheus_labels(thread, Labels) :-
+    !,
+    thread_self(Me),
+    human_thread_id(Me, Id),
+    format(string(Labels), 'thread="~w"', [Id]).
+prometheus_labels(_, "").
+
+prometheus_metric(Out, Name, Hist, Labels) :-
+    is_dict(Hist, histogram),
+    !,
+    prometheus_name(Name, Metric, Help),
+    format(Out, '# HELP ~w ~w~n# TYPE ~w histogram~n', [Metric, Help, Metric]),
+    prometheus_buckets(Hist.buckets, 0, Out, Metric, Labels),
+    label_sep(Labels, Sep),
+    format(Out, '~w_bucket{~w~wle="+Inf"} ~d~n', [Metric, Labels, Sep, Hist.count]),
+    format(Out, '~w_sum~@ ~w~n', [Metric, prometheus_label_set(Out, Labels), Hist.sum]),
+    format(Out, '~w_count~@ ~d~n', [Metric, prometheus_label_set(Out, Labels), Hist.count]).
+prometheus_metric(Out, Name, Value, Labels) :-
+    prometheus_name(Name, Metric, Help),
+    format(Out, '# HELP ~w ~w~n# TYPE ~w counter~n', [Metric, Help, Metric]),
+    format(Out, '~w~@ ~d~n', [Metric, prometheus_label_set(Out, Labels), Value]).
+
+prometheus_buckets([], _, _, _, _).
+prometheus_buckets([Le-N|T], Cum0, Out, Metric, Labels) :-
+    Cum is Cum0+N,
+    label_sep(Labels, Sep),
+    format(Out, '~w_bucket{~w~wle="~w"} ~d~n', [Metric, Labels, Sep, Le, Cum]),
+    prometheus_buckets(T, Cum, Out, Metric, Labels).
+
+prometheus_label_set(_, "") :-
+    !.
+prometheus_label_set(Out, Labels) :-
+    format(Out, '{~w}', [Labels]).
+
+label_sep("", "") :- !.
+label_sep(_, ",").
+
+prometheus_name(gc_pause,     swipl_gc_pause_seconds,
+                'Stack garbage collection pause time').
+prometheus_name(gc_reclaimed, swipl_gc_reclaimed_bytes,
+                'Bytes reclaimed by stack garbage collection').
+prometheus_name(alloc_rate,   swipl_gc_alloc_rate_bytes_per_second,
+                'Global stack allocation rate between collections').
+prometheus_name(shift_pause,  swipl_stack_shift_pause_seconds,
+                'Stack shift pause time').
+prometheus_name(agc_pause,    swipl_agc_pause_seconds,
+                'Atom garbage collection pause time').
+prometheus_name(cgc_pause,    swipl_cgc_pause_seconds,
+                'Clause garbage collection pause time').
+prometheus_name(allocated,    swipl_gc_allocated_bytes_total,
+                'Bytes allocated on the global stack').
+prometheus_name(shifts,       swipl_stack_shifts_total,
+                'Number of stack shifts').
+
+
 %!  time(:Goal) is nondet.
 %
 %   Execute Goal, reporting statistics to  the   user.  If Goal succeeds
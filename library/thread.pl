@@ -49,7 +49,7 @@
           ]).
 :- autoload(library(apply), [maplist/2, maplist/3, maplist/4, maplist/5]).
 :- autoload(library(error), [must_be/2, instantiation_error/1]).
-:- autoload(library(lists), [subtract/3, same_length/2, nth0/3]).
+:- autoload(library(lists), [subtract/3, same_length/2, nth0/3, member/2]).
 :- autoload(library(option), [option/2, option/3]).
 :- autoload(library(ordsets), [ord_intersection/3, ord_union/3]).
 :- use_module(library(debug), [debug/3, assertion/1]).
@@ -149,9 +149,18 @@ following consequences:
 %     * If one or more of the goals may fail or produce an error,
 %     using a higher number of threads may find this earlier.
 %
-%   @arg N Number of worker-threads to create. Using 1, no threads
-%        are created.  If N is larger than the number of Goals we
-%        create exactly as many threads as there are Goals.
+%   If Options is the empty list, the goals are executed by the calling
+%   thread together with at most N-1 threads of the process-wide _task
+%   executor_ rather than by N newly created threads.  The threads of
+%   the executor are reused by subsequent calls.  Goals should therefore
+%   not leave thread-local data such as thread_local/1 clauses or global
+%   variables behind.  If a goal fails  or raises an exception, goals
+%   that are still running are interrupted using thread_signal/2 and
+%   concurrent/3 returns after they have terminated.
+%
+%   @arg N Number of worker-threads to use. Using 1, no threads
+%        are used.  If N is larger than the number of Goals we
+%        use exactly as many threads as there are Goals.
 %   @arg Goals List of callable terms.
 %   @arg Options Passed to thread_create/3 for creating the
 %        workers.  Only options changing the stack-sizes can
@@ -164,6 +173,12 @@ following consequences:
 concurrent(1, M:List, _) :-
     !,
     maplist(once_in_module(M), List).
+concurrent(N, M:List, []) :-
+    !,
+    must_be(positive_integer, N),
+    must_be(list(callable), List),
+    maplist(once_goal(M), List, Goals),
+    exec_goals(Goals, N).
 concurrent(N, M:List, Options) :-
     must_be(positive_integer, N),
     must_be(list(callable), List),
@@ -191,6 +206,8 @@ concurrent(N, M:List, Options) :-
 once_in_module(M, Goal) :-
     call(M:Goal), !.
 
+once_goal(M, Goal, once_in_module(M, Goal)).
+
 %!  submit_goals(+List, +Id0, +Module, +Queue, -Vars) is det.
 %
 %   Send all jobs from List to Queue. Each goal is added to Queue as
@@ -314,14 +331,13 @@ join_all([Id|T]) :-
 %       Number of threads to use.  The default is determined by the
 %       Prolog flag `cpu_count`.
 %
-%   @tbd Ideally we would grow the   set of workers dynamically, similar
-%   to dynamic scheduling of  HTTP  worker   threads.  This  would avoid
-%   creating threads that are never used if Generate is too slow or does
-%   not provide enough answers and  would   further  raise the number of
-%   threads if Action is I/O bound rather than CPU bound.
-
-:- dynamic
-    fa_aborted/1.
+%   The Action goals are executed by the calling thread and threads from
+%   the process-wide task executor (see concurrent/3).  Solutions of
+%   Generate are sent to the workers in batches whose size grows as the
+%   computation proceeds.  If too many batches are pending, the calling
+%   thread runs a batch itself before continuing the generator.  If an
+%   Action fails or raises an exception, the workers running the other
+%   batches are interrupted and the call waits for them to terminate.
 
 concurrent_forall(Generate, Test) :-
     concurrent_forall(Generate, Test, []).
@@ -336,69 +352,89 @@ concurrent_forall(Generate, Test, Options) :-
     sort(TVars, TVarsS),
     ord_intersection(GVarsS, TVarsS, Shared),
     Templ =.. [v|Shared],
-    MaxSize is Jobs*4,
-    message_queue_create(Q, [max_size(MaxSize)]),
-    length(Workers, Jobs),
-    thread_self(Me),
-    maplist(thread_create(fa_worker(Q, Me, Templ, Test)), Workers),
-    catch(( forall(Generate,
-                   thread_send_message(Q, job(Templ))),
-            forall(between(1, Jobs, _),
-                   thread_send_message(Q, done)),
-            maplist(thread_join, Workers),
-            message_queue_destroy(Q)
-          ),
-          Error,
-          fa_cleanup(Error, Workers, Q)).
+    copy_term(Templ-Test, Job),
+    Helpers is Jobs-1,
+    setup_call_cleanup(
+        exec_setup(Ctx),
+        ( exec_help(Helpers, Ctx),
+          fa_submit(Generate, Templ, Job, Jobs, Ctx, Status0),
+          exec_end(Helpers, Ctx),
+          (   Status0 == true
+          ->  exec_own(Ctx),
+              exec_collect(Ctx, -, Status)
+          ;   Status = Status0
+          )
+        ),
+        exec_cleanup(Ctx)),
+    exec_status(Status).
 concurrent_forall(Generate, Test, _) :-
     forall(Generate, Test).
 
-fa_cleanup(Error, Workers, Q) :-
-    maplist(safe_abort, Workers),
-    debug(concurrent(fail), 'Joining workers', []),
-    maplist(safe_join, Workers),
-    debug(concurrent(fail), 'Destroying queue', []),
-    retractall(fa_aborted(Q)),
-    message_queue_destroy(Q),
-    (   Error = fa_worker_failed(_0Test, Why)
-    ->  debug(concurrent(fail), 'Test ~p failed: ~p', [_0Test, Why]),
-        (   Why == false
-        ->  fail
-        ;   Why = error(E)
-        ->  throw(E)
-        ;   assertion(fail)
-        )
-    ;   throw(Error)
+%!  fa_submit(:Generate, ?Templ, +Job, +Jobs, +Ctx, -Status) is det.
+%
+%   Run Generate, collecting instances of Templ into batches that are
+%   submitted as tasks.  The first batch for each thread holds a single
+%   solution.  After that, the batch size grows with the number of
+%   submitted batches up to 64 solutions.  If more than 4 batches per
+%   thread are pending, the calling thread runs a batch itself.  Results
+%   are collected before submitting a batch.  Status is `true` or the
+%   status of the first task that failed.
+
+fa_submit(Generate, Templ, Job, Jobs, Ctx, Status) :-
+    State = fa(0, [], 0, true),
+    (   forall(Generate, fa_add(State, Templ, Job, Jobs, Ctx))
+    ->  fa_flush(State, Job, Jobs, Ctx)
+    ;   true                            % stopped due to failure or error
+    ),
+    arg(4, State, Status).
+
+fa_add(State, Templ, Job, Jobs, Ctx) :-
+    arg(1, State, Submitted),
+    arg(2, State, Batch0),
+    arg(3, State, Len0),
+    Len is Len0+1,
+    nb_setarg(2, State, [Templ|Batch0]),
+    nb_setarg(3, State, Len),
+    (   Len >= min(64, 1 + Submitted//Jobs)
+    ->  fa_poll(State, Ctx),
+        fa_flush(State, Job, Jobs, Ctx)
+    ;   true
     ).
 
-fa_worker(Queue, Main, Templ, Test) :-
-    repeat,
-    thread_get_message(Queue, Msg),
-    (   Msg == done
-    ->  !
-    ;   Msg = job(Templ),
-        debug(concurrent, 'Running test ~p', [Test]),
-        (   catch_with_backtrace(Test, E, true)
-        ->  (   var(E)
-            ->  fail
-            ;   fa_stop(Queue, Main, fa_worker_failed(Test, error(E)))
-            )
-        ;   !,
-            fa_stop(Queue, Main, fa_worker_failed(Test, false))
+fa_flush(State, Templ-Test, Jobs, Ctx) :-
+    arg(2, State, Batch),
+    (   Batch == []
+    ->  true
+    ;   Ctx = exec(Tasks, _, _),
+        arg(1, State, Id0),
+        Id is Id0+1,
+        nb_setarg(1, State, Id),
+        nb_setarg(2, State, []),
+        nb_setarg(3, State, 0),
+        exec_submit(Ctx, [task(Id, forall(member(Templ, Batch), Test), [])]),
+        (   message_queue_property(Tasks, size(Pending)),
+            Pending > Jobs*4
+        ->  exec_own_one(Ctx)
+        ;   true
         )
     ).
 
-fa_stop(Queue, Main, Why) :-
-    with_mutex('$concurrent_forall',
-               fa_stop_sync(Queue, Main, Why)).
-
-fa_stop_sync(Queue, _Main, _Why) :-
-    fa_aborted(Queue),
-    !.
-fa_stop_sync(Queue, Main, Why) :-
-    asserta(fa_aborted(Queue)),
-    debug(concurrent(fail), 'Stop due to ~p. Signalling ~q', [Why, Main]),
-    thread_signal(Main, throw(Why)).
+%!  fa_poll(+State, +Ctx) is semidet.
+%
+%   Process the available results. Fails   after  storing the status if
+%   some task failed.
+
+fa_poll(State, Ctx) :-
+    Ctx = exec(_, Done, _),
+    (   thread_get_message(Done, Msg, [timeout(0)])
+    ->  exec_result(Msg, Ctx, -, Status),
+        (   Status == true
+        ->  fa_poll(State, Ctx)
+        ;   nb_setarg(4, State, Status),
+            fail
+        )
+    ;   true
+    ).
 
 jobs(Jobs, Options) :-
     (   option(threads(Jobs), Options)
@@ -547,24 +583,28 @@ ca_cleanup(GenThread, Workers, JobQueue, AnswerQueue) :-
 %!  concurrent_maplist(:Goal, +List1, +List2) is semidet.
 %!  concurrent_maplist(:Goal, +List1, +List2, +List3) is semidet.
 %
-%   Concurrent version of maplist/2. This   predicate uses concurrent/3,
-%   using multiple _worker_ threads.  The  number   of  threads  is  the
-%   minimum of the list length and the   number  of cores available. The
-%   number of cores is determined using  the prolog flag =cpu_count=. If
-%   this flag is absent or 1 or List   has  less than two elements, this
-%   predicate calls the corresponding maplist/N  version using a wrapper
-%   based on once/1. Note that all goals   are executed as if wrapped in
-%   once/1 and therefore these predicates are _semidet_.
-%
-%   Note that the the overhead  of   this  predicate is considerable and
-%   therefore Goal must  be  fairly  expensive   before  one  reaches  a
+%   Concurrent version of maplist/2. This predicate splits the lists into
+%   chunks that are executed by the calling thread and the threads of the
+%   process-wide task executor.  The number of threads is the minimum of
+%   the list length and the number of cores available. The number of
+%   cores is determined using the prolog flag =cpu_count=. If this flag
+%   is absent or 1 or List has less than two elements, this predicate
+%   calls the corresponding maplist/N version using a wrapper based on
+%   once/1. Note that all goals are executed as if wrapped in once/1 and
+%   therefore these predicates are _semidet_.
+%
+%   The lists are split into about eight chunks per thread.  Threads that
+%   finish their chunk early pick the next one, which balances the load
+%   if the cost of Goal varies.  Each chunk is copied to the thread that
+%   executes it and its bindings are copied back.  Goal must still be
+%   more expensive than copying its arguments before one reaches a
 %   speedup.
 
 concurrent_maplist(Goal, List) :-
     workers(List, WorkerCount),
     !,
     maplist(ml_goal(Goal), List, Goals),
-    concurrent(WorkerCount, Goals, []).
+    concurrent_chunks(WorkerCount, Goals).
 concurrent_maplist(M:Goal, List) :-
     maplist(once_in_module(M, Goal), List).
 
@@ -578,7 +618,7 @@ concurrent_maplist(Goal, List1, List2) :-
     workers(List1, WorkerCount),
     !,
     maplist(ml_goal(Goal), List1, List2, Goals),
-    concurrent(WorkerCount, Goals, []).
+    concurrent_chunks(WorkerCount, Goals).
 concurrent_maplist(M:Goal, List1, List2) :-
     maplist(once_in_module(M, Goal), List1, List2).
 
@@ -592,7 +632,7 @@ concurrent_maplist(Goal, List1, List2, List3) :-
     workers(List1, WorkerCount),
     !,
     maplist(ml_goal(Goal), List1, List2, List3, Goals),
-    concurrent(WorkerCount, Goals, []).
+    concurrent_chunks(WorkerCount, Goals).
 concurrent_maplist(M:Goal, List1, List2, List3) :-
     maplist(once_in_module(M, Goal), List1, List2, List3).
 
@@ -613,6 +653,374 @@ same_length([], [], []).
 same_length([_|T1], [_|T2], [_|T3]) :-
     same_length(T1, T2, T3).
 
+%!  concurrent_chunks(+Workers, +Goals:list) is semidet.
+%
+%   Split Goals in chunks and run them  using Workers threads. The chunk
+%   size is chosen such that there are about 8 chunks per worker.
+
+concurrent_chunks(Workers, Goals) :-
+    length(Goals, Len),
+    Size is max(1, Len // (Workers*8)),
+    chunks(Goals, Size, Chunks),
+    exec_goals(Chunks, Workers).
+
+chunks([], _, []) :-
+    !.
+chunks(List, Size, [once_all(Chunk)|Chunks]) :-
+    take(Size, List, Chunk, Rest),
+    chunks(Rest, Size, Chunks).
+
+take(0, List, [], List) :-
+    !.
+take(_, [], [], []) :-
+    !.
+take(N, [H|T0], [H|T], Rest) :-
+    N1 is N-1,
+    take(N1, T0, T, Rest).
+
+once_all([]).
+once_all([H|T]) :-
+    call(H),
+    !,
+    once_all(T).
+
+
+                 /*******************************
+                 *           EXECUTOR           *
+                 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The task executor is a process-wide set   of  detached worker threads that
+is created lazily and grows on  demand.   It  is  used by concurrent/3,
+concurrent_forall/3 and concurrent_maplist/2..4, avoiding the creation of
+threads for each call.
+
+Each call creates a private task  queue   and  a result queue. The tasks
+are added to the task queue, followed by  an `end` message for each helper
+requested from the executor.  A  helper   request  is  a  message of the
+form help(Tasks, Done) sent to  the   executor  queue.  A worker picking
+such a request processes tasks from  Tasks  until   it  reads  `end`. The
+calling thread processes tasks as well.  Thus,   all  work gets done even
+if no worker is available, e.g., because   all  workers are executing the
+tasks of an outer concurrent call.
+
+Tasks are terms task(Id, Goal, Vars).  Executing a task sends done(Id,Vars)
+or stop(Id, Why) to the result queue, where  Why is `false` or error(E).
+Before running a task, a worker sets the global variable
+'$concurrent_task' to the task queue and sends started(Thread) to the
+result queue.  The calling thread keeps  count   of  the tasks for which
+it did not yet receive a result.  If a  task stops or the calling thread
+leaves the computation due to an exception, it removes the tasks that
+have not been started, signals all  workers   to  interrupt a task from
+its task queue and waits for the  results   of  the  remaining tasks. A
+started(Thread) message that arrives while waiting  causes the signal to
+be sent again to Thread, which covers workers that picked up their task
+after the first signal.  Finally, the queues are destroyed.  Workers that
+still access them get an existence error.   Help requests that are picked
+up after the queues are destroyed are ignored for the same reason.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+:- dynamic
+    executor_queue/1,
+    executor_worker/1.
+:- volatile
+    executor_queue/1,
+    executor_worker/1.
+
+%!  exec_goals(+Goals:list, +Threads) is semidet.
+%
+%   Run each element of Goals as a  task using at most Threads threads,
+%   including the calling thread.  Succeeds after unifying the bindings
+%   of all tasks if all tasks succeed.
+
+exec_goals(Goals, Threads) :-
+    length(Goals, Count),
+    Helpers is min(Threads, Count) - 1,
+    tasks(Goals, 1, Tasks, VarList),
+    VT =.. [vars|VarList],
+    setup_call_cleanup(
+        exec_setup(Ctx),
+        ( exec_submit(Ctx, Tasks),
+          exec_end(Helpers, Ctx),
+          exec_help(Helpers, Ctx),
+          exec_own(Ctx),
+          exec_collect(Ctx, VT, Status)
+        ),
+        exec_cleanup(Ctx)),
+    exec_status(Status).
+
+tasks([], _, [], []).
+tasks([H|T0], I, [task(I, H, Vars)|T], [Vars|VT]) :-
+    term_variables(H, Vars),
+    I2 is I + 1,
+    tasks(T0, I2, T, VT).
+
+%!  exec_setup(-Ctx) is det.
+%!  exec_cleanup(+Ctx) is det.
+%
+%   Create and destroy the context of a  call. Ctx is a term exec(Tasks,
+%   Done, Pending), where Pending holds the number of submitted tasks for
+%   which no result has been received.
+
+exec_setup(exec(Tasks, Done, pending(0))) :-
+    message_queue_create(Tasks),
+    message_queue_create(Done).
+
+exec_cleanup(Ctx) :-
+    Ctx = exec(Tasks, Done, _),
+    exec_abandon(Ctx),
+    message_queue_destroy(Tasks),
+    message_queue_destroy(Done).
+
+exec_status(Status) :-
+    (   Status == true
+    ->  true
+    ;   Status == false
+    ->  fail
+    ;   Status = error(Error)
+    ->  throw(Error)
+    ).
+
+%!  exec_submit(+Ctx, +Tasks:list) is det.
+
+exec_submit(Ctx, Tasks) :-
+    Ctx = exec(Queue, _, Pending),
+    length(Tasks, Count),
+    arg(1, Pending, N0),
+    N is N0 + Count,
+    nb_setarg(1, Pending, N),
+    thread_send_messages(Queue, Tasks).
+
+%!  exec_help(+Helpers, +Ctx) is det.
+%!  exec_end(+Helpers, +Ctx) is det.
+%
+%   Ask Helpers workers of the executor to   process tasks from Ctx and
+%   tell them to stop after all tasks submitted so far.
+
+exec_help(Helpers, exec(Tasks, Done, _)) :-
+    Helpers > 0,
+    !,
+    executor(Helpers, Queue),
+    length(Requests, Helpers),
+    maplist(=(help(Tasks, Done)), Requests),
+    thread_send_messages(Queue, Requests).
+exec_help(_, _).
+
+exec_end(Helpers, exec(Tasks, _, _)) :-
+    Helpers > 0,
+    !,
+    length(Ends, Helpers),
+    maplist(=(end), Ends),
+    thread_send_messages(Tasks, Ends).
+exec_end(_, _).
+
+%!  exec_own(+Ctx) is det.
+%!  exec_own_one(+Ctx) is semidet.
+%
+%   Run tasks from Ctx in the calling  thread   until  no more tasks are
+%   pending or some task failed.
+
+exec_own(Ctx) :-
+    exec_own_one(Ctx),
+    !,
+    exec_own(Ctx).
+exec_own(_).
+
+exec_own_one(exec(Tasks, Done, _)) :-
+    \+ thread_peek_message(Done, stop(_,_)),
+    thread_get_message(Tasks, task(Id, Goal, Vars), [timeout(0)]),
+    run_task(task(Id, Goal, Vars), Done).
+
+%!  exec_collect(+Ctx, +VT, -Status) is det.
+%
+%   Wait for the results of all pending tasks, unifying the bindings of
+%   task _I_ with the _I_-th argument of  VT.   If  VT is not compound,
+%   the bindings are ignored.  Status is unified with the status of the
+%   first stopped task or `true` if all tasks succeeded.
+
+exec_collect(Ctx, VT, Status) :-
+    Ctx = exec(_, Done, Pending),
+    (   arg(1, Pending, 0)
+    ->  Status = true
+    ;   thread_get_message(Done, Msg),
+        exec_result(Msg, Ctx, VT, Status0),
+        (   Status0 == true
+        ->  exec_collect(Ctx, VT, Status)
+        ;   Status = Status0
+        )
+    ).
+
+%!  exec_result(+Msg, +Ctx, +VT, -Status) is semidet.
+%
+%   Process a message from the result queue.
+
+exec_result(started(_), _, _, true).
+exec_result(done(Id, Vars), Ctx, VT, true) :-
+    exec_received(Ctx),
+    (   compound(VT)
+    ->  arg(Id, VT, Vars)
+    ;   true
+    ).
+exec_result(stop(Id, Status), Ctx, _, Status) :-
+    exec_received(Ctx),
+    debug(concurrent, 'Task ~p stopped: ~p', [Id, Status]).
+
+exec_received(exec(_, _, Pending)) :-
+    arg(1, Pending, N0),
+    N is N0 - 1,
+    nb_setarg(1, Pending, N).
+
+%!  exec_abandon(+Ctx) is det.
+%
+%   Stop the tasks of Ctx that are still running and wait for them to
+%   terminate.  Tasks that have not been started are discarded.
+
+exec_abandon(Ctx) :-
+    Ctx = exec(Tasks, Done, Pending),
+    (   arg(1, Pending, 0)
+    ->  true
+    ;   exec_discard(Ctx),
+        forall(executor_worker(Worker),
+               exec_interrupt(Worker, Tasks)),
+        exec_await(Pending, Tasks, Done)
+    ).
+
+exec_discard(Ctx) :-
+    Ctx = exec(Tasks, _, _),
+    (   thread_get_message(Tasks, task(_,_,_), [timeout(0)])
+    ->  exec_received(Ctx),
+        exec_discard(Ctx)
+    ;   true
+    ).
+
+exec_await(Pending, Tasks, Done) :-
+    (   arg(1, Pending, 0)
+    ->  true
+    ;   thread_get_message(Done, Msg),
+        (   Msg = started(Worker)
+        ->  exec_interrupt(Worker, Tasks)
+        ;   exec_received(exec(Tasks, Done, Pending))
+        ),
+        exec_await(Pending, Tasks, Done)
+    ).
+
+exec_interrupt(Worker, Tasks) :-
+    debug(concurrent, 'Interrupting ~p', [Worker]),
+    catch(thread_signal(Worker, exec_stop(Tasks)), error(_,_), true).
+
+%!  exec_stop(+Tasks) is det.
+%
+%   Run as a signal in a worker.  Interrupts the current task if it is
+%   a task from Tasks.
+
+exec_stop(Tasks) :-
+    nb_current('$concurrent_task', Current),
+    Current == Tasks,
+    !,
+    nb_setval('$concurrent_task', []),
+    throw(concurrent_stopped).
+exec_stop(_).
+
+%!  run_task(+Task, +Done) is det.
+%!  task_result(+Task, -Msg) is det.
+%
+%   Run Task and send its result to the queue Done.
+
+run_task(Task, Done) :-
+    task_result(Task, Msg),
+    send_result(Done, Msg).
+
+task_result(task(Id, Goal, Vars), Msg) :-
+    (   catch_with_backtrace(Goal, E, true)
+    ->  (   var(E)
+        ->  Msg = done(Id, Vars)
+        ;   Msg = stop(Id, error(E))
+        )
+    ;   Msg = stop(Id, false)
+    ).
+
+send_result(Done, Msg) :-
+    catch(thread_send_message(Done, Msg), error(existence_error(_,_),_), true).
+
+%!  executor(+Size, -Queue) is det.
+%
+%   Queue is the request queue of  the   executor  that has at least Size
+%   worker threads.
+
+executor(Size, Queue) :-
+    executor_queue(Queue),
+    executor_size(Count),
+    Count >= Size,
+    !.
+executor(Size, Queue) :-
+    with_mutex('$thread_executor', create_executor(Size, Queue)).
+
+create_executor(Size, Queue) :-
+    (   executor_queue(Queue)
+    ->  true
+    ;   message_queue_create(Queue),
+        assertz(executor_queue(Queue))
+    ),
+    executor_size(Count),
+    New is Size - Count,
+    forall(between(1, New, _),
+           ( thread_create(executor_loop(Queue), Id,
+                           [ detached(true),
+                             at_exit(executor_exit)
+                           ]),
+             assertz(executor_worker(Id))
+           )).
+
+executor_size(Count) :-
+    predicate_property(executor_worker(_), number_of_clauses(Count)),
+    !.
+executor_size(0).
+
+executor_exit :-
+    thread_self(Me),
+    with_mutex('$thread_executor', retractall(executor_worker(Me))).
+
+executor_loop(Queue) :-
+    nb_setval('$concurrent_task', []),
+    repeat,
+      thread_get_message(Queue, help(Tasks, Done)),
+      exec_helper(Tasks, Done),
+      fail.
+
+%!  exec_helper(+Tasks, +Done) is det.
+%
+%   Process tasks from Tasks until reading `end`.  The global variable
+%   '$concurrent_task' is set while a task  runs, such that exec_stop/1
+%   only interrupts tasks of the stopped call.  Setting and clearing the
+%   variable is combined with sending  the   started  message  and the
+%   result using sig_atomic/1.  This  guarantees  that   the  caller
+%   receives exactly one result for each task, also if exec_stop/1 runs
+%   after the task's goal completed.
+
+exec_helper(Tasks, Done) :-
+    catch(thread_get_message(Tasks, Task), error(existence_error(_,_),_), fail),
+    Task = task(Id,_,_),
+    !,
+    thread_self(Me),
+    catch(( sig_atomic(( nb_setval('$concurrent_task', Tasks),
+                         thread_send_message(Done, started(Me))
+                       )),
+            task_result(Task, Msg),
+            sig_atomic(( nb_setval('$concurrent_task', []),
+                         send_result(Done, Msg)
+                       ))
+          ),
+          E,
+          exec_helper_error(E, Id, Done)),
+    exec_helper(Tasks, Done).
+exec_helper(_, _).
+
+exec_helper_error(E, Id, Done) :-
+    nb_setval('$concurrent_task', []),
+    (   E == concurrent_stopped
+    ->  send_result(Done, stop(Id, error(E)))
+    ;   true                            % queue was destroyed
+    ).
 
                  /*******************************
                  *             FIRST            *
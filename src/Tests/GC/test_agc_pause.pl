@@ -0,0 +1,91 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_agc_pause,
+          [ test_agc_pause/0
+          ]).
+:- use_module(library(plunit)).
+:- use_module(library(lists)).
+
+/** <module> Test time sliced atom garbage collection
+
+Run AGC with a tiny agc_max_pause while  other threads create atoms and
+verify that atoms that are still referenced survive.
+*/
+
+test_agc_pause :-
+    run_tests([ agc_pause
+              ]).
+
+:- begin_tests(agc_pause,
+               [ setup(current_prolog_flag(agc_max_pause, Old)),
+                 cleanup(set_prolog_flag(agc_max_pause, Old))
+               ]).
+
+test(sliced) :-
+    statistics(agc_yields, Y0),
+    set_prolog_flag(agc_max_pause, 1.0e-6),
+    make_atoms(1, 20000, Keep),
+    (   current_prolog_flag(threads, true)
+    ->  findall(Id,
+                ( between(1, 4, I),
+                  thread_create(churn(I, 20000), Id, [])
+                ),
+                Ids),
+        garbage_collect_atoms,
+        maplist(thread_join, Ids)
+    ;   churn(1, 20000)
+    ),
+    garbage_collect_atoms,
+    check_atoms(Keep, 1),
+    statistics(agc_yields, Y1),
+    assertion(Y1 > Y0).
+test(domain, error(domain_error(not_less_than_zero, -1.0))) :-
+    set_prolog_flag(agc_max_pause, -1.0).
+
+:- end_tests(agc_pause).
+
+make_atoms(From, To, Atoms) :-
+    findall(A, (between(From, To, I), atom_concat(keep_, I, A)), Atoms).
+
+check_atoms([], _).
+check_atoms([H|T], I) :-
+    atom_concat(keep_, I, A),
+    assertion(H == A),
+    I2 is I+1,
+    check_atoms(T, I2).
+
+churn(Id, N) :-
+    forall(between(1, N, I),
+           atomic_list_concat([garbage, Id, I], '_', _)).
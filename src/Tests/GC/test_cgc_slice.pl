@@ -0,0 +1,95 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_cgc_slice,
+          [ test_cgc_slice/0
+          ]).
+:- use_module(library(plunit)).
+
+/** <module> Test incremental clause garbage collection
+
+Automatically started clause garbage collection runs in slices bounded
+by the flag `cgc_max_pause`.  Repeated slices must eventually reclaim
+all retracted clauses.
+*/
+
+test_cgc_slice :-
+    run_tests([ cgc_slice
+              ]).
+
+garbage(Preds, Clauses) :-
+    forall(between(1, Preds, P),
+           ( atom_concat(cgc_slice_, P, Name),
+             functor(Head, Name, 1),
+             arg(1, Head, I),
+             forall(between(1, Clauses, I), assertz(Head)),
+             retractall(Head)
+           )).
+
+drain(0) :- !.
+drain(N) :-
+    '$cgc_slice',
+    (   statistics(cgc_pending, 0)
+    ->  true
+    ;   N2 is N-1,
+        drain(N2)
+    ).
+
+:- begin_tests(cgc_slice,
+               [ setup(current_prolog_flag(cgc_max_pause, Old)),
+                 cleanup(set_prolog_flag(cgc_max_pause, Old))
+               ]).
+
+test(slices, true) :-
+    garbage_collect_clauses,
+    set_prolog_flag(cgc_max_pause, 1.0e-9),
+    statistics(cgc, C0),
+    statistics(cgc_gained, G0),
+    garbage(50, 20),
+    drain(1000),
+    statistics(cgc, C1),
+    statistics(cgc_gained, G1),
+    assertion(C1-C0 > 1),
+    assertion(G1-G0 > 900).
+test(full, true(G1-G0 > 900)) :-
+    garbage_collect_clauses,
+    set_prolog_flag(cgc_max_pause, 1.0e-9),
+    statistics(cgc_gained, G0),
+    garbage(50, 20),
+    garbage_collect_clauses,
+    statistics(cgc_gained, G1).
+test(negative, error(domain_error(not_less_than_zero, -1.0))) :-
+    set_prolog_flag(cgc_max_pause, -1.0).
+
+:- end_tests(cgc_slice).
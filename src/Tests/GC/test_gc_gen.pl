@@ -0,0 +1,134 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_gc_gen,
+	  [ test_gc_gen/0
+	  ]).
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Test  the  generational  garbage  collector  (Prolog  flag gc_generational).
+We create a long lived  list  with  unbound  variables,  produce garbage
+such that the list is promoted and bind the  variables of the old list
+to young data that must survive minor collections.  We also check that
+backtracking over promoted data and nb_setarg/3 into promoted data work.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+test_gc_gen :-
+	current_prolog_flag(gc_generational, Old),
+	setup_call_cleanup(
+	    set_prolog_flag(gc_generational, true),
+	    ( test_bind_old,
+	      test_backtrack,
+	      test_nb_setarg,
+	      test_minor
+	    ),
+	    set_prolog_flag(gc_generational, Old)).
+
+%!	test_bind_old
+%
+%	Bind variables in promoted data to young terms.
+
+test_bind_old :-
+	length(L, 500),
+	garbage(10),
+	bind(L, 1),
+	garbage(10),
+	check(L, 1).
+
+bind([], _).
+bind([f(I, s(I))|T], I) :-
+	garbage(1),
+	I2 is I+1,
+	bind(T, I2).
+
+check([], _).
+check([f(I, s(I))|T], I) :-
+	I2 is I+1,
+	check(T, I2).
+
+%!	test_backtrack
+%
+%	Undo bindings of old variables while  minor collections run in the
+%	choicepoint.
+
+test_backtrack :-
+	length(L, 200),
+	garbage(10),
+	(   bind(L, 1),
+	    garbage(10),
+	    fail
+	;   maplist(var, L)
+	),
+	bind(L, 1),
+	check(L, 1).
+
+%!	test_nb_setarg
+%
+%	nb_setarg/3 stores young data in old data without trailing.
+
+test_nb_setarg :-
+	T = t(0),
+	garbage(10),
+	forall(between(1, 100, I),
+	       ( numlist(1, I, List),
+		 nb_setarg(1, T, List),
+		 garbage(1)
+	       )),
+	garbage(10),
+	T = t(List),
+	numlist(1, 100, List).
+
+%!	test_minor
+%
+%	Verify that minor collections happen.
+
+test_minor :-
+	statistics(minor_collections, M0),
+	length(L, 500),
+	garbage(10),
+	bind(L, 1),
+	check(L, 1),
+	statistics(minor_collections, M1),
+	M1 > M0.
+
+%!	garbage(+Times)
+%
+%	Create garbage that is large enough to force a collection.
+
+garbage(0) :- !.
+garbage(N) :-
+	numlist(1, 10000, L),
+	sum_list(L, _),
+	N2 is N-1,
+	garbage(N2).
@@ -0,0 +1,87 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_gc_telemetry,
+          [ test_gc_telemetry/0
+          ]).
+:- use_module(library(plunit)).
+:- use_module(library(statistics)).
+:- use_module(library(lists)).
+:- use_module(library(apply)).
+
+/** <module> Test the GC telemetry of library(statistics)
+*/
+
+test_gc_telemetry :-
+    run_tests([ gc_telemetry
+              ]).
+
+:- begin_tests(gc_telemetry).
+
+test(thread) :-
+    gc_telemetry(thread, T0),
+    numlist(1, 100000, L),
+    length(L, _),
+    garbage_collect,
+    gc_telemetry(thread, T1),
+    assertion(T1.gc_pause.count > T0.gc_pause.count),
+    assertion(T1.allocated > T0.allocated),
+    check_histogram(T1.gc_pause),
+    check_histogram(T1.gc_reclaimed).
+test(process) :-
+    garbage_collect,
+    gc_telemetry(thread, T),
+    gc_telemetry(process, P),
+    assertion(P.gc_pause.count >= T.gc_pause.count),
+    assertion(P.shifts >= T.shifts).
+test(prometheus) :-
+    garbage_collect,
+    with_output_to(string(S), gc_telemetry_prometheus(current_output, process)),
+    split_string(S, "\n", "", Lines),
+    assertion(memberchk("# TYPE swipl_gc_pause_seconds histogram", Lines)),
+    assertion(( member(Line, Lines),
+                sub_string(Line, 0, _, _, "swipl_gc_pause_seconds_bucket{le=\"+Inf\"}")
+              )).
+test(scope, error(domain_error(gc_telemetry_scope, nowhere))) :-
+    gc_telemetry(nowhere, _).
+
+:- end_tests(gc_telemetry).
+
+check_histogram(H) :-
+    foldl(add_bucket, H.buckets, 0, Count),
+    assertion(Count == H.count),
+    assertion(H.max =< H.sum).
+
+add_bucket(_-N, C0, C) :-
+    C is C0+N.
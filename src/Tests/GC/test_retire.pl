@@ -0,0 +1,95 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_retire,
+          [ test_retire/0
+          ]).
+:- use_module(library(plunit)).
+:- use_module(library(apply)).
+
+/** <module> Test reclamation of retired predicate data
+
+Replacing the clause index of a predicate  retires the old index.  Clause
+garbage collection must reclaim it even if the predicate has no erased
+clauses.
+*/
+
+test_retire :-
+    run_tests([ retire
+              ]).
+
+:- dynamic
+    p/2.
+
+grow(Max) :-
+    forall(between(1, Max, R),
+           ( N is R*1000,
+             Low is N-999,
+             forall(between(Low, N, I), assertz(p(I, R))),
+             once(p(Low, _))
+           )).
+
+lookup_all(Max) :-
+    forall(between(1, Max, I),
+           once(p(I, _))).
+
+:- begin_tests(retire, [cleanup(retractall(p(_,_)))]).
+
+test(reclaim, true) :-
+    retractall(p(_,_)),
+    garbage_collect_clauses,
+    statistics(reclaimed_objects, C0),
+    grow(20),
+    lookup_all(20000),
+    garbage_collect_clauses,
+    statistics(reclaimed_objects, C1),
+    assertion(C1 > C0),
+    aggregate_all(count, p(_,_), Count),
+    assertion(Count == 20000).
+test(concurrent, true) :-
+    retractall(p(_,_)),
+    length(Ids, 3),
+    maplist([Id]>>thread_create(reader(50), Id, []), Ids),
+    grow(30),
+    garbage_collect_clauses,
+    maplist(thread_join, Ids),
+    lookup_all(30000).
+
+reader(0) :- !.
+reader(N) :-
+    forall(between(1, 200, I), ignore(p(I, _))),
+    N2 is N-1,
+    reader(N2).
+
+:- end_tests(retire).
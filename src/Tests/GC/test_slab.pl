@@ -0,0 +1,116 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_slab,
+          [ test_slab/0
+          ]).
+:- use_module(library(plunit)).
+:- use_module(library(lists)).
+:- use_module(library(apply)).
+
+/** <module> Test the slab allocator for clauses
+
+Clauses, clause references and index  clause  lists  are allocated from
+slabs.  Stress assert/retract and clause garbage collection from multiple
+threads and verify the clauses are intact.
+*/
+
+test_slab :-
+    run_tests([ slab
+              ]).
+
+:- dynamic
+    fact/2,
+    big/1.
+
+:- meta_predicate
+    churn(+, +, 1).
+
+churn(Thread, N, Check) :-
+    forall(between(1, N, I),
+           ( Len is I mod 40,
+             numlist(0, Len, L),
+             assertz(fact(Thread, f(I, L)))
+           )),
+    forall(( between(1, N, I), I mod 2 =:= 0 ),
+           retract(fact(Thread, f(I, _)))),
+    garbage_collect_clauses,
+    call(Check, Thread).
+
+odd_intact(Thread) :-
+    findall(I-L, fact(Thread, f(I, L)), Pairs),
+    forall(member(I-L, Pairs),
+           ( I mod 2 =:= 1,
+             Len is I mod 40,
+             numlist(0, Len, L)
+           )),
+    retractall(fact(Thread, _)).
+
+:- begin_tests(slab).
+
+test(statistics, true) :-
+    statistics(slab_space, Space),
+    statistics(slab_free, Free),
+    assertion(integer(Space)),
+    assertion(integer(Free)),
+    assertion(Free =< Space).
+test(churn, true) :-
+    forall(between(1, 3, _), churn(main, 5000, odd_intact)),
+    \+ fact(main, _).
+test(threads, true) :-
+    length(Ids, 4),
+    foldl(start_churner, Ids, 1, _),
+    maplist(thread_join, Ids),
+    \+ fact(_, _).
+test(large, X == Size) :-
+    Size = 200,
+    numlist(1, Size, L),
+    assertz(big(L)),
+    garbage_collect_clauses,
+    big(B),
+    length(B, X),
+    retractall(big(_)).
+test(index, true) :-
+    forall(between(1, 2000, I), assertz(fact(index, f(I, x)))),
+    fact(index, f(1000, X)),
+    assertion(X == x),
+    retractall(fact(index, _)),
+    garbage_collect_clauses,
+    \+ fact(index, _).
+
+start_churner(Id, T0, T) :-
+    T is T0+1,
+    thread_create(churn(T0, 2000, odd_intact), Id, []).
+
+:- end_tests(slab).
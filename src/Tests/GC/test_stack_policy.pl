@@ -0,0 +1,108 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_stack_policy,
+          [ test_stack_policy/0
+          ]).
+:- use_module(library(plunit)).
+:- use_module(library(lists)).
+
+/** <module> Test the stack memory policy flags
+
+Grow the stacks with the  flags  stack_huge_pages, stack_numa  and
+stack_reserve enabled and verify the data survives the stack shifts.
+*/
+
+test_stack_policy :-
+    run_tests([ stack_policy
+              ]).
+
+grow(N, Sum) :-
+    numlist(1, N, L),
+    sum_list(L, Sum).
+
+policy_thread(Goal) :-
+    thread_create(( set_prolog_flag(stack_huge_pages, true),
+                    set_prolog_flag(stack_numa, true),
+                    Goal
+                  ), Id, []),
+    thread_join(Id, Status),
+    assertion(Status == true).
+
+:- begin_tests(stack_policy).
+
+test(flags, true) :-
+    current_prolog_flag(stack_huge_pages, HP),
+    current_prolog_flag(stack_numa, NUMA),
+    assertion(memberchk(HP, [true,false])),
+    assertion(memberchk(NUMA, [true,false])).
+test(grow, true) :-
+    policy_thread(( grow(500000, Sum),
+                    Sum =:= 500000*500001//2
+                  )).
+test(affinity, [ condition(catch(thread_affinity(main, _, _), _, fail)),
+                 true
+               ]) :-
+    policy_thread(( thread_self(Me),
+                    thread_affinity(Me, Old, Old),
+                    Old = [CPU|_],
+                    thread_affinity(Me, _, [CPU]),
+                    grow(500000, Sum),
+                    Sum =:= 500000*500001//2
+                  )).
+
+test(reserve, true) :-
+    reserve_thread(( grow(500000, Sum),
+                     Sum =:= 500000*500001//2,
+                     garbage_collect,
+                     trim_stacks,
+                     grow(200000, Sum2),
+                     Sum2 =:= 200000*200001//2
+                   ), []).
+test(reserve_beyond_limit, true) :-
+    reserve_thread(( set_prolog_flag(stack_limit, 256 000 000),
+                     grow(1000000, Sum),
+                     Sum =:= 1000000*1000001//2
+                   ), [stack_limit(16 000 000)]).
+
+:- end_tests(stack_policy).
+
+reserve_thread(Goal, Options) :-
+    current_prolog_flag(stack_reserve, Old),
+    setup_call_cleanup(
+        set_prolog_flag(stack_reserve, true),
+        thread_create(Goal, Id, Options),
+        set_prolog_flag(stack_reserve, Old)),
+    thread_join(Id, Status),
+    assertion(Status == true).
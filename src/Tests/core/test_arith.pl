@@ -231,6 +231,27 @@ test(a_add_fc_float) :-
 test(a_fc_minus) :-
 	a2.
 
+a3(X, Y, Z) :-
+	Z is X*Y - X/Y + 0.5.
+a4(X, Y, Z) :-
+	Z is X*Y - X.
+
+test(a_float_chain, Z == 5.0) :-
+	a3(3.0, 2.0, Z).
+test(a_float_overflow, error(evaluation_error(float_overflow))) :-
+	a3(1.0e300, 1.0e300, _).
+test(a_float_subnormal, Z > 0.0) :-
+	a4(1.0e-300, 1.0e-10, Z0),
+	Z is -Z0.
+test(a_int_chain, Z == 35) :-
+	a4(7, 6, Z).
+:- if(current_prolog_flag(bounded,false)).
+test(a_int_overflow, Z == 9223372036854775807) :-
+	a4(9223372036854775807, 2, Z).
+:- endif.
+test(a_mixed, Z == 10.0) :-
+	a4(2, 6.0, Z).
+
 :- end_tests(ar_builtin).
 
 
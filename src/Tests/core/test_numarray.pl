@@ -0,0 +1,140 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+:- module(test_numarray, [test_numarray/0]).
+:- use_module(library(plunit)).
+
+/** <module> Test numeric arrays
+*/
+
+test_numarray :-
+    run_tests([ numarray
+	      ]).
+
+:- begin_tests(numarray).
+
+test(from_list, Type-L == int64-[1,2,3]) :-
+    numarray_from_list(Type, [1,2,3], A),
+    numarray_to_list(A, L).
+test(infer_float, Type == float64) :-
+    numarray_from_list(Type, [1,2.0], _).
+test(type_error, error(type_error(integer, a))) :-
+    numarray_from_list(int64, [1,a], _).
+test(size, S-T == 3-float64) :-
+    numarray_from_list(float64, [1,2,3], A),
+    numarray_size(A, S),
+    numarray_type(A, T).
+test(get, X == 2.0) :-
+    numarray_from_list(float64, [1,2,3], A),
+    numarray_get(A, 1, X).
+test(get_range, fail) :-
+    numarray_from_list(float64, [1,2,3], A),
+    numarray_get(A, 3, _).
+test(op_int, L == [5,7,9]) :-
+    numarray_from_list(int64, [1,2,3], A),
+    numarray_from_list(int64, [4,5,6], B),
+    numarray_op(+, A, B, C),
+    numarray_to_list(C, L).
+test(op_scalar, L == [0.5,1.0,1.5]) :-
+    numarray_from_list(int64, [1,2,3], A),
+    numarray_op(/, A, 2, C),
+    numarray_to_list(C, L).
+test(op_scalar_left, L == [9,8,7]) :-
+    numarray_from_list(int64, [1,2,3], A),
+    numarray_op(-, 10, A, C),
+    numarray_to_list(C, L).
+test(op_size, error(domain_error(numeric_array_size, _))) :-
+    numarray_from_list(int64, [1,2,3], A),
+    numarray_from_list(int64, [1,2], B),
+    numarray_op(+, A, B, _).
+test(op_overflow, error(evaluation_error(int_overflow))) :-
+    numarray_from_list(int64, [9223372036854775807], A),
+    numarray_op(*, A, 2, _).
+test(op_big_scalar, L == [1152921504606846976]) :-
+    numarray_from_list(int64, [1], A),
+    numarray_op(+, A, 1152921504606846975, C),
+    numarray_to_list(C, L).
+:- if(current_prolog_flag(bounded,false)).
+test(op_huge_scalar, error(evaluation_error(int_overflow))) :-
+    numarray_from_list(int64, [1], A),
+    numarray_op(+, A, 9223372036854775808, _).
+:- endif.
+test(compare, L == [0,0,1,1]) :-
+    numarray_from_list(float64, [1,2,3,4], A),
+    numarray_compare(>, A, 2.5, M),
+    numarray_to_list(M, L).
+test(sum, S == 6) :-
+    numarray_from_list(int64, [1,2,3], A),
+    S is sum(A).
+test(sum_float, S =:= 15.0) :-
+    numlist(1, 5, L),
+    numarray_from_list(float64, L, A),
+    S is sum(A).
+:- if(current_prolog_flag(bounded,false)).
+test(sum_big, S == 9223372036854775817) :-
+    numarray_from_list(int64, [9223372036854775807,10], A),
+    S is sum(A).
+:- endif.
+test(reductions, [Mean,Min,Max] == [2.0,1,3]) :-
+    numarray_from_list(int64, [2,1,3], A),
+    Mean is mean(A),
+    Min is min(A),
+    Max is max(A).
+test(mean_empty, error(evaluation_error(undefined))) :-
+    numarray_from_list(float64, [], A),
+    _ is mean(A).
+test(dot, D =:= 32.0) :-
+    numarray_from_list(float64, [1,2,3], A),
+    numarray_from_list(int64, [4,5,6], B),
+    D is dot(A, B).
+test(expression, X =:= 2*6+32) :-
+    numarray_from_list(int64, [1,2,3], A),
+    numarray_from_list(int64, [4,5,6], B),
+    X is 2*sum(A) + dot(A, B).
+test(not_array, error(type_error(numeric_array, foo))) :-
+    _ is sum(foo).
+test(current, true) :-
+    forall(member(F, [sum(_), mean(_), min(_), max(_), dot(_,_)]),
+           current_arithmetic_function(F)).
+test(io, L == [1.5,2.5,3.5]) :-
+    numarray_from_list(float64, [1.5,2.5,3.5], A),
+    tmp_file_stream(binary, File, Out),
+    call_cleanup(numarray_write(Out, A), close(Out)),
+    call_cleanup(( open(File, read, In, [type(binary)]),
+		   call_cleanup(numarray_read(In, float64, N, B), close(In))
+		 ),
+		 delete_file(File)),
+    N == 3,
+    numarray_to_list(B, L).
+
+:- end_tests(numarray).
@@ -38,6 +38,7 @@
 	  ]).
 :- use_module(library(plunit)).
 :- use_module(library(debug)).
+:- use_module(library(prolog_jiti), [index_statistics/2]).
 
 test_jit :-
 	run_tests([ jit
@@ -51,10 +52,13 @@ This module tests behaviour of the just-in-time indexes.
 :- begin_tests(jit).
 
 :- dynamic
-	d/2.
+	d/2,
+	d4/4,
+	t3/3.
 
 :- meta_predicate
 	has_hashes(:, ?),
+	buckets(:, +, -),
 	not_hashed(:).
 
 has_hashes(P, Hashes) :-
@@ -71,18 +75,33 @@ pindex(multi(List)-Hash, List-Hash).
 pindex(deep(_)-_, _) :-
 	assertion(fail).
 
+buckets(P, Arg, Buckets) :-
+	predicate_property(P, indexed(Indexed)),
+	memberchk(single(Arg)-hash(Buckets,_,_,_), Indexed).
+
 not_hashed(P) :-
 	\+ predicate_property(P, indexed(_)).
 
+s(a, 1).
+s(b, 2).
+s(c, 3).
+s(f(x), 4).
+s(1.5, 5).
+s("s", 6).
 
-test(remove, [cleanup(retractall(d(_,_)))]) :-
+
+test(grow, [cleanup(retractall(d(_,_)))]) :-
 	forall(between(1,50,X), assertz(d(X,X))),
 	d(_,30),
 	assertion(has_hashes(d(_,_), [2])),
+	buckets(d(_,_), 2, B0),
 	forall(between(51,125,X), assertz(d(X,X))),
-	assertion(not_hashed(p(_,_))),
+	d(_,30),
+	assertion(has_hashes(d(_,_), [2])),
+	buckets(d(_,_), 2, B1),
+	assertion(B1 > B0),
 	d(30,_),
-	assertion(has_hashes(d(_,_), [1])).
+	assertion(has_hashes(d(_,_), [1,2])).
 test(remove, [cleanup(retractall(d(_,_)))]) :-
 	forall(between(1,40,X), assertz(d(X,a))),
 	forall(between(41,50,X), assertz(d(X,X))),
@@ -186,4 +205,96 @@ test(depth_exceeded, nondet) :-
 	p2(a(b(c(d(e(f(g(h(1))))))))),
 	p2(a(b(c(d(e(f(g(h(2))))))))).
 
+test(multi3, [cleanup(retractall(d4(_,_,_,_)))]) :-
+	forall(( between(0,9,A), between(0,9,B), between(0,9,C),
+		 between(1,10,D)
+	       ),
+	       assertz(d4(A,B,C,D))),
+	findall(D, d4(3,4,5,D), Ds),
+	assertion(Ds == [1,2,3,4,5,6,7,8,9,10]),
+	assertion(has_hashes(d4(_,_,_,_), [[1,2,3]])).
+test(deep_path, [cleanup(retractall(t3(_,_,_)))]) :-
+	forall(between(1, 1000, I),
+	       ( T is I mod 100,
+		 assertz(t3(I, p(_, en), o(T, I)))
+	       )),
+	once(t3(_, p(_, en), _)),
+	findall(V, t3(_, p(_,_), o(42,V)), Vs),
+	assertion(length(Vs, 10)),
+	predicate_property(t3(_,_,_), indexed(Indexed)),
+	assertion(memberchk(deep([3,single(1)])-_, Indexed)).
+test(stats, [ setup(( current_prolog_flag(index_statistics, Old),
+		       set_prolog_flag(index_statistics, true)
+		     )),
+	       cleanup(( retractall(d(_,_)),
+			 set_prolog_flag(index_statistics, Old)
+		       ))
+	     ]) :-
+	forall(between(1,50,X), assertz(d(X,X))),
+	forall(between(1,10,X), d(X,_)),
+	\+ d(100,_),
+	index_statistics(d(_,_), Stats),
+	assertion(Stats.created >= 1),
+	memberchk(single(1)-Index, Stats.indexes),
+	assertion(Index.lookups == 11),
+	assertion(Index.misses == 1),
+	assertion(Index.rebuilds == 0).
+test(bloom, [ setup(( current_prolog_flag(index_bloom_filter, Old),
+		       set_prolog_flag(index_bloom_filter, true)
+		     )),
+	      cleanup(( retractall(d4(_,_,_,_)),
+			set_prolog_flag(index_bloom_filter, Old)
+		      ))
+	    ]) :-
+	forall(between(1,100,X), assertz(d4(a,b,X,X))),
+	\+ d4(a,c,_,_),
+	\+ d4(x,b,_,_),
+	assertion(d4(a,b,_,_)),
+	assertz(d4(a,c,x,x)),
+	assertion(d4(a,c,_,_)),
+	retract(d4(a,c,_,_)),
+	\+ d4(a,c,_,_),
+	assertz(d4(_,_,y,y)),
+	assertion(d4(x,b,_,_)).
+test(hot, [ setup(( current_prolog_flag(hot_predicate_threshold, Old),
+		     set_prolog_flag(hot_predicate_threshold, 10)
+		   )),
+	    cleanup(set_prolog_flag(hot_predicate_threshold, Old))
+	  ]) :-
+	forall(between(1, 20, _), s(c, _)),
+	assertion('$fetch_vm'(s(_,_), 0, _, s_switch(_))),
+	assertion(s(b, 2)),
+	assertion(s(f(_), 4)),
+	assertion(\+ s(f(y), _)),
+	assertion(s(1.5, 5)),
+	assertion(s("s", 6)),
+	assertion(\+ s(d, _)),
+	assertion(\+ s(1, _)),
+	findall(X-Y, s(X,Y), Pairs),
+	assertion(length(Pairs, 6)).
+test(range, [cleanup(retractall(d(_,_))), Ts == [5-50,6-60,7-70]]) :-
+	forall(between(1,1000,X), (Y is X*10, assertz(d(X,Y)))),
+	findall(X-Y, range_call(d(X,Y), 2, 45, 70), Ts).
+test(range, [cleanup(retractall(d(_,_))), Ys == ["s",1.5,2,3,a,b]]) :-
+	assertz(d(v, _)),
+	forall(between(1,3,X), assertz(d(X,X))),
+	assertz(d(b, b)),
+	assertz(d(x, 1.5)),
+	assertz(d(y, a)),
+	assertz(d(z, "s")),
+	findall(Y, range_call(d(_,Y), 2, 1.2, b), Ys).
+test(range, [cleanup(retractall(d(_,_))), Xs == [1,2,4,5]]) :-
+	forall(between(1,5,X), assertz(d(X,X))),
+	findall(X, range_call(d(X,_), 2, _, 5), _),
+	retract(d(3,_)),
+	findall(X, range_call(d(X,_), 2, _, 5), Xs).
+test(range, [cleanup(retractall(d(_,_))), Xs == [1,2,3]]) :-
+	forall(between(1,3,X), assertz(d(X,X))),
+	findall(X,
+		( range_call(d(X,_), 2, _, _),
+		  forall(between(10,100,Y), assertz(d(Y,Y)))
+		), Xs).
+test(range, error(domain_error(argument, 3))) :-
+	range_call(d(_,_), 3, 1, 2).
+
 :- end_tests(jit).
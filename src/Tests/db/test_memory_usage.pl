@@ -0,0 +1,92 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_memory_usage,
+          [ test_memory_usage/0
+          ]).
+:- use_module(library(plunit)).
+:- use_module(library(lists)).
+
+/** <module> Test memory_usage/2
+*/
+
+test_memory_usage :-
+    run_tests([ memory_usage
+              ]).
+
+:- dynamic
+    mu/2.
+
+usage(Object, Category, Bytes) :-
+    memory_usage(Object, Usage),
+    memberchk(Category-Bytes, Usage).
+
+:- begin_tests(memory_usage, [cleanup(retractall(mu(_,_)))]).
+
+test(clauses, true) :-
+    retractall(mu(_,_)),
+    usage(predicate(test_memory_usage:mu/2), clauses, C0),
+    forall(between(1, 100, I), assertz(mu(I, a))),
+    usage(predicate(test_memory_usage:mu/2), clauses, C1),
+    assertion(C1 > C0),
+    retract(mu(1, _)),
+    usage(predicate(test_memory_usage:mu/2), clauses, C2),
+    assertion(C2 < C1),
+    assertion(C2 > C0),
+    retractall(mu(_,_)),
+    usage(predicate(test_memory_usage:mu/2), clauses, C3),
+    assertion(C3 == C0).
+test(total, true(Total =:= Sum)) :-
+    assertz(mu(1, a)),
+    memory_usage(predicate(test_memory_usage:mu/2), Usage),
+    select(total-Total, Usage, Rest),
+    foldl([_-B,S0,S]>>(S is S0+B), Rest, 0, Sum).
+test(module, true) :-
+    forall(between(1, 100, I), assertz(mu(I, a))),
+    usage(predicate(test_memory_usage:mu/2), clauses, P),
+    usage(module(test_memory_usage), clauses, M),
+    assertion(M >= P).
+test(enum, true) :-
+    assertion(memory_usage(module(system), _)),
+    once(memory_usage(predicate(PI), _)),
+    assertion(ground(PI)).
+test(thread, true(S > 0)) :-
+    thread_self(Me),
+    usage(thread(Me), stacks, S).
+test(system, true(T > 0)) :-
+    usage(system, total, T).
+test(existence, fail) :-
+    memory_usage(module(no_such_module_for_memory_usage), _).
+
+:- end_tests(memory_usage).
@@ -49,6 +49,8 @@ test_thread :-
 
 :- begin_tests(thread, [condition(current_prolog_flag(threads,true))]).
 
+:- dynamic late/0.
+
 test(true, true) :-
 	concurrent(2, [true], []).
 test(unify, true(A==3)) :-
@@ -59,6 +61,14 @@ test(fail, fail) :-
 	concurrent(2, [_A=3, fail, _B = 4], []).
 test(error, throws(x)) :-
 	concurrent(2, [_A=3, throw(x), _B = 4], []).
+test(interrupt, true(Late == false)) :-
+	retractall(late),
+	\+ concurrent(2, [(sleep(0.1),fail), (sleep(2),assertz(late))], []),
+	sleep(2.5),
+	(   late
+	->  Late = true
+	;   Late = false
+	).
 test(concur, true) :-
 	forall(between(0, 20, _),
 	       (   concurrent(2, [X=1,Y=2], []),
@@ -73,6 +83,44 @@ test(first, true(X==1)) :-
 test(first, true(X==1)) :-
 	first_solution(X, [(repeat,fail), X=1], []).
 
+test(maplist, true(Sum == 333338333350000)) :-
+	numlist(1, 100000, L),
+	with_cpu_count(4, concurrent_maplist(square, L, L2)),
+	sum_list(L2, Sum).
+test(maplist, fail) :-
+	numlist(1, 1000, L),
+	with_cpu_count(4, concurrent_maplist(>(900), L)).
+test(maplist, throws(x)) :-
+	numlist(1, 1000, L),
+	with_cpu_count(4, concurrent_maplist(throw_at(500), L)).
+test(maplist_nested, true) :-
+	numlist(1, 20, L),
+	with_cpu_count(4, concurrent_maplist(inner_maplist, L)).
+test(forall, true) :-
+	concurrent_forall(between(1, 10000, X), X > 0, [threads(4)]).
+test(forall, fail) :-
+	concurrent_forall(between(1, 10000, X), X < 9000, [threads(4)]).
+test(forall, throws(x)) :-
+	concurrent_forall(between(1, 100, X), throw_at(50, X), [threads(3)]).
+
+square(X, Y) :-
+	Y is X*X.
+
+throw_at(N, N) :- !,
+	throw(x).
+throw_at(_, _).
+
+inner_maplist(_) :-
+	numlist(1, 50, L),
+	concurrent_maplist(square, L, _).
+
+with_cpu_count(N, Goal) :-
+	current_prolog_flag(cpu_count, Old),
+	setup_call_cleanup(
+	    set_prolog_flag(cpu_count, N),
+	    Goal,
+	    set_prolog_flag(cpu_count, Old)).
+
 :- end_tests(thread).
 
 :- endif.
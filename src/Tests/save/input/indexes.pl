@@ -0,0 +1,76 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2024, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+% Facts that are best indexed on the second argument.
+
+fact(c, k1, 1).
+fact(c, k2, 2).
+fact(c, k3, 0).
+fact(c, k4, 1).
+fact(c, k5, 2).
+fact(c, k6, 0).
+fact(c, k7, 1).
+fact(c, k8, 2).
+fact(c, k9, 0).
+fact(c, k10, 1).
+fact(c, k11, 2).
+fact(c, k12, 0).
+fact(c, k13, 1).
+fact(c, k14, 2).
+fact(c, k15, 0).
+fact(c, k16, 1).
+fact(c, k17, 2).
+fact(c, k18, 0).
+fact(c, k19, 1).
+fact(c, k20, 2).
+fact(c, k21, 0).
+fact(c, k22, 1).
+fact(c, k23, 2).
+fact(c, k24, 0).
+fact(c, k25, 1).
+fact(c, k26, 2).
+fact(c, k27, 0).
+fact(c, k28, 1).
+fact(c, k29, 2).
+fact(c, k30, 0).
+fact(c, k31, 1).
+fact(c, k32, 2).
+fact(c, k33, 0).
+fact(c, k34, 1).
+fact(c, k35, 2).
+fact(c, k36, 0).
+fact(c, k37, 1).
+fact(c, k38, 2).
+fact(c, k39, 0).
+fact(c, k40, 1).
@@ -131,6 +131,24 @@ test(rat,
              Expected, Found,
              [ optimise(true) ]),
     debug(qlf(result), '~q~n~q', [Expected, Found]).
+test(indexes,
+     [ Found == [1],
+       setup(( test_files(indexes, Prolog, Qlf),
+               current_prolog_flag(qlf_indexes, Old),
+               set_prolog_flag(qlf_indexes, true)
+             )),
+       cleanup(( set_prolog_flag(qlf_indexes, Old),
+                 catch(delete_file(Qlf), _, true)
+               ))
+     ]) :-
+    catch(delete_file(Qlf), _, true),
+    load_files(Prolog, ['$qlf'(Qlf)]),
+    unload_file(Prolog),
+    consult(Qlf),
+    predicate_property(fact(_,_,_), indexed(Indexed)),
+    assertion(memberchk(single(2)-_, Indexed)),
+    findall(V, fact(c, k7, V), Found),
+    unload_file(Qlf).
 
 :- end_tests(qlf).
 
@@ -0,0 +1,124 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        jan@swi-prolog.org
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(queue_batch,
+	  [ queue_batch/0
+	  ]).
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Test thread_send_messages/2 and thread_get_messages/4.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+queue_batch :-
+	batch_order,
+	batch_timeout,
+	batch_bounded,
+	batch_pipeline(10000),
+	batch_errors.
+
+batch_order :-
+	message_queue_create(Q),
+	thread_send_messages(Q, [a,b,c]),
+	thread_send_message(Q, d),
+	thread_send_messages(Q, [e,f(_)]),
+	thread_send_messages(Q, []),
+	thread_get_messages(Q, 2, L1, []),
+	L1 == [a,b],
+	thread_get_messages(Q, 10, L2, []),
+	L2 = [c,d,e,f(X)], var(X),
+	message_queue_destroy(Q).
+
+batch_timeout :-
+	message_queue_create(Q),
+	\+ thread_get_messages(Q, 10, _, [timeout(0)]),
+	\+ thread_get_messages(Q, 10, _, [timeout(0.01)]),
+	thread_send_message(Q, a),
+	\+ thread_get_messages(Q, 10, [b], [timeout(0)]),
+	thread_get_messages(Q, 10, [a], [timeout(0)]),
+	message_queue_destroy(Q).
+
+batch_bounded :-
+	message_queue_create(Q, [max_size(2)]),
+	thread_create(receive_all(Q, 3, 20, []), Id, []),
+	numlist(1, 20, L),
+	thread_send_messages(Q, L),
+	thread_join(Id, exited(Got)),
+	Got == L,
+	message_queue_destroy(Q).
+
+receive_all(_, _, 0, Acc) :- !,
+	reverse(Acc, List),
+	append(List, All),
+	thread_exit(All).
+receive_all(Q, Max, N, Acc) :-
+	thread_get_messages(Q, Max, L, []),
+	length(L, Len),
+	assertion((Len >= 1, Len =< Max)),
+	N1 is N-Len,
+	receive_all(Q, Max, N1, [L|Acc]).
+
+batch_pipeline(N) :-
+	message_queue_create(Q),
+	numlist(1, N, All),
+	thread_create(send_chunks(Q, All), Id, []),
+	receive_all_det(Q, N, Got),
+	thread_join(Id, true),
+	Got == All,
+	message_queue_destroy(Q).
+
+send_chunks(_, []) :- !.
+send_chunks(Q, List) :-
+	length(Chunk, 100),
+	(   append(Chunk, Rest, List)
+	->  thread_send_messages(Q, Chunk),
+	    send_chunks(Q, Rest)
+	;   thread_send_messages(Q, List)
+	).
+
+receive_all_det(Q, N, All) :-
+	thread_create(receive_all(Q, 64, N, []), Id, []),
+	thread_join(Id, exited(All)).
+
+batch_errors :-
+	catch(thread_get_messages(no_such_queue, 1, _, []), E1, true),
+	subsumes_term(error(existence_error(message_queue, _), _), E1),
+	catch(thread_send_messages(no_such_queue, [a]), E2, true),
+	subsumes_term(error(existence_error(message_queue, _), _), E2),
+	message_queue_create(Q),
+	catch(thread_get_messages(Q, 0, _, []), E3, true),
+	subsumes_term(error(domain_error(not_less_than_one, 0), _), E3),
+	catch(thread_send_messages(Q, [a|_]), E4, true),
+	subsumes_term(error(instantiation_error, _), E4),
+	message_queue_property(Q, size(0)),
+	message_queue_destroy(Q).
@@ -0,0 +1,116 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        jan@swi-prolog.org
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(queue_index,
+	  [ queue_index/0
+	  ]).
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Test selective receive on a  queue   that  holds many other messages. If
+get_message() skips enough messages for a  pattern with a bound first
+argument it indexes the queue. These tests  verify that the index keeps
+the semantics: messages are delivered in   order  and messages with an
+unbound first argument or that are unbound themselves still match.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+queue_index :-
+	reply_order,
+	unbound_first,
+	peek_indexed,
+	thread_queue.
+
+filled_queue(Q, Noise) :-
+	message_queue_create(Q),
+	forall(between(1, Noise, I), thread_send_message(Q, noise(I))).
+
+reply_order :-
+	filled_queue(Q, 10000),
+	forall(between(1, 500, I),
+	       ( thread_send_message(Q, reply(I, first(I))),
+		 thread_send_message(Q, reply(I, second(I)))
+	       )),
+	forall(between(1, 500, I0),
+	       ( I is 501-I0,
+		 thread_get_message(Q, reply(I, X)),
+		 X == first(I),
+		 thread_get_message(Q, reply(I, Y)),
+		 Y == second(I)
+	       )),
+	\+ thread_get_message(Q, reply(_,_), [timeout(0)]),
+	message_queue_property(Q, size(10000)),
+	thread_get_message(Q, noise(1)),
+	message_queue_destroy(Q).
+
+unbound_first :-
+	filled_queue(Q, 1000),
+	thread_send_message(Q, reply(_, any)),
+	thread_send_message(Q, reply(1, one)),
+	thread_send_message(Q, _),
+	thread_send_message(Q, reply(2, two)),
+	thread_get_message(Q, reply(1, X1)), X1 == any,	% builds index
+	thread_get_message(Q, reply(2, X2)), var(X2),	% unbound message
+	thread_get_message(Q, reply(2, X3)), X3 == two,
+	thread_get_message(Q, reply(1, X4)), X4 == one,
+	message_queue_destroy(Q).
+
+peek_indexed :-
+	filled_queue(Q, 1000),
+	thread_send_message(Q, reply(a, 1)),
+	thread_get_message(Q, reply(a, _)),		% builds index
+	thread_send_message(Q, reply(b, 2)),
+	thread_peek_message(Q, reply(b, X)), X == 2,
+	\+ thread_peek_message(Q, reply(a, _)),
+	thread_get_message(Q, reply(b, Y)), Y == 2,
+	message_queue_destroy(Q).
+
+thread_queue :-
+	thread_self(Me),
+	thread_create(replier(Me), Id, []),
+	forall(between(1, 1000, I), thread_send_message(Id, noise(I))),
+	forall(between(1, 100, I), thread_send_message(Id, request(I))),
+	thread_send_message(Id, done),
+	forall(between(1, 100, I0),
+	       ( I is 101-I0,
+		 thread_get_message(reply(I, X)),
+		 X =:= I*I
+	       )),
+	thread_join(Id, true).
+
+replier(Client) :-
+	thread_get_message(done),
+	forall(between(1, 100, I),
+	       ( thread_get_message(request(I)),
+		 Sq is I*I,
+		 thread_send_message(Client, reply(I, Sq))
+	       )).
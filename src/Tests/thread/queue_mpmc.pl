@@ -0,0 +1,120 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        jan@swi-prolog.org
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(queue_mpmc,
+	  [ queue_mpmc/0,
+	    queue_mpmc/3
+	  ]).
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Stress the lock-free path  of  thread_send_message/2  with  many senders
+and readers on the same queue.  Every  reader   checks  that it receives
+the messages of each sender in   order.   A selective reader waiting for
+marked messages runs concurrently to  exercise   the  slow path. We also
+verify that the size property includes messages that are not yet moved
+to the ordered part of the queue.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+queue_mpmc :-
+	queue_mpmc(8, 4, 2000),
+	pending_size(1000).
+
+queue_mpmc(Senders, Readers, Count) :-
+	message_queue_create(Q),
+	thread_create(selective(Q, Senders), Sel, []),
+	length(RIds, Readers),
+	maplist(reader(Q), RIds),
+	length(SIds, Senders),
+	numlist(1, Senders, SNums),
+	maplist(sender(Q, Count), SNums, SIds),
+	maplist(thread_join_true, SIds),
+	forall(member(_, RIds), thread_send_message(Q, done)),
+	maplist(thread_join_exited, RIds, Counts),
+	thread_join(Sel, exited(Marked)),
+	sum_list(Counts, Total),
+	Total =:= Senders*Count,
+	Marked =:= Senders,
+	message_queue_destroy(Q).
+
+sender(Q, Count, Me, Id) :-
+	thread_create(send_loop(Q, Me, Count), Id, []).
+
+send_loop(Q, Me, Count) :-
+	forall(between(1, Count, I),
+	       thread_send_message(Q, msg(Me, I))),
+	thread_send_message(Q, marked(Me)).
+
+reader(Q, Id) :-
+	thread_create(read_loop(Q, _{}, 0), Id, []).
+
+read_loop(Q, Seen, N) :-
+	thread_get_message(Q, Msg),
+	(   Msg == done
+	->  thread_exit(N)
+	;   Msg = msg(S, I)
+	->  (   Last = Seen.get(S)
+	    ->  assertion(I > Last)
+	    ;   true
+	    ),
+	    N1 is N+1,
+	    read_loop(Q, Seen.put(S, I), N1)
+	;   thread_send_message(Q, Msg),	% marked/1: not for us
+	    read_loop(Q, Seen, N)
+	).
+
+selective(Q, Senders) :-
+	selective(Q, Senders, 0).
+
+selective(_, N, N) :- !,
+	thread_exit(N).
+selective(Q, Senders, N0) :-
+	thread_get_message(Q, marked(_)),
+	N is N0+1,
+	selective(Q, Senders, N).
+
+pending_size(Count) :-
+	message_queue_create(Q),
+	forall(between(1, Count, I), thread_send_message(Q, I)),
+	message_queue_property(Q, size(Size)),
+	Size == Count,
+	findall(X, (between(1, Count, _), thread_get_message(Q, X)), Xs),
+	numlist(1, Count, Xs),
+	message_queue_property(Q, size(0)),
+	message_queue_destroy(Q).
+
+thread_join_true(Id) :-
+	thread_join(Id, true).
+
+thread_join_exited(Id, Value) :-
+	thread_join(Id, exited(Value)).
@@ -7,7 +7,8 @@
 :- use_module(library(apply)).
 
 test_engines :-
-	run_tests([ engines
+	run_tests([ engines,
+		    engine_pool
 		  ]).
 
 :- begin_tests(engines).
@@ -74,6 +75,70 @@ test(gc4, [sto(rational_trees)]) :-
 
 :- end_tests(engines).
 
+:- begin_tests(engine_pool,
+	       [ setup(engine_pool_create(test_pool, [size(1)])),
+		 cleanup(engine_pool_destroy(test_pool))
+	       ]).
+
+test(reuse, [E2 == E1, R2 == [b]]) :-
+	engine_checkout(test_pool, X, member(X, [a,b]), E1),
+	engine_next(E1, _),
+	engine_checkin(E1),
+	engine_checkout(test_pool, Y, member(Y, [b]), E2),
+	findall(A, engine_next(E2, A), R2),
+	engine_checkin(E2).
+test(gvar, R == clean) :-
+	pool_answer(X, (nb_setval(pool_var, 1), X = set), _),
+	pool_answer(Y, (nb_current(pool_var, _) -> Y = dirty ; Y = clean), R).
+test(tables, R == clean) :-
+	pool_answer(X, (pool_fib(10, X)), _),
+	pool_answer(Y, (current_table(pool_fib(_,_), _) -> Y = dirty ; Y = clean),
+		    R).
+test(fail, R == [a]) :-
+	engine_checkout(test_pool, _, fail, E),
+	assertion(\+ engine_next(E, _)),
+	engine_checkin(E),
+	pool_answer(X, X = a, A),
+	R = [A].
+test(error, Ex == foo) :-
+	engine_checkout(test_pool, _, throw(foo), E),
+	catch(engine_next(E, _), Ex, true),
+	engine_checkin(E).
+test(twice, error(permission_error(reset, engine, E))) :-
+	engine_checkout(test_pool, _, true, E),
+	engine_checkin(E),
+	engine_checkin(E).
+test(full, [E2 \== E1, Alive == false]) :-
+	engine_checkout(test_pool, _, true, E1),
+	engine_checkout(test_pool, _, true, E2),
+	engine_checkin(E1),
+	engine_checkin(E2),
+	(   is_engine(E2)
+	->  Alive = true
+	;   Alive = false
+	).
+test(no_pool, error(existence_error(engine_pool, no_pool))) :-
+	engine_checkout(no_pool, _, true, _).
+
+pool_answer(Templ, Goal, Answer) :-
+	engine_checkout(test_pool, Templ, Goal, E),
+	engine_next(E, Answer),
+	engine_checkin(E).
+
+:- table pool_fib/2.
+
+pool_fib(0, 0).
+pool_fib(1, 1).
+pool_fib(N, F) :-
+	N > 1,
+	N1 is N-1,
+	N2 is N-2,
+	pool_fib(N1, F1),
+	pool_fib(N2, F2),
+	F is F1+F2.
+
+:- end_tests(engine_pool).
+
 
 :- meta_predicate e_findall(?, 0, -).
 
@@ -0,0 +1,109 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        jan@swi-prolog.org
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_heap_quota,
+          [ test_heap_quota/0
+          ]).
+:- use_module(library(plunit)).
+
+/** <module> Test per-thread heap quotas
+
+Tests the Prolog flags heap_limit and heap_soft_limit and the hook
+prolog:heap_quota_exceeded/2.
+*/
+
+test_heap_quota :-
+    run_tests([ heap_quota
+              ]).
+
+:- multifile
+    prolog:heap_quota_exceeded/2.
+:- dynamic
+    quota_hit/2.
+:- thread_local
+    cache/1.
+
+prolog:heap_quota_exceeded(Used, Limit) :-
+    thread_self(Me),
+    assertz(quota_hit(Me, Used-Limit)),
+    retractall(cache(_)).
+
+in_thread(Goal, Status) :-
+    thread_create(Goal, Id, []),
+    thread_join(Id, Status).
+
+fill_bag(N) :-
+    findall(X-f(X), between(1, N, X), _).
+
+:- begin_tests(heap_quota).
+
+test(hard_limit, true(subsumes_term(Expected, Status))) :-
+    Expected = exception(error(resource_error(memory), _)),
+    in_thread(( set_prolog_flag(heap_limit, 1 000 000),
+                fill_bag(1 000 000)
+              ), Status).
+test(below_limit, Status == true) :-
+    in_thread(( set_prolog_flag(heap_limit, 10 000 000),
+                fill_bag(1 000)
+              ), Status).
+test(inherit, Status == exited(1 000 000)) :-
+    current_prolog_flag(heap_limit, Old),
+    setup_call_cleanup(
+        set_prolog_flag(heap_limit, 1 000 000),
+        in_thread(( current_prolog_flag(heap_limit, Limit),
+                    thread_exit(Limit)
+                  ), Status),
+        set_prolog_flag(heap_limit, Old)).
+test(soft_limit, cleanup(retractall(quota_hit(_,_)))) :-
+    in_thread(( set_prolog_flag(heap_soft_limit, 100 000),
+                forall(between(1, 10 000, I), assertz(cache(I))),
+                aggregate_all(count, cache(_), Count),
+                thread_exit(Count)
+              ), exited(Left)),
+    assertion(Left < 10 000),
+    findall(Used-Limit, quota_hit(_, Used-Limit), Hits),
+    length(Hits, Evictions),
+    assertion(Evictions > 1),
+    assertion(forall(member(Used-Limit, Hits),
+                     ( Limit == 100 000, Used > 100 000 ))).
+test(release, Used == 0) :-
+    in_thread(( forall(between(1, 1 000, I), assertz(cache(I))),
+                statistics(private_heap, Used0),
+                assertion(Used0 > 0),
+                retractall(cache(_)),
+                statistics(private_heap, Used1),
+                thread_exit(Used1)
+              ), exited(Used)).
+
+:- end_tests(heap_quota).
@@ -1,5 +1,6 @@
 #cmakedefine __CONDA__ @__CONDA__@
 #cmakedefine O_VMI_FUNCTIONS @O_VMI_FUNCTIONS@
+#cmakedefine O_VMI_PAIR_PROFILE @O_VMI_PAIR_PROFILE@
 #cmakedefine AC_APPLE_UNIVERSAL_BUILD @AC_APPLE_UNIVERSAL_BUILD@
 #cmakedefine ALIGNOF_DOUBLE @ALIGNOF_DOUBLE@
 #cmakedefine ALIGNOF_INT64_T @ALIGNOF_INT64_T@
@@ -54,6 +54,7 @@
 #include "../pl-wam.h"
 #include "../pl-trace.h"
 #include "../pl-setup.h"
+#include "../pl-supervisor.h"
 #include "../pl-modul.h"
 #include "../pl-version.h"
 #include <ctype.h>
@@ -1197,6 +1198,19 @@ set_prolog_flag_unlocked(DECL_LD Module m, atom_t k, term_t value, unsigned shor
 	  return PL_representation_error("size_t"),NULL;
 	if ( !set_stack_limit((size_t)i) )
 	  return FALSE;
+      } else if ( k == ATOM_heap_limit )
+      { if ( i < 0 || i > SIZE_MAX )
+	  return PL_representation_error("size_t"),NULL;
+	LD->heap_quota.limit = (size_t)i;
+      } else if ( k == ATOM_heap_soft_limit )
+      { if ( i < 0 || i > SIZE_MAX )
+	  return PL_representation_error("size_t"),NULL;
+	LD->heap_quota.soft_limit = (size_t)i;
+	LD->heap_quota.soft_raised = FALSE;
+      } else if ( k == ATOM_hot_predicate_threshold )
+      { if ( i < 0 || i > UINT_MAX )
+	  return PL_representation_error("uint"),NULL;
+	setHotPredicateThreshold((unsigned int)i);
       } else if ( k == ATOM_string_stack_tripwire )
       { if ( i < 0 || i > UINT_MAX )
 	  return PL_representation_error("uint"),NULL;
@@ -1216,6 +1230,20 @@ set_prolog_flag_unlocked(DECL_LD Module m, atom_t k, term_t value, unsigned shor
 
       if ( !PL_get_float_ex(value, &d) )
 	return FALSE;
+#ifdef O_ATOMGC
+      if ( k == ATOM_agc_max_pause )
+      { if ( d < 0.0 )
+	  return PL_error(NULL, 0, NULL, ERR_DOMAIN,
+			  ATOM_not_less_than_zero, value),NULL;
+	GD->atoms.max_pause = d;
+      }
+#endif
+      if ( k == ATOM_cgc_max_pause )
+      { if ( d < 0.0 )
+	  return PL_error(NULL, 0, NULL, ERR_DOMAIN,
+			  ATOM_not_less_than_zero, value),NULL;
+	GD->clauses.cgc_max_pause = d;
+      }
       f->value.f = d;
       break;
     }
@@ -1485,6 +1513,10 @@ unify_prolog_flag_value(DECL_LD Module m, atom_t key, prolog_flag *f, term_t val
   { return PL_unify_atom(val, accessLevel());
   } else if ( key == ATOM_stack_limit )
   { return PL_unify_int64(val, LD->stacks.limit);
+  } else if ( key == ATOM_heap_limit )
+  { return PL_unify_int64(val, LD->heap_quota.limit);
+  } else if ( key == ATOM_heap_soft_limit )
+  { return PL_unify_int64(val, LD->heap_quota.soft_limit);
   } else if ( tbl_is_restraint_flag(key) )
   { return tbl_get_restraint_flag(val, key) == TRUE;
   } else if ( is_arith_flag(key) )
@@ -1845,17 +1877,33 @@ initPrologFlags(void)
   setPrologFlag("large_files", FT_BOOL|FF_READONLY, TRUE, 0);
 #endif
   setPrologFlag("unload_foreign_libraries", FT_BOOL, FALSE, 0);
+  setPrologFlag("qlf_indexes", FT_BOOL, FALSE, PLFLAG_QLF_INDEXES);
+  setPrologFlag("index_bloom_filter", FT_BOOL, FALSE,
+		PLFLAG_INDEX_BLOOM_FILTER);
+  setPrologFlag("index_statistics", FT_BOOL, FALSE,
+		PLFLAG_INDEX_STATISTICS);
   setPrologFlag("gc",	  FT_BOOL,	       TRUE,  PLFLAG_GC);
   setPrologFlag("trace_gc",  FT_BOOL,	       FALSE, PLFLAG_TRACE_GC);
+  setPrologFlag("gc_generational", FT_BOOL,      FALSE, PLFLAG_GC_GENERATIONAL);
+  setPrologFlag("stack_huge_pages", FT_BOOL,     FALSE, PLFLAG_STACK_HUGE_PAGES);
+  setPrologFlag("stack_numa",	  FT_BOOL,	       FALSE, PLFLAG_STACK_NUMA);
+  setPrologFlag("stack_reserve",  FT_BOOL,	       FALSE, PLFLAG_STACK_RESERVE);
 #ifdef O_ATOMGC
   setPrologFlag("agc_margin", FT_INTEGER, (intptr_t)GD->atoms.margin);
+  setPrologFlag("agc_max_pause", FT_FLOAT, GD->atoms.max_pause);
   setPrologFlag("agc_close_streams", FT_BOOL, FALSE, PLFLAG_AGC_CLOSE_STREAMS);
 #endif
+  setPrologFlag("cgc_max_pause", FT_FLOAT, GD->clauses.cgc_max_pause);
+  setPrologFlag("hot_predicate_threshold", FT_INTEGER,
+		(intptr_t)GD->hot_predicates.threshold);
   setPrologFlag("table_space", FT_INTEGER, (intptr_t)GD->options.tableSpace);
 #ifdef O_PLMT
   setPrologFlag("shared_table_space", FT_INTEGER, (intptr_t)GD->options.sharedTableSpace);
 #endif
   setPrologFlag("stack_limit", FT_INTEGER, (intptr_t)LD->stacks.limit);
+  setPrologFlag("heap_limit", FT_INTEGER, (intptr_t)LD->heap_quota.limit);
+  setPrologFlag("heap_soft_limit", FT_INTEGER,
+		(intptr_t)LD->heap_quota.soft_limit);
 #ifdef O_DYNAMIC_EXTENSIONS
   setPrologFlag("open_shared_object",	     FT_BOOL|FF_READONLY, TRUE, 0);
   setPrologFlag("shared_object_extension",   FT_ATOM|FF_READONLY, SO_EXT);
@@ -35,6 +35,7 @@
     POSSIBILITY OF SUCH DAMAGE.
 */
 
+#define _GNU_SOURCE 1			/* mremap() */
 #define EMIT_ALLOC_INLINES 1
 #include "pl-incl.h"
 #include "os/pl-cstack.h"
@@ -48,6 +49,8 @@
 #include "pl-setup.h"
 #include "pl-pro.h"
 #include "pl-comp.h"
+#include "pl-proc.h"
+#include "pl-allocpool.h"
 #include <math.h>
 #ifdef HAVE_MALLOC_H
 #include <malloc.h>
@@ -69,6 +72,10 @@
 #endif
 #endif
 
+#if defined(MMAP_STACK) && !defined(HAVE_BOEHM_GC)
+#define O_SLAB 1
+#endif
+
 #undef LD
 #define LD LOCAL_LD
 
@@ -224,7 +231,7 @@ freeHeap(void *mem, size_t n)
 void
 linger_always(linger_list** list, void (*unalloc)(void *), void *object)
 { if ( GD->cleaning != CLN_DATA )
-  { linger_list *c = allocHeapOrHalt(sizeof(*c));
+  { linger_list *c = allocSlab(sizeof(*c));
     linger_list *o;
 
     c->generation = global_generation();
@@ -235,6 +242,7 @@ linger_always(linger_list** list, void (*unalloc)(void *), void *object)
     { o = *list;
       c->next = o;
     } while( !COMPARE_AND_SWAP_PTR(list, o, c) );
+    ATOMIC_INC(&GD->statistics.retired);
   } else
   { (*unalloc)(object);
   }
@@ -251,7 +259,9 @@ free_lingering(linger_list **list, gen_t generation)
       { p = &(*p)->next;
       }
       (*c->unalloc)(c->object);
-      freeHeap(c, sizeof(*c));
+      freeSlab(c, sizeof(*c));
+      ATOMIC_DEC(&GD->statistics.retired);
+      ATOMIC_INC(&GD->statistics.reclaimed);
     } else
     { p = &(*p)->next;
     }
@@ -1247,6 +1257,10 @@ heap_gc_warn_proc(char *msg, GC_word arg)
 }
 #endif
 
+#ifdef O_SLAB
+static void	initSlabs(void);
+#endif
+
 void
 initAlloc(void)
 { static int done = FALSE;
@@ -1287,6 +1301,9 @@ properly on Linux. Don't bother with it.
 #if O_MALLOC_DEBUG
   malloc_debug(O_MALLOC_DEBUG);
 #endif
+#ifdef O_SLAB
+  initSlabs();
+#endif
 }
 
 		 /*******************************
@@ -1298,6 +1315,7 @@ properly on Linux. Don't bother with it.
 
 typedef struct
 { size_t size;				/* Size (including header) */
+  size_t reserved;			/* Reserved address space */
   int	 mmapped;			/* Is mmapped? */
   double data[1];			/* ensure alignment */
 } map_region;
@@ -1378,6 +1396,7 @@ tmp_malloc(size_t req)
   if ( reg )
   { reg->size    = req;
     reg->mmapped = mmapped;
+    reg->reserved = 0;
 #ifdef O_DEBUG
     memset(reg->data, 0xFB, req-SA_OFFSET);
 #endif
@@ -1428,8 +1447,20 @@ tmp_realloc(void *mem, size_t req)
 
 	  return reg->data;
 	} else
-	{ void *ra = tmp_malloc(req);
+	{ void *ra;
+
+#ifdef MREMAP_MAYMOVE			/* move the pages rather than copy */
+	  if ( (ra=mremap(reg, reg->size, req, MREMAP_MAYMOVE)) != MAP_FAILED )
+	  { map_region *nreg = ra;
 
+#ifdef O_DEBUG
+	    memset((char*)nreg+nreg->size, 0xFB, req-nreg->size);
+#endif
+	    nreg->size = req;
+	    return nreg->data;
+	  }
+#endif
+	  ra = tmp_malloc(req);
 	  if ( ra )
 	  { memcpy(ra, mem, reg->size-SA_OFFSET);
 #ifdef O_DEBUG
@@ -1457,12 +1488,318 @@ tmp_free(void *mem)
   { map_region *reg = (map_region *)((char*)mem-SA_OFFSET);
 
     if ( reg->mmapped )
-      munmap(reg, reg->size);
+      munmap(reg, reg->reserved > reg->size ? reg->reserved : reg->size);
     else
       free(reg);
   }
 }
 
+
+		 /*******************************
+		 *	 STACK MEMORY POLICY	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Large stacks live in their own mmap()ed region.   If the Prolog flag
+stack_huge_pages is true we ask  the kernel to back them with transparent
+huge pages, which reduces  TLB  misses  for threads that use  large
+global stacks.  If  the flag stack_numa is true  and the affinity of the
+thread (see thread_affinity/3) is restricted to the CPUs of a single NUMA
+node, we ask the kernel to place the stack pages on that node and move
+pages that are elsewhere.  Both are Linux only.
+
+The policy is applied by the thread that owns the stacks whenever they
+are allocated or resized and when it changes its own affinity.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define HUGE_PAGE_SIZE (2*1024*1024)
+
+#if defined(__linux__) && defined(HAVE_SYS_SYSCALL_H) && \
+    defined(HAVE_SCHED_SETAFFINITY)
+#include <sys/syscall.h>
+#include <sched.h>
+#ifdef SYS_mbind
+#define O_NUMA_STACKS 1
+#endif
+#endif
+
+#ifdef O_NUMA_STACKS
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1<<1)
+#endif
+#define MAX_NUMA_NODES (sizeof(unsigned long)*8)
+
+static signed char *cpu_nodes = NULL;	/* CPU --> NUMA node */
+
+static void
+read_cpu_nodes(signed char *map)
+{ for(size_t node=0; node<MAX_NUMA_NODES; node++)
+  { char fname[64];
+    FILE *fd;
+
+    snprintf(fname, sizeof(fname),
+	     "/sys/devices/system/node/node%zd/cpulist", node);
+    if ( (fd=fopen(fname, "r")) )
+    { int from, to;
+      char sep;
+
+      while( fscanf(fd, "%d", &from) == 1 )
+      { to = from;
+	if ( (sep=fgetc(fd)) == '-' )
+	{ if ( fscanf(fd, "%d", &to) != 1 )
+	    break;
+	  sep = fgetc(fd);
+	}
+	for(int cpu=from; cpu<=to && cpu<CPU_SETSIZE; cpu++)
+	{ if ( cpu >= 0 )
+	    map[cpu] = (signed char)node;
+	}
+	if ( sep != ',' )
+	  break;
+      }
+      fclose(fd);
+    }
+  }
+}
+
+/* Return the NUMA node of the CPUs this thread may run on or -1 if this
+   is not a single node.
+*/
+
+static int
+thread_numa_node(void)
+{ signed char *map;
+  cpu_set_t set;
+  int node = -1;
+
+  if ( !(map=cpu_nodes) )
+  { if ( !(map = malloc(CPU_SETSIZE)) )
+      return -1;
+    memset(map, -1, CPU_SETSIZE);
+    read_cpu_nodes(map);
+    if ( !COMPARE_AND_SWAP_PTR(&cpu_nodes, NULL, map) )
+    { free(map);
+      map = cpu_nodes;
+    }
+  }
+
+  if ( sched_getaffinity(0, sizeof(set), &set) != 0 )
+    return -1;
+  for(int cpu=0; cpu<CPU_SETSIZE; cpu++)
+  { if ( CPU_ISSET(cpu, &set) )
+    { if ( map[cpu] < 0 || (node >= 0 && map[cpu] != node) )
+	return -1;
+      node = map[cpu];
+    }
+  }
+
+  return node;
+}
+#endif /*O_NUMA_STACKS*/
+
+static void
+stack_memory_policy(void *mem)
+{ GET_LD
+  map_region *reg;
+
+  if ( !mem || !HAS_LD )
+    return;
+  reg = (map_region *)((char*)mem-SA_OFFSET);
+  if ( !reg->mmapped )
+    return;
+
+#ifdef MADV_HUGEPAGE
+  if ( truePrologFlag(PLFLAG_STACK_HUGE_PAGES) &&
+       reg->size >= HUGE_PAGE_SIZE )
+    madvise(reg, reg->size, MADV_HUGEPAGE);
+#endif
+#ifdef O_NUMA_STACKS
+  if ( truePrologFlag(PLFLAG_STACK_NUMA) )
+  { int node = thread_numa_node();
+
+    if ( node >= 0 )
+    { unsigned long mask = 1UL<<node;
+
+      if ( syscall(SYS_mbind, reg, reg->size, MPOL_PREFERRED,
+		   &mask, MAX_NUMA_NODES, MPOL_MF_MOVE) != 0 )
+	DEBUG(MSG_STACK_OVERFLOW,
+	      Sdprintf("mbind(%p, node %d) failed: %s\n",
+		       reg, node, OsError()));
+    }
+  }
+#endif
+}
+
+
+		 /*******************************
+		 *	  RESERVED STACKS	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the Prolog flag stack_reserve is true, the stacks of a thread reserve
+address space for the stack limit  (see  the  flag stack_limit)  using
+PROT_NONE memory that does not count against the commit limit.  Pages are
+made accessible when the stack grows  and discarded when it shrinks, so
+the base address of the region never changes.   As a result, growing the
+trail does not move anything and growing the global stack only moves the
+local stack that lives  above it in the same region.  The stack shifter
+detects that the bases did not move and skips the relocation.
+
+If the stack limit is raised beyond the  reservation we create a larger
+reservation and move the pages  into it  using  mremap(),  which  is a
+one-time relocation.  A region that is reserved stays reserved when the
+flag is switched off.  Only available on 64-bit systems with mremap().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#if defined(MREMAP_FIXED) && SIZEOF_VOIDP == 8
+#define O_STACK_RESERVE 1
+#define MAX_STACK_RESERVE ((size_t)1<<38)	/* 256Gb */
+
+static size_t
+stack_reserve_size(map_region *reg, size_t req)
+{ GET_LD
+  size_t reserve;
+
+  if ( !HAS_LD ||
+       (!truePrologFlag(PLFLAG_STACK_RESERVE) && !(reg && reg->reserved)) )
+    return 0;
+
+  reserve = LD->stacks.limit;
+  if ( reserve > MAX_STACK_RESERVE )
+    reserve = MAX_STACK_RESERVE;
+  reserve = roundpgsize(reserve+SA_OFFSET);
+  if ( reserve < req )
+    reserve = req*2;
+
+  return reserve;
+}
+
+static map_region *
+reserve_region(size_t reserve, size_t commit)
+{ void *base = mmap(NULL, reserve, PROT_NONE,
+		    MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+
+  if ( base == MAP_FAILED )
+    return NULL;
+  if ( mprotect(base, commit, PROT_READ|PROT_WRITE) != 0 )
+  { munmap(base, reserve);
+    return NULL;
+  }
+
+  return base;
+}
+
+static void *
+reserved_malloc(size_t size)
+{ size_t req = roundpgsize(size+SA_OFFSET);
+  size_t reserve;
+  map_region *reg;
+
+  if ( !(reserve=stack_reserve_size(NULL, req)) ||
+       !(reg=reserve_region(reserve, req)) )
+    return NULL;
+
+  reg->size     = req;
+  reg->reserved = reserve;
+  reg->mmapped  = TRUE;
+#ifdef O_DEBUG
+  memset(reg->data, 0xFB, req-SA_OFFSET);
+#endif
+
+  return reg->data;
+}
+
+static int
+reserved_region(void *mem)
+{ map_region *reg = (map_region *)((char*)mem-SA_OFFSET);
+
+  return reg->mmapped && reg->reserved;
+}
+
+/* Resize a region within its reservation or move it to a new one.  Returns
+   NULL if the region cannot be handled this way, leaving it unmodified.
+   A region that is reserved must not be passed to tmp_realloc() as that
+   does not maintain the reservation.
+*/
+
+static void *
+reserved_realloc(void *mem, size_t size)
+{ map_region *reg = (map_region *)((char*)mem-SA_OFFSET);
+  size_t req = roundpgsize(size+SA_OFFSET);
+  size_t osize = reg->size;
+  size_t oreserved = reg->reserved;
+  size_t reserve;
+  map_region *nreg;
+
+  if ( !reg->mmapped )
+    return NULL;
+
+  if ( req <= osize )
+  { if ( !reg->reserved )
+      return NULL;
+    if ( req < osize )
+    { madvise((char*)reg+req, osize-req, MADV_DONTNEED);
+      mprotect((char*)reg+req, osize-req, PROT_NONE);
+      reg->size = req;
+    }
+    return mem;
+  }
+
+  if ( req <= reg->reserved )
+  { if ( mprotect((char*)reg+osize, req-osize, PROT_READ|PROT_WRITE) != 0 )
+      return NULL;
+  } else
+  { if ( !(reserve=stack_reserve_size(reg, req)) ||
+	 !(nreg=reserve_region(reserve, req)) )
+      return NULL;
+    if ( mremap(reg, osize, osize, MREMAP_MAYMOVE|MREMAP_FIXED,
+		nreg) == MAP_FAILED )
+    { munmap(nreg, reserve);
+      return NULL;
+    }
+    if ( oreserved > osize )		/* unmap the old reservation */
+      munmap((char*)reg+osize, oreserved-osize);
+    reg = nreg;
+    reg->reserved = reserve;
+  }
+
+#ifdef O_DEBUG
+  memset((char*)reg+osize, 0xFB, req-osize);
+#endif
+  reg->size = req;
+
+  return reg->data;
+}
+
+#else /*O_STACK_RESERVE*/
+
+static void *
+reserved_malloc(size_t size)
+{ (void)size;
+
+  return NULL;
+}
+
+static int
+reserved_region(void *mem)
+{ (void)mem;
+
+  return FALSE;
+}
+
+static void *
+reserved_realloc(void *mem, size_t size)
+{ (void)mem;
+  (void)size;
+
+  return NULL;
+}
+
+#endif /*O_STACK_RESERVE*/
+
 #else /*MMAP_STACK*/
 
 size_t
@@ -1541,14 +1878,58 @@ tmp_free(void *mem)
   free(sp);
 }
 
+static void
+stack_memory_policy(void *mem)
+{ (void)mem;
+}
+
+static void *
+reserved_malloc(size_t size)
+{ (void)size;
+
+  return NULL;
+}
+
+static int
+reserved_region(void *mem)
+{ (void)mem;
+
+  return FALSE;
+}
+
+static void *
+reserved_realloc(void *mem, size_t size)
+{ (void)mem;
+  (void)size;
+
+  return NULL;
+}
+
 #endif /*MMAP_STACK*/
 
+/* Re-apply the stack memory policy after the thread affinity changed */
+
+void
+applyStackMemoryPolicy(void)
+{ GET_LD
+
+  if ( HAS_LD && gBase )
+  { stack_memory_policy(gBase);
+    stack_memory_policy(tBase);
+  }
+}
+
 void *
 stack_malloc(size_t size)
-{ void *ptr = tmp_malloc(size);
+{ void *ptr;
+
+  if ( !(ptr = reserved_malloc(size)) )
+    ptr = tmp_malloc(size);
 
   if ( ptr )
-    ATOMIC_ADD(&GD->statistics.stack_space, tmp_malloc_size(ptr));
+  { ATOMIC_ADD(&GD->statistics.stack_space, tmp_malloc_size(ptr));
+    stack_memory_policy(ptr);
+  }
 
   return ptr;
 }
@@ -1558,9 +1939,12 @@ stack_realloc(void *mem, size_t size)
 { size_t osize = tmp_malloc_size(mem);
   void *ptr ;
   if(mem)
-    ptr = tmp_realloc(mem, size);
-  else
-    ptr = tmp_malloc(size);
+  { if ( !(ptr = reserved_realloc(mem, size)) && !reserved_region(mem) )
+      ptr = tmp_realloc(mem, size);
+  } else
+  { ptr = stack_malloc(size);
+    return ptr;
+  }
 
   if ( ptr )
   { size = tmp_malloc_size(ptr);
@@ -1569,6 +1953,8 @@ stack_realloc(void *mem, size_t size)
       ATOMIC_SUB(&GD->statistics.stack_space, osize-size);
     else
       ATOMIC_ADD(&GD->statistics.stack_space, size-osize);
+    if ( size > osize )
+      stack_memory_policy(ptr);
   }
 
   return ptr;
@@ -1593,6 +1979,481 @@ stack_nrealloc(void *mem, size_t req)
 }
 
 
+		 /*******************************
+		 *	   SLAB ALLOCATOR	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Clauses, clause references, the clause lists of the JIT indexes and the
+lingering records are allocated and  freed at  high rates  by assert/1,
+retract/1 and clause  garbage collection.  They  are  small and  come in
+few sizes.  We serve them from size classes  of SLAB_GRANULE bytes that
+are carved from SLAB_SIZE slabs  aligned on their  size.  This  avoids
+fragmenting  the malloc() heap  with  many short lived small objects and
+allows trimSlabs() to find the slab of an object by masking its address.
+
+Each  thread  keeps a  magazine  of  free  objects per  size class,  so
+allocSlab() and freeSlab() normally  do  not  lock.  If the magazine is
+empty or full, half of it is exchanged with the depot of the size class
+while holding its lock.  Objects may  be  freed by another  thread than
+the one that allocated them.
+
+Clauses and their references are only passed to freeSlab() after they
+are invisible to all running generations (see free_lingering() and
+pl_garbage_collect_clauses()), so reuse is safe.  trimSlabs() is called
+after clause garbage collection and returns  slabs of which all objects
+are in the depot to the OS.
+
+Objects larger than SLAB_MAX_OBJECT are handled by allocHeap().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef O_SLAB
+
+#define SLAB_SIZE	(64*1024)
+#define SLAB_GRANULE	16
+#define SLAB_CLASSES	32
+#define SLAB_MAGAZINE	32
+#define SLAB_MAX_OBJECT	(SLAB_CLASSES*SLAB_GRANULE)
+#define SLAB_CLASS(n)	(((n)+SLAB_GRANULE-1)/SLAB_GRANULE-1)
+
+typedef struct slab_object
+{ struct slab_object *next;		/* Next free object */
+} slab_object;
+
+typedef struct slab
+{ struct slab  *next;			/* Next slab of this class */
+  size_t	nfree;			/* # free objects (trimSlabs()) */
+} slab;
+
+#define SLAB_HDR_SIZE \
+	((sizeof(slab)+SLAB_GRANULE-1) & ~(size_t)(SLAB_GRANULE-1))
+#define SLAB_OF(p) \
+	((slab*)((uintptr_t)(p) & ~(uintptr_t)(SLAB_SIZE-1)))
+
+typedef struct slab_class
+{ simpleMutex	mutex;			/* Guards the fields below */
+  size_t	size;			/* Size of the objects */
+  slab_object  *free;			/* Free objects */
+  size_t	free_count;		/* Length of free */
+  slab	       *slabs;			/* Slabs of this class */
+  char	       *top;			/* Carve new objects from here */
+  char	       *max;			/* End of the current slab */
+} slab_class;
+
+typedef struct slab_magazine
+{ unsigned int	count;			/* # objects in the magazine */
+  void	       *objects[SLAB_MAGAZINE];	/* The objects */
+} slab_magazine;
+
+struct slab_cache
+{ slab_magazine	classes[SLAB_CLASSES];	/* Magazine per size class */
+};
+
+static slab_class slab_classes[SLAB_CLASSES];
+static int slab_enabled = FALSE;
+
+static void
+initSlabs(void)
+{ if ( pgsize() <= SLAB_SIZE )
+  { for(int i=0; i<SLAB_CLASSES; i++)
+    { slab_class *sc = &slab_classes[i];
+
+      simpleMutexInit(&sc->mutex);
+      sc->size = (size_t)(i+1)*SLAB_GRANULE;
+    }
+    slab_enabled = TRUE;
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+newSlab() maps a new slab for sc.  As mmap() only guarantees page alignment
+we map twice the size and unmap the excess at both ends.  Must be called
+with sc->mutex locked.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+newSlab(slab_class *sc)
+{ char *base = mmap(NULL, 2*SLAB_SIZE, PROT_READ|PROT_WRITE,
+		    MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+  char *aligned, *end;
+  slab *s;
+
+  if ( base == MAP_FAILED )
+    return FALSE;
+
+  aligned = (char*)(((uintptr_t)base+SLAB_SIZE-1) & ~(uintptr_t)(SLAB_SIZE-1));
+  end     = aligned+SLAB_SIZE;
+  if ( aligned > base )
+    munmap(base, aligned-base);
+  if ( end < base+2*SLAB_SIZE )
+    munmap(end, (base+2*SLAB_SIZE)-end);
+
+  s = (slab*)aligned;
+  s->nfree  = 0;
+  s->next   = sc->slabs;
+  sc->slabs = s;
+  sc->top   = aligned+SLAB_HDR_SIZE;
+  sc->max   = end;
+  ATOMIC_ADD(&GD->statistics.slab_space, SLAB_SIZE);
+  DEBUG(MSG_CGC, Sdprintf("New slab %p for size %zd\n", s, sc->size));
+
+  return TRUE;
+}
+
+static void *
+depotAlloc(slab_class *sc)
+{ slab_object *o;
+
+  if ( (o=sc->free) )
+  { sc->free = o->next;
+    sc->free_count--;
+    return o;
+  }
+
+  if ( sc->top+sc->size > sc->max && !newSlab(sc) )
+    return NULL;
+  o = (slab_object*)sc->top;
+  sc->top += sc->size;
+
+  return o;
+}
+
+static inline void
+depotFree(slab_class *sc, void *mem)
+{ slab_object *o = mem;
+
+  o->next = sc->free;
+  sc->free = o;
+  sc->free_count++;
+}
+
+
+void *
+allocSlab(size_t n)
+{ if ( n > 0 && n <= SLAB_MAX_OBJECT && slab_enabled )
+  { GET_LD
+    int ci = SLAB_CLASS(n);
+    slab_class *sc = &slab_classes[ci];
+    slab_magazine *mag = NULL;
+    void *mem;
+
+    if ( HAS_LD && !LD->slab_cache_freed )
+    { if ( !LD->slab_cache )
+      { LD->slab_cache = allocHeapOrHalt(sizeof(*LD->slab_cache));
+	memset(LD->slab_cache, 0, sizeof(*LD->slab_cache));
+      }
+      mag = &LD->slab_cache->classes[ci];
+      if ( mag->count > 0 )
+	return mag->objects[--mag->count];
+    }
+
+    simpleMutexLock(&sc->mutex);
+    if ( mag )
+    { while ( mag->count < SLAB_MAGAZINE/2 && (mem=depotAlloc(sc)) )
+	mag->objects[mag->count++] = mem;
+      mem = mag->count > 0 ? mag->objects[--mag->count] : NULL;
+    } else
+    { mem = depotAlloc(sc);
+    }
+    simpleMutexUnlock(&sc->mutex);
+
+    if ( !mem )
+      outOfCore();
+
+    return mem;
+  }
+
+  return allocHeapOrHalt(n);
+}
+
+
+void
+freeSlab(void *mem, size_t n)
+{ if ( n > 0 && n <= SLAB_MAX_OBJECT && slab_enabled )
+  { GET_LD
+    int ci = SLAB_CLASS(n);
+    slab_class *sc = &slab_classes[ci];
+
+    if ( HAS_LD && LD->slab_cache )
+    { slab_magazine *mag = &LD->slab_cache->classes[ci];
+
+      if ( mag->count == SLAB_MAGAZINE )
+      { simpleMutexLock(&sc->mutex);
+	while ( mag->count > SLAB_MAGAZINE/2 )
+	  depotFree(sc, mag->objects[--mag->count]);
+	simpleMutexUnlock(&sc->mutex);
+      }
+      mag->objects[mag->count++] = mem;
+    } else
+    { simpleMutexLock(&sc->mutex);
+      depotFree(sc, mem);
+      simpleMutexUnlock(&sc->mutex);
+    }
+
+    return;
+  }
+
+  freeHeap(mem, n);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+freeSlabCache() is called when a  thread  terminates.   It  returns the
+objects in the magazines of the thread to the depot.  Objects allocated
+by the thread after this, e.g., from  exit  hooks that  run  later, are
+taken from the depot directly rather than creating a new cache that is
+never freed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+freeSlabCache(PL_local_data_t *ld)
+{ struct slab_cache *cache;
+
+  ld->slab_cache_freed = TRUE;
+  if ( (cache=ld->slab_cache) )
+  { ld->slab_cache = NULL;
+
+    for(int ci=0; ci<SLAB_CLASSES; ci++)
+    { slab_magazine *mag = &cache->classes[ci];
+
+      if ( mag->count > 0 )
+      { slab_class *sc = &slab_classes[ci];
+
+	simpleMutexLock(&sc->mutex);
+	while ( mag->count > 0 )
+	  depotFree(sc, mag->objects[--mag->count]);
+	simpleMutexUnlock(&sc->mutex);
+      }
+    }
+
+    freeHeap(cache, sizeof(*cache));
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+trimSlabs() unmaps slabs of which all objects are in the depot.  We count
+the free objects  per slab  and rebuild the free list without the objects
+of the slabs we release.  The slab we are carving from is never released
+and all other slabs have exactly `per_slab` objects.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+trimSlabs(void)
+{ if ( !slab_enabled )
+    return;
+
+  for(int ci=0; ci<SLAB_CLASSES; ci++)
+  { slab_class *sc = &slab_classes[ci];
+    size_t per_slab = (SLAB_SIZE-SLAB_HDR_SIZE)/sc->size;
+    slab_object *o, *keep = NULL;
+    size_t kept = 0;
+    slab *current, **sp;
+
+    simpleMutexLock(&sc->mutex);
+    if ( sc->free_count < per_slab )
+    { simpleMutexUnlock(&sc->mutex);
+      continue;
+    }
+
+    current = sc->max ? SLAB_OF(sc->max-1) : NULL;
+    for(slab *s=sc->slabs; s; s=s->next)
+      s->nfree = 0;
+    for(o=sc->free; o; o=o->next)
+      SLAB_OF(o)->nfree++;
+
+    for(o=sc->free; o; )
+    { slab_object *next = o->next;
+      slab *s = SLAB_OF(o);
+
+      if ( s == current || s->nfree < per_slab )
+      { o->next = keep;
+	keep = o;
+	kept++;
+      }
+      o = next;
+    }
+    sc->free       = keep;
+    sc->free_count = kept;
+
+    for(sp=&sc->slabs; *sp; )
+    { slab *s = *sp;
+
+      if ( s != current && s->nfree == per_slab )
+      { *sp = s->next;
+	DEBUG(MSG_CGC, Sdprintf("Releasing slab %p for size %zd\n",
+				  s, sc->size));
+	munmap(s, SLAB_SIZE);
+	ATOMIC_SUB(&GD->statistics.slab_space, SLAB_SIZE);
+      } else
+      { sp = &s->next;
+      }
+    }
+    simpleMutexUnlock(&sc->mutex);
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+slabFreeSpace() returns the number of  bytes in the slabs that are free
+for reuse.  Objects in the per-thread magazines are not included.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+size_t
+slabFreeSpace(void)
+{ size_t space = 0;
+
+  if ( slab_enabled )
+  { for(int ci=0; ci<SLAB_CLASSES; ci++)
+    { slab_class *sc = &slab_classes[ci];
+
+      simpleMutexLock(&sc->mutex);
+      space += sc->free_count*sc->size + (size_t)(sc->max-sc->top);
+      simpleMutexUnlock(&sc->mutex);
+    }
+  }
+
+  return space;
+}
+
+#else /*O_SLAB*/
+
+void *
+allocSlab(size_t n)
+{ return allocHeapOrHalt(n);
+}
+
+void
+freeSlab(void *mem, size_t n)
+{ freeHeap(mem, n);
+}
+
+void
+freeSlabCache(PL_local_data_t *ld)
+{ (void)ld;
+}
+
+void
+trimSlabs(void)
+{
+}
+
+size_t
+slabFreeSpace(void)
+{ return 0;
+}
+
+#endif /*O_SLAB*/
+
+
+		 /*******************************
+		 *	 THREAD HEAP QUOTA	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Heap memory that is allocated and released by a single thread or engine
+is accounted in LD->heap_quota.used.  This concerns the findall/3 bags
+(pl-bag.c) and the clauses of thread-local predicates.  Together with
+the private table space, this is compared against the flags
+heap_soft_limit and heap_limit.
+
+If the soft limit is exceeded we raise SIG_HEAP_QUOTA, which calls
+prolog:heap_quota_exceeded/2 at the next safe point such that the
+application can drop caches or abolish its private tables.  The hook is
+called again after the usage dropped below the soft limit.  If the hard
+limit is exceeded, chargeThreadHeap() returns FALSE and the caller
+raises resource_error(memory).
+
+Memory in the shared database, records and shared tables is not
+accounted here because it is not released by the thread that created
+it.
+
+LD->heap_quota.used is always updated  atomically because the clauses of
+thread-local predicates are credited   by  destroyLocalDefinitions() in
+the thread that destroys the predicate (see creditThreadHeap()).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+size_t
+threadHeapUsed(DECL_LD)
+{ size_t used = LD->heap_quota.used;
+
+  if ( LD->tabling.node_pool )
+    used += LD->tabling.node_pool->size;
+
+  return used;
+}
+
+
+/* Subtract bytes from the heap usage of ld, which need not be the
+   calling thread.  The usage never drops below zero.
+*/
+
+void
+creditThreadHeap(PL_local_data_t *ld, size_t bytes)
+{ size_t used;
+
+  do
+  { used = ld->heap_quota.used;
+  } while( !COMPARE_AND_SWAP_SIZE(&ld->heap_quota.used, used,
+				  used > bytes ? used-bytes : 0) );
+}
+
+
+int
+chargeThreadHeap(DECL_LD size_t bytes)
+{ size_t used;
+
+  ATOMIC_ADD(&LD->heap_quota.used, bytes);
+  if ( !LD->heap_quota.limit && !LD->heap_quota.soft_limit )
+    return TRUE;
+
+  used = threadHeapUsed();
+  if ( LD->heap_quota.limit && used > LD->heap_quota.limit )
+  { creditThreadHeap(LD, bytes);
+    return FALSE;
+  }
+  if ( LD->heap_quota.soft_limit && used > LD->heap_quota.soft_limit &&
+       !LD->heap_quota.soft_raised )
+  { LD->heap_quota.soft_raised = TRUE;
+    PL_raise(SIG_HEAP_QUOTA);
+  }
+
+  return TRUE;
+}
+
+
+void
+releaseThreadHeap(DECL_LD size_t bytes)
+{ creditThreadHeap(LD, bytes);
+
+  if ( LD->heap_quota.soft_raised &&
+       threadHeapUsed() <= LD->heap_quota.soft_limit )
+    LD->heap_quota.soft_raised = FALSE;
+}
+
+
+void
+callHeapQuotaHook(void)
+{ GET_LD
+  Procedure proc = PROCEDURE_heap_quota_exceeded2;
+
+  if ( isDefinedProcedure(proc) )
+  { fid_t fid;
+
+    if ( (fid = PL_open_foreign_frame()) )
+    { term_t av = PL_new_term_refs(2);
+
+      if ( PL_put_int64(av+0, threadHeapUsed()) &&
+	   PL_put_int64(av+1, LD->heap_quota.soft_limit) )
+	PL_call_predicate(NULL, PL_Q_NODEBUG|PL_Q_PASS_EXCEPTION, proc, av);
+
+      PL_close_foreign_frame(fid);
+    }
+  }
+}
+
+
 		 /*******************************
 		 *	       TCMALLOC		*
 		 *******************************/
@@ -1736,6 +2597,7 @@ heapUsed(void)
   {
 #ifdef MMAP_STACK
     val += GD->statistics.stack_space;
+    val += GD->statistics.slab_space;
 #endif
 
     return val;
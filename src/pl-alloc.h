@@ -60,7 +60,8 @@
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 The code calls linger_always() for lingering that needs to happen both
 single  and multi-threaded  and linger()  for lingering  that is  only
-needed for multi-threading.
+needed for multi-threading.  Data that belongs to a predicate must use
+retireDefinitionData() from pl-proc.c, which  makes clause GC reclaim it.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 typedef struct linger_list
@@ -73,6 +74,12 @@ typedef struct linger_list
 void	free_lingering(linger_list **list, gen_t generation);
 void	linger_always(linger_list** list, void (*func)(void *), void *obj);
 
+void *	allocSlab(size_t n);
+void	freeSlab(void *mem, size_t n);
+void	freeSlabCache(PL_local_data_t *ld);
+void	trimSlabs(void);
+size_t	slabFreeSpace(void);
+
 #ifdef O_PLMT
 #define linger(list, func, obj) linger_always(list, func, obj)
 #else
@@ -87,6 +94,9 @@ void	linger_always(linger_list** list, void (*func)(void *), void *obj);
 		 *******************************/
 
 #if USE_LD_MACROS
+#define	threadHeapUsed(_)			LDFUNC(threadHeapUsed, _)
+#define	chargeThreadHeap(bytes)			LDFUNC(chargeThreadHeap, bytes)
+#define	releaseThreadHeap(bytes)		LDFUNC(releaseThreadHeap, bytes)
 #define	allocGlobal(words)			LDFUNC(allocGlobal, words)
 #define	allocGlobalNoShift(words)		LDFUNC(allocGlobalNoShift, words)
 #define	f_pushArgumentStack(p)			LDFUNC(f_pushArgumentStack, p)
@@ -138,6 +148,12 @@ size_t		tmp_nrealloc(void *mem, size_t req);
 void *		stack_malloc(size_t req);
 void *		stack_realloc(void *mem, size_t req);
 void		stack_free(void *mem);
+void		applyStackMemoryPolicy(void);
+size_t		threadHeapUsed(void);
+int		chargeThreadHeap(size_t bytes);
+void		releaseThreadHeap(size_t bytes);
+void		creditThreadHeap(PL_local_data_t *ld, size_t bytes);
+void		callHeapQuotaHook(void);
 size_t		stack_nalloc(size_t req);
 size_t		stack_nrealloc(void *mem, size_t req);
 #ifndef xmalloc
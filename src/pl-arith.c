@@ -65,6 +65,7 @@ in this array.
 #include "pl-gc.h"
 #include "pl-read.h"
 #include "os/pl-prologflag.h"
+#include "pl-numarray.h"
 #include <math.h>
 #include <limits.h>
 #ifdef HAVE_FLOAT_H
@@ -148,7 +149,6 @@ typedef int (*ArithF3)(Number n1, Number n2, Number n3, Number r);
 
 #define LDFUNC_DECLARATIONS
 
-static int		ar_minus(Number n1, Number n2, Number r);
 static int		mul64(int64_t x, int64_t y, int64_t *r);
 static int		notLessThanZero(const char *f, int a, Number n);
 static int		mustBePositive(const char *f, int a, Number n);
@@ -803,6 +803,14 @@ isCurrentArithFunction(functor_t f)
 }
 
 
+/* True if f is one of the reductions over numeric arrays */
+
+bool
+isNumArrayFunctor(functor_t f)
+{ return isNumArrayFunction(isCurrentArithFunction(f));
+}
+
+
 int
 check_float(Number n)
 { PL_error_code code = ERR_NO_ERROR;
@@ -1055,6 +1063,12 @@ retry:
 	    goto error;
 	  break;
 	}
+	if ( arity <= 2 &&
+	     isNumArrayFunction(isCurrentArithFunction(term->definition)) )
+	{ if ( evalNumArrayFunction(term, n) != TRUE )
+	    goto error;
+	  break;
+	}
 
 	if ( arity == 0 )
 	{ functor = word2functor(term->definition);
@@ -1559,7 +1573,7 @@ pl_ar_add(Number n1, Number n2, Number r)
 }
 
 
-static int
+int
 ar_minus(Number n1, Number n2, Number r)
 { if ( !same_type_numbers(n1, n2) )
     return FALSE;
@@ -3397,7 +3411,7 @@ ar_rdiv(Number n1, Number n2, Number r)
 #endif /*O_BIGNUM*/
 
 
-static int
+int
 ar_divide(Number n1, Number n2, Number r)
 { GET_LD
 
@@ -4969,6 +4983,12 @@ static const ar_funcdef ar_funcdefs[] = {
   ADD(FUNCTOR_getbit2,		ar_getbit, 0),
   ADD(FUNCTOR_powm3,		ar_powm, 0),
 
+  ADD(FUNCTOR_sum1,		ar_numarray1, 0),	/* see pl-numarray.c */
+  ADD(FUNCTOR_mean1,		ar_numarray1, 0),
+  ADD(FUNCTOR_min1,		ar_numarray1, 0),
+  ADD(FUNCTOR_max1,		ar_numarray1, 0),
+  ADD(FUNCTOR_vdot2,		ar_numarray2, 0),
+
   ADD(FUNCTOR_eval1,		ar_eval, 0)
 };
 
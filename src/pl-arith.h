@@ -65,12 +65,15 @@
 int		ar_compare(Number n1, Number n2, int what);
 int		ar_compare_eq(Number n1, Number n2);
 int		pl_ar_add(Number n1, Number n2, Number r);
+int		ar_minus(Number n1, Number n2, Number r);
 int		ar_mul(Number n1, Number n2, Number r);
+int		ar_divide(Number n1, Number n2, Number r);
 word		pl_current_arithmetic_function(term_t f, control_t h);
 void		initArith(void);
 void		cleanupArith(void);
 int		indexArithFunction(functor_t fdef);
 functor_t	functorArithFunction(unsigned int n);
+bool		isNumArrayFunctor(functor_t f);
 bool		ar_func_n(int findex, int argc);
 int		ar_add_si(Number n, long add);
 int		valueExpression(term_t p, Number n);
@@ -42,6 +42,9 @@
 #include "pl-pro.h"
 #include "pl-read.h"
 #include "os/pl-ctype.h"
+#ifdef HAVE_SCHED_YIELD
+#include <sched.h>
+#endif
 #undef LD
 #define LD LOCAL_LD
 
@@ -781,6 +784,44 @@ markAtom(atom_t a)
   }
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+AGC holds L_REHASH_ATOMS while it runs.  Threads that need to rehash the
+atom table before they can create an  atom   have  to wait for AGC to
+complete.  With a large atom table and  many threads this is a noticeable
+pause.  If the flag agc_max_pause is   non-zero,  AGC runs in time slices:
+the loops over the atom array call agc_yield() every AGC_SLICE atoms and
+after marking each thread.  If the   current slice exceeds the target,
+agc_yield() releases the lock to allow pending rehashes to complete.
+
+This is safe because marking only uses   the  atom array, invalidateAtom()
+uses the current table and GD->atoms.gc_active  remains set, so atoms that
+are pushed onto the stacks while we yield are still marked.  We do not
+yield in the second phase of collectAtoms()   as  its snapshot of buckets
+in use must remain valid.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define AGC_SLICE 4096			/* # atoms between agc_yield() calls */
+
+static void
+agc_start_slice(void)
+{ if ( GD->atoms.max_pause > 0.0 )
+    GD->atoms.slice_start = WallTime();
+}
+
+static void
+agc_yield(void)
+{ if ( GD->atoms.max_pause > 0.0 &&
+       WallTime() - GD->atoms.slice_start > GD->atoms.max_pause )
+  { PL_UNLOCK(L_REHASH_ATOMS);
+#ifdef HAVE_SCHED_YIELD
+    sched_yield();
+#endif
+    PL_LOCK(L_REHASH_ATOMS);
+    GD->atoms.gc_yields++;
+    GD->atoms.slice_start = WallTime();
+  }
+}
+
 static void
 unmarkAtoms(void)
 { size_t index;
@@ -802,6 +843,8 @@ unmarkAtoms(void)
       if ( ATOM_IS_MARKED(a->references) )
       { ATOMIC_AND(&a->references, ~ATOM_MARKED_REFERENCE);
       }
+      if ( index % AGC_SLICE == 0 )
+	agc_yield();
     }
   }
 }
@@ -959,8 +1002,12 @@ collectAtoms(void)
 
     for(; index<upto; index++)
     { Atom a = b + index;
-      unsigned int ref = a->references;
+      unsigned int ref;
+
+      if ( index % AGC_SLICE == 0 )
+	agc_yield();
 
+      ref = a->references;
       if ( !ATOM_IS_VALID(ref) )
       { continue;
       }
@@ -1008,6 +1055,14 @@ collectAtoms(void)
 }
 
 
+#ifdef O_ENGINES
+static void
+markAtomsOnThreadStacks(PL_local_data_t *ld, void *ctx)
+{ markAtomsOnStacks(ld, ctx);
+  agc_yield();
+}
+#endif
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 pl_garbage_collect_atoms() realised the atom   garbage  collector (AGC).
 
@@ -1020,7 +1075,7 @@ pl_garbage_collect_atoms(void)
 { GET_LD
   int64_t oldcollected;
   int verbose = truePrologFlag(PLFLAG_TRACE_GC) && !LD->in_print_message;
-  double t;
+  double t, wall;
   sigset_t set;
   size_t reclaimed;
   int rc = TRUE;
@@ -1041,13 +1096,15 @@ pl_garbage_collect_atoms(void)
   }
 
   LD->atoms.gc_active = TRUE;
+  wall = WallTime();
   PL_LOCK(L_REHASH_ATOMS);
   blockSignals(&set);
   t = CpuTime(CPU_USER);
+  agc_start_slice();
   unmarkAtoms();
   markAtomsOnStacks(LD, NULL);
 #ifdef O_ENGINES
-  forThreadLocalDataUnsuspended(markAtomsOnStacks, NULL);
+  forThreadLocalDataUnsuspended(markAtomsOnThreadStacks, NULL);
   markAtomsMessageQueues();
 #endif
   oldcollected = GD->atoms.collected;
@@ -1060,6 +1117,7 @@ pl_garbage_collect_atoms(void)
   unblockSignals(&set);
   PL_UNLOCK(L_REHASH_ATOMS);
   LD->atoms.gc_active = FALSE;
+  GC_TELEMETRY(agc_pause, (WallTime() - wall)*1000000.0);
 
   if ( verbose )
     rc = printMessage(ATOM_informational,
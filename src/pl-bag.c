@@ -89,12 +89,15 @@ alloc_mem_pool(mem_pool *mp, size_t bytes)
   { ptr = &((char *)(mp->chunks+1))[mp->chunks->used];
     mp->chunks->used += ROUNDUP(bytes, sizeof(void*));
   } else
-  { size_t chunksize = tmp_nalloc(4000*((size_t)1<<mp->chunk_count++)+sizeof(mem_chunk));
+  { GET_LD
+    size_t chunksize = tmp_nalloc(4000*((size_t)1<<mp->chunk_count++)+sizeof(mem_chunk));
     mem_chunk *c;
 
     if ( bytes > chunksize-sizeof(mem_chunk) )
       chunksize = tmp_nalloc(bytes+sizeof(mem_chunk));
 
+    if ( !chargeThreadHeap(chunksize) )	/* see THREAD HEAP QUOTA */
+      return NULL;
     if ( (c=tmp_malloc(chunksize)) )
     { c->size    = chunksize-sizeof(mem_chunk);
       c->used    = ROUNDUP(bytes, sizeof(void*));
@@ -102,7 +105,9 @@ alloc_mem_pool(mem_pool *mp, size_t bytes)
       mp->chunks = c;
       ptr        = (char *)(mp->chunks+1);
     } else
+    { releaseThreadHeap(chunksize);
       return NULL;
+    }
   }
 
 #ifdef O_DEBUG
@@ -114,10 +119,12 @@ alloc_mem_pool(mem_pool *mp, size_t bytes)
 
 static void
 clear_mem_pool(mem_pool *mp)
-{ mem_chunk *c, *p;
+{ GET_LD
+  mem_chunk *c, *p;
 
   for(c=mp->chunks; c != &mp->first; c=p)
   { p = c->prev;
+    releaseThreadHeap(c->size+sizeof(mem_chunk));
     tmp_free(c);
   }
   mp->chunk_count = 1;
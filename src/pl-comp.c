@@ -80,6 +80,7 @@
 #define valHandleP(h)		valTermRef(h)
 
 static void	initVMIMerge(void);
+static void	initVMIPairProfile(void);
 static void	cleanupMerge(void);
 
 static void
@@ -179,6 +180,7 @@ initWamTable(DECL_LD)
   checkCodeTable();
   initSupervisors();
   initVMIMerge();
+  initVMIPairProfile();
 }
 
 void
@@ -202,6 +204,7 @@ initWamTable(DECL_LD)
 { checkCodeTable();
   initSupervisors();
   initVMIMerge();
+  initVMIPairProfile();
 }
 
 void
@@ -1294,6 +1297,7 @@ Variable table operations.
 #define	compileSimpleAddition(Word, compileInfo)	LDFUNC(compileSimpleAddition, Word, compileInfo)
 #define	compileArith(Word, compileInfo)			LDFUNC(compileArith, Word, compileInfo)
 #define	compileArithArgument(Word, compileInfo)		LDFUNC(compileArithArgument, Word, compileInfo)
+#define	arithUsesNumArrays(Word)			LDFUNC(arithUsesNumArrays, Word)
 #define	compileBodyUnify(arg, ci)			LDFUNC(compileBodyUnify, arg, ci)
 #define	compileBodyEQ(arg, ci)				LDFUNC(compileBodyEQ, arg, ci)
 #define	compileBodyNEQ(arg, ci)				LDFUNC(compileBodyNEQ, arg, ci)
@@ -1318,6 +1322,7 @@ forwards bool	compileSimpleAddition(Word, compileInfo *);
 #if O_COMPILE_ARITH
 forwards int	compileArith(Word, compileInfo *);
 forwards bool	compileArithArgument(Word, compileInfo *);
+forwards bool	arithUsesNumArrays(Word);
 #endif
 #if O_COMPILE_IS
 forwards int	compileBodyUnify(Word arg, compileInfo *ci);
@@ -1643,7 +1648,8 @@ pushTargetModule(target_module *tm, CompileInfo ci)
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 These  functions  provide  a  small    state-machine   that  merges  new
 instructions with the previous one. The  declarations of which sequences
-to merge are defined in initVMIMerge().
+to merge are defined in initVMIMerge().  Candidates for new merges can
+be found using the VMI pair profile (see below).
 
 TBD: After reduction, we should try reducing   with the previous one, as
 in: X, Y, Z --> X, YZ --> XYZ.
@@ -1742,6 +1748,70 @@ initMerge(CompileInfo ci)
 }
 
 
+		 /*******************************
+		 *	  VMI PAIR PROFILE	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the  system  is  configured  using   -DVMI_PAIR_PROFILE=ON,  the  VM
+counts how often each  VMI  is   executed  directly  after another VMI.
+'$vmi_pairs'/1 returns the non-zero  counts   as  Count-(VMI1-VMI2). This
+is used to find sequences that  are   worth  merging  into a single VMI
+using initVMIMerge().  Counting is not  thread-safe and thus approximate
+if multiple threads are running.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+initVMIPairProfile(void)
+{
+#ifdef O_VMI_PAIR_PROFILE
+  if ( !GD->vmi_profile.pairs )
+  { size_t size = sizeof(uint64_t)*I_HIGHEST*I_HIGHEST;
+
+    GD->vmi_profile.pairs = allocHeapOrHalt(size);
+    memset(GD->vmi_profile.pairs, 0, size);
+  }
+#endif
+}
+
+#ifdef O_VMI_PAIR_PROFILE
+static
+PRED_IMPL("$vmi_pairs", 1, vmi_pairs, 0)
+{ PRED_LD
+  term_t tail = PL_copy_term_ref(A1);
+  term_t head = PL_new_term_ref();
+  int i, j;
+
+  for(i=0; i<I_HIGHEST; i++)
+  { for(j=0; j<I_HIGHEST; j++)
+    { uint64_t count = GD->vmi_profile.pairs[i*I_HIGHEST+j];
+
+      if ( count &&
+	   !( PL_unify_list(tail, head, tail) &&
+	      PL_unify_term(head,
+			    PL_FUNCTOR, FUNCTOR_minus2,
+			      PL_INT64, (int64_t)count,
+			      PL_FUNCTOR, FUNCTOR_minus2,
+				PL_CHARS, codeTable[i].name,
+				PL_CHARS, codeTable[j].name) ) )
+	return FALSE;
+    }
+  }
+
+  return PL_unify_nil(tail);
+}
+
+
+static
+PRED_IMPL("$reset_vmi_pairs", 0, reset_vmi_pairs, 0)
+{ memset(GD->vmi_profile.pairs, 0,
+	 sizeof(uint64_t)*I_HIGHEST*I_HIGHEST);
+
+  return TRUE;
+}
+#endif /*O_VMI_PAIR_PROFILE*/
+
+
 static int
 mergeInstructions(CompileInfo ci, const vmi_merge *m, vmi c)
 { for(; m->code != I_HIGHEST; m++)
@@ -2059,7 +2129,7 @@ Finish up the clause.
       goto exit_fail;
     }
 
-    cl = PL_malloc_atomic(size);
+    cl = allocSlab(size);
     ATOMIC_ADD(&m->code_size, clsize);
     memcpy(cl, &clause, sizeofClause(0));
     memcpy(cl->codes, baseBuffer(&ci->codes, code), sizeOfBuffer(&ci->codes));
@@ -2528,7 +2598,9 @@ try_fast_condition(CompileInfo ci, size_t tc_or)
       case A_FUNC2:
       case A_FUNC:
       case A_ADD:
+      case A_SUB:
       case A_MUL:
+      case A_DIV:
       case A_LT:
       case A_LE:
       case A_GT:
@@ -3009,7 +3081,7 @@ A non-void variable. Create a I_USERCALL0 instruction for it.
 	   compileSimpleAddition(arg, ci) )
 	succeed;
 #if O_COMPILE_ARITH
-      if ( truePrologFlag(PLFLAG_OPTIMISE) )
+      if ( truePrologFlag(PLFLAG_OPTIMISE) && !arithUsesNumArrays(arg) )
 	 return compileArith(arg, ci);
 #endif
     }
@@ -3426,6 +3498,33 @@ compileArith(DECL_LD Word arg, compileInfo *ci)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The reductions over numeric arrays  (see   pl-numarray.c)  are  not VM
+arithmetic functions. Comparisons and is/2 calls   that use them are not
+compiled, so they are evaluated by evalExpression() at runtime.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static bool
+arithUsesNumArrays(DECL_LD Word arg)
+{ deRef(arg);
+
+  if ( isTerm(*arg) )
+  { functor_t fdef = functorTerm(*arg);
+    size_t n, arity = arityFunctor(fdef);
+    Word a = argTermP(*arg, 0);
+
+    if ( isNumArrayFunctor(fdef) )
+      return TRUE;
+    for(n=0; n<arity; n++, a++)
+    { if ( arithUsesNumArrays(a) )
+	return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
 #define arithVarOffset(arg, ci, offp) LDFUNC(arithVarOffset, arg, ci, offp)
 static int
 arithVarOffset(DECL_LD Word arg, compileInfo *ci, int *offp)
@@ -3573,10 +3672,18 @@ compileArithArgument(DECL_LD Word arg, compileInfo *ci)
     { Output_0(ci, A_ADD);
       succeed;
     }
+    if ( fdef == FUNCTOR_minus2 )
+    { Output_0(ci, A_SUB);
+      succeed;
+    }
     if ( fdef == FUNCTOR_star2 )
     { Output_0(ci, A_MUL);
       succeed;
     }
+    if ( fdef == FUNCTOR_divide2 )
+    { Output_0(ci, A_DIV);
+      succeed;
+    }
 
     switch(ar)
     { case 0:	Output_1(ci, A_FUNC0, index); break;
@@ -6030,9 +6137,15 @@ decompileBodyNoShift(DECL_LD decompileInfo *di, code end, Code until)
       case A_ADD:
 			    BUILD_TERM_REV(FUNCTOR_plus2);
 			    continue;
+      case A_SUB:
+			    BUILD_TERM_REV(FUNCTOR_minus2);
+			    continue;
       case A_MUL:
 			    BUILD_TERM_REV(FUNCTOR_star2);
 			    continue;
+      case A_DIV:
+			    BUILD_TERM_REV(FUNCTOR_divide2);
+			    continue;
       case A_FUNC0:
       case A_FUNC1:
       case A_FUNC2:
@@ -7831,7 +7944,7 @@ PRED_IMPL("$vm_assert", 3, vm_assert, PL_FA_TRANSPARENT)
     discardBuffer(&ci.codes);
     return rc;
   }
-  cl = PL_malloc_atomic(size);
+  cl = allocSlab(size);
   ATOMIC_ADD(&m->code_size, clsize);
   memcpy(cl, &clause, sizeofClause(0));
   GD->statistics.codes += clause.code_size;
@@ -8609,6 +8722,10 @@ BeginPredDefs(comp)
   PRED_SHARE("$rule",   2, rule,   META|NDET|PL_FA_CREF)
   PRED_SHARE("$rule",   3, rule,   META|NDET|PL_FA_CREF)
   PRED_DEF("nth_clause",  3, nth_clause, META|NDET)
+#ifdef O_VMI_PAIR_PROFILE
+  PRED_DEF("$vmi_pairs",	    1, vmi_pairs,	     0)
+  PRED_DEF("$reset_vmi_pairs",	    0, reset_vmi_pairs,	     0)
+#endif
 #ifdef O_DEBUGGER
   PRED_DEF("$vmi_property",	    2, vmi_property,	     0)
   PRED_DEF("$fetch_vm",		    4, fetch_vm,	     META)
@@ -1560,6 +1560,8 @@ retry:
     { if ( (flags&SETDICT_BACKTRACKABLE) )
 	TrailAssignment(vp);
       unify_vp(vp, val);
+      if ( !(flags&SETDICT_BACKTRACKABLE) && vp < LD->gen_bar )
+	gcAssignedOld(vp);
       return TRUE;
     }
 
@@ -405,6 +405,7 @@ DECL_PLIST(wrap);
 DECL_PLIST(event);
 DECL_PLIST(transaction);
 DECL_PLIST(undo);
+DECL_PLIST(numarray);
 DECL_PLIST(error);
 DECL_PLIST(coverage);
 DECL_PLIST(xterm);
@@ -487,6 +488,7 @@ initBuildIns(void)
   REG_PLIST(event);
   REG_PLIST(transaction);
   REG_PLIST(undo);
+  REG_PLIST(numarray);
   REG_PLIST(error);
   REG_PLIST(xterm);
 #ifdef O_COVERAGE
@@ -526,6 +528,8 @@ initBuildIns(void)
 	PL_predicate("prolog_exception_hook", 5, "prolog");
   PROCEDURE_tune_gc3 =
 	PL_predicate("tune_gc", 3, "prolog");
+  PROCEDURE_heap_quota_exceeded2 =
+	PL_predicate("heap_quota_exceeded", 2, "prolog");
 					/* allow debugging in call/1 */
   clear(PROCEDURE_dcall1->definition, HIDE_CHILDS|TRACE_ME);
   set(PROCEDURE_dcall1->definition, P_DYNAMIC|P_LOCKED);
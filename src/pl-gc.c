@@ -139,6 +139,7 @@ Marking, testing marks and extracting values from GC masked words.
 #define	marks_swept	   (LD->gc._marks_swept)
 #define	marks_unswept	   (LD->gc._marks_unswept)
 #define	alien_relocations  (LD->gc._alien_relocations)
+#define young_base	   (LD->gc._young_base)
 #define local_frames	   (LD->gc._local_frames)
 #define choice_count	   (LD->gc._choice_count)
 #define start_map	   (LD->gc._start_map)
@@ -226,6 +227,15 @@ domark(DECL_LD Word p)
 #define get_value(p)	(*(p) & VALUE_MASK)
 #define set_value(p, w)	do { *(p) &= GC_MASK; *(p) |= w; } while(0)
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A minor collection (see garbageCollect()) only processes the global stack
+above young_base.  Cells below it are considered alive and are neither
+marked nor moved.  For a normal (major) collection young_base is gBase.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define is_old(p)		((Word)(p) < young_base)
+#define is_marked_or_old(p)	(is_old(p) || is_marked(p))
+
 #define inShiftedArea(area, shift, ptr) \
 	((char *)ptr >= (char *)LD->stacks.area.base + shift && \
 	 (char *)ptr <  (char *)LD->stacks.area.max + shift )
@@ -565,7 +575,10 @@ gc_stat_aggregate(gc_stats *stats)
 static void
 gc_stat_start(DECL_LD gc_stats *stats, gc_reason_t reason)
 { gc_stat *this = &stats->last[stats->last_index];
+  gc_stat *prev = &stats->last[STAT_PREV_INDEX(stats->last_index)];
   double cpu = ThreadCPUTime(CPU_USER);
+  double wall = WallTime();
+  size_t allocated;
 
   if ( stats->last_index == 0 && this->global_before )
     gc_stat_aggregate(stats);
@@ -580,6 +593,14 @@ gc_stat_start(DECL_LD gc_stats *stats, gc_reason_t reason)
   this->local	      = usedStack(local);
   this->prolog_time   = cpu - stats->thread_cpu;
   stats->thread_cpu   = cpu;
+
+  allocated = ( this->global_before > prev->global_after
+		? this->global_before - prev->global_after : 0 );
+  LD->gc.telemetry.allocated += allocated;
+  ATOMIC_ADD(&GD->statistics.gc.allocated, allocated);
+  if ( stats->wall_end > 0.0 && wall > stats->wall_end )
+    GC_TELEMETRY(alloc_rate, (double)allocated/(wall - stats->wall_end));
+  stats->wall_start = wall;
 }
 
 #define gc_stat_end(stats) LDFUNC(gc_stat_end, stats)
@@ -587,6 +608,8 @@ static gc_stat *
 gc_stat_end(DECL_LD gc_stats *stats)
 { gc_stat *this = &stats->last[stats->last_index];
   double cpu = ThreadCPUTime(CPU_USER);
+  double wall = WallTime();
+  int64_t gained;
 
   this->global_after  = usedStack(global);
   this->trail_after   = usedStack(trail);
@@ -602,6 +625,12 @@ gc_stat_end(DECL_LD gc_stats *stats)
   stats->totals.time	      += this->gc_time;
   stats->totals.collections++;
 
+  gained = ( (int64_t)this->global_before - (int64_t)this->global_after +
+	     (int64_t)this->trail_before  - (int64_t)this->trail_after );
+  GC_TELEMETRY(gc_pause, (wall - stats->wall_start)*1000000.0);
+  GC_TELEMETRY(gc_reclaimed, gained > 0 ? gained : 0);
+  stats->wall_end = wall;
+
   if ( gc_percentage(this) > 0.2 )
     PL_raise(SIG_TUNE_GC);
 
@@ -703,6 +732,117 @@ PRED_IMPL("$gc_statistics", 5, gc_statistics, 0)
 }
 
 
+		 /*******************************
+		 *	   GC TELEMETRY		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+GC telemetry maintains histograms of the   pause times and yield of the
+various garbage collectors for  each  thread   (LD->gc.telemetry)  and for
+the process as a whole (GD->statistics.gc). Both are updated using the
+macro GC_TELEMETRY().  AGC and CGC  run  in   the  gc  thread  if this is
+enabled, so their per-thread figures appear in that thread.
+
+'$gc_telemetry'(+Scope, -List) returns the data for  Scope, which is one
+of `thread` or `process`, as a list   Name(Value),  where Value is an
+integer or a term histogram(Count, Sum, Max, Buckets).  Buckets is the
+list of counts, omitting trailing zeros.  See gcHistogramAdd() for the
+bucket boundaries.  library(statistics) provides the user interface.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+gcHistogramAdd(gc_histogram *h, uint64_t value)
+{ int i = (value == 0 ? 0 : MSB64((int64_t)value)+1);
+  uint64_t max;
+
+  if ( i >= GC_HIST_BUCKETS )
+    i = GC_HIST_BUCKETS-1;
+
+  ATOMIC_INC(&h->count);
+  ATOMIC_ADD(&h->sum, value);
+  ATOMIC_INC(&h->buckets[i]);
+  while ( value > (max=h->max) &&
+	  !COMPARE_AND_SWAP_UINT64(&h->max, max, value) )
+    ;
+}
+
+
+static const struct gc_histogram_decl
+{ const char *name;
+  size_t      offset;
+} gc_histograms[] =
+{ { "gc_pause",	    offsetof(gc_telemetry, gc_pause) },
+  { "gc_reclaimed", offsetof(gc_telemetry, gc_reclaimed) },
+  { "alloc_rate",   offsetof(gc_telemetry, alloc_rate) },
+  { "shift_pause",  offsetof(gc_telemetry, shift_pause) },
+  { "agc_pause",    offsetof(gc_telemetry, agc_pause) },
+  { "cgc_pause",    offsetof(gc_telemetry, cgc_pause) },
+  { NULL,	    0 }
+};
+
+
+#define unify_histogram(t, h) LDFUNC(unify_histogram, t, h)
+static int
+unify_histogram(DECL_LD term_t t, const gc_histogram *h)
+{ term_t buckets = PL_new_term_ref();
+  term_t count   = PL_new_term_ref();
+  int n;
+
+  for(n=GC_HIST_BUCKETS; n > 0 && h->buckets[n-1] == 0; n--)
+    ;
+  PL_put_nil(buckets);
+  while ( --n >= 0 )
+  { if ( !PL_put_int64(count, (int64_t)h->buckets[n]) ||
+	 !PL_cons_list(buckets, count, buckets) )
+      return FALSE;
+  }
+
+  return PL_unify_term(t, PL_FUNCTOR_CHARS, "histogram", 4,
+			    PL_INT64, (int64_t)h->count,
+			    PL_INT64, (int64_t)h->sum,
+			    PL_INT64, (int64_t)h->max,
+			    PL_TERM,  buckets);
+}
+
+
+static
+PRED_IMPL("$gc_telemetry", 2, gc_telemetry, 0)
+{ PRED_LD
+  atom_t scope;
+  const gc_telemetry *tm;
+  const struct gc_histogram_decl *d;
+  term_t tail = PL_copy_term_ref(A2);
+  term_t head = PL_new_term_ref();
+  term_t hist = PL_new_term_ref();
+
+  if ( !PL_get_atom_ex(A1, &scope) )
+    return FALSE;
+  if ( scope == ATOM_thread )
+    tm = &LD->gc.telemetry;
+  else if ( scope == ATOM_process )
+    tm = &GD->statistics.gc;
+  else
+    return PL_domain_error("gc_telemetry_scope", A1);
+
+  for(d=gc_histograms; d->name; d++)
+  { if ( !PL_put_variable(hist) ||
+	 !unify_histogram(hist, addPointer(tm, d->offset)) ||
+	 !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_term(head, PL_FUNCTOR_CHARS, d->name, 1,
+			        PL_TERM, hist) )
+      return FALSE;
+  }
+
+  return ( PL_unify_list(tail, head, tail) &&
+	   PL_unify_term(head, PL_FUNCTOR_CHARS, "allocated", 1,
+			         PL_INT64, (int64_t)tm->allocated) &&
+	   PL_unify_list(tail, head, tail) &&
+	   PL_unify_term(head, PL_FUNCTOR_CHARS, "shifts", 1,
+			         PL_INT64, (int64_t)tm->shifts) &&
+	   PL_unify_nil(tail) );
+}
+
+
 		/********************************
 		*          UTILITIES            *
 		*********************************/
@@ -891,6 +1031,8 @@ forward:				/* Go into the tree */
   { case TAG_REFERENCE:
     { next = unRef(val);		/* address pointing to */
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_first(next) )		/* ref to choice point. we will */
 	BACKWARD;			/* get there some day anyway */
@@ -906,6 +1048,8 @@ forward:				/* Go into the tree */
     { DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       next = valPtr(val);
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_marked(next) )
 	BACKWARD;			/* term has already been marked */
@@ -924,6 +1068,8 @@ forward:				/* Go into the tree */
       DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       next = valPtr(val);
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_marked(next) )
 	BACKWARD;			/* term has already been marked */
@@ -955,6 +1101,8 @@ forward:				/* Go into the tree */
 
       DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_marked(next) )		/* can be referenced from multiple */
 	BACKWARD;			/* places */
@@ -1271,6 +1419,152 @@ term_refs_to_argument_stack(vm_state *state, fid_t fid)
 }
 
 
+		 /*******************************
+		 *     GENERATIONAL GC		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the Prolog flag gc_generational is true, most collections are minor:
+they only process the part of the global  stack created after the last
+collection (the young generation).  Data that survives a collection is
+promoted to the old generation, which ranges from gBase to LD->gen_bar.
+
+A minor collection must know all  pointers   from  old  cells into the
+young generation. Old cells only get such a pointer by assignment and,
+because LD->mark_bar is kept at or   above LD->gen_bar (see DiscardMark()
+and Undo()), these assignments are  trailed.  The   trail  is  thus the
+remembered set.  Before the minor  collection   we  copy  the value of
+each  trailed  old  cell  that  points   into   the  young  generation
+into a term reference, such that it is marked and relocated as any other
+root.  Afterwards the relocated values are  copied back.  Assignments by
+nb_setarg/3 and friends are not  trailed   and  call  gcAssignedOld(),
+which forces the next collection to be major.
+
+A major collection is used if the   old  generation grows larger than
+LD->gc.gen.major_limit, set to twice  the   global  stack  usage after
+the last major collection, or if it  uses   more  than a quarter of the
+stack limit, such that we do not  raise   a  stack  overflow that a full
+collection could have avoided.  Explicit calls to garbage_collect/0 and
+collections due to an exception are always major.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define use_minor_gc(reason) LDFUNC(use_minor_gc, reason)
+static int
+use_minor_gc(DECL_LD gc_reason_t reason)
+{ const gc_reason_t stack_full = (GC_GLOBAL_OVERFLOW|GC_GLOBAL_REQUEST|
+				  GC_TRAIL_OVERFLOW|GC_TRAIL_REQUEST);
+  size_t old;
+
+  if ( !reason )
+    reason = LD->gc.stats.request;
+  if ( !truePrologFlag(PLFLAG_GC_GENERATIONAL) ||
+       LD->gen_bar <= gBase ||
+       LD->gc.gen.force_major ||
+       !(reason & stack_full) || (reason & ~stack_full) )
+    return FALSE;
+
+  old = (char*)LD->gen_bar - (char*)gBase;
+  if ( old < LD->gc.gen.major_limit && old < LD->stacks.limit/4 )
+  { DEBUG(CHK_SECURE, return FALSE);	/* checks assume a full GC */
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+#define is_remembered_cell(p) LDFUNC(is_remembered_cell, p)
+static inline int
+is_remembered_cell(DECL_LD Word p)
+{ if ( !isTrailVal(p) && p >= gBase && p < young_base )
+  { word w = get_value(p);
+
+    return isGlobalRef(w) && !is_old(valPtr(w));
+  }
+
+  return FALSE;
+}
+
+
+#define count_remembered_cells(_) LDFUNC(count_remembered_cells, _)
+static size_t
+count_remembered_cells(DECL_LD)
+{ TrailEntry te;
+  size_t count = 0;
+
+  for(te = tBase; te < tTop; te++)
+  { if ( is_remembered_cell(te->address) )
+      count++;
+  }
+
+  return count;
+}
+
+
+#define remembered_set_to_term_refs(cells) LDFUNC(remembered_set_to_term_refs, cells)
+static fid_t
+remembered_set_to_term_refs(DECL_LD Buffer cells)
+{ if ( young_base > gBase )
+  { fid_t fid = PL_open_foreign_frame();
+    TrailEntry te;
+    Word *cp, *ep;
+
+    for(te = tBase; te < tTop; te++)
+    { Word p = te->address;
+
+      if ( is_remembered_cell(p) && !is_first(p) )
+      { term_t t = PL_new_term_ref_noshift();
+
+	assert(t);
+	*valTermRef(t) = *p;
+	set_first(p);			/* avoid duplicates */
+	addBuffer(cells, p, Word);
+      }
+    }
+
+    cp = baseBuffer(cells, Word);
+    ep = cp + entriesBuffer(cells, Word);
+    for(; cp < ep; cp++)
+      clear_first(*cp);
+
+    DEBUG(MSG_GC_MARK_GVAR,
+	  Sdprintf("Minor GC: %zd old cells point to young data\n",
+		   entriesBuffer(cells, Word)));
+
+    return fid;
+  }
+
+  return 0;
+}
+
+
+#define term_refs_to_remembered_set(fid, cells) LDFUNC(term_refs_to_remembered_set, fid, cells)
+static void
+term_refs_to_remembered_set(DECL_LD fid_t fid, Buffer cells)
+{ if ( fid )
+  { FliFrame fr = (FliFrame) valTermRef(fid);
+    Word fp = (Word)(fr+1);
+    Word *cp = baseBuffer(cells, Word);
+    Word *ep = cp + entriesBuffer(cells, Word);
+
+    assert((size_t)fr->size == (size_t)(ep-cp));
+    for(; cp < ep; cp++)
+      **cp = *fp++;
+
+    PL_close_foreign_frame(fid);
+  }
+}
+
+
+void
+gcAssignedOld(DECL_LD Word p)
+{ word w = *p;
+
+  if ( isGlobalRef(w) && valPtr(w) >= LD->gen_bar )
+    LD->gc.gen.force_major = TRUE;
+}
+
+
 #ifdef O_CALL_RESIDUE
 #define count_need_protection_attvars(_) LDFUNC(count_need_protection_attvars, _)
 static size_t
@@ -1582,12 +1876,12 @@ early_reset_vars(DECL_LD mark *m, Word top, TrailEntry te)
 	te--;
 	te->as_word = 0;
 	trailcells_deleted += 2;
-      } else if ( is_marked(tard) )
+      } else if ( is_marked_or_old(tard) )
       {
       keep:
 	assert(onGlobal(gp));
 	assert(!is_first(gp));
-	if ( !is_marked(gp) )
+	if ( !is_marked_or_old(gp) )
 	{ DEBUG(MSG_GC_ASSIGNMENTS_MARK,
 		char b1[64]; char b2[64]; char b3[64];
 		Sdprintf("Marking assignment at %s (%s --> %s)\n",
@@ -1636,11 +1930,11 @@ early_reset_vars(DECL_LD mark *m, Word top, TrailEntry te)
 	trailcells_deleted++;
       } else if ( tard > gKeep && tard < gMax )
       { if ( LD->attvar.attvars &&	/* see (**) */
-	     is_marked(tard) && isRef(*tard) &&
+	     is_marked_or_old(tard) && isRef(*tard) &&
 	     te-1 >= tm )
 	{ Word tard2 = valPtr(te[-1].as_word);
 
-	  if ( is_marked(tard2) && isAttVar(*tard2) )
+	  if ( is_marked_or_old(tard2) && isAttVar(*tard2) )
 	  { te--;
 	    DEBUG(MSG_GC_RESET,
 		  Sdprintf("Keep trail for attvar _%lld\n",
@@ -1650,7 +1944,7 @@ early_reset_vars(DECL_LD mark *m, Word top, TrailEntry te)
 	}
 	te->as_word = 0;
 	trailcells_deleted++;
-      } else if ( !is_marked(tard) )
+      } else if ( !is_marked_or_old(tard) )
       { DEBUG(MSG_GC_RESET,
 	      char b1[64]; char b2[64];
 	      Sdprintf("Early reset at %s (%s)\n",
@@ -2932,6 +3226,10 @@ sweep_global_mark(DECL_LD gc_wordptr *m)
   DEBUG(CHK_SECURE, assert(onStack(local, m)));
   IS_WORD_ALIGNED(gm);
 
+  if ( is_old(gm) )			/* minor GC: does not move */
+  { m->as_word = consPtr(gm, STG_GLOBAL);
+    return;
+  }
   if ( is_marked_or_first(gm-1) )
     goto done;				/* quit common easy case */
 
@@ -3009,8 +3307,10 @@ sweep_foreign(void)
       {	clear_marked(sp);
 	if ( isGlobalRef(get_value(sp)) )
 	{ processLocal(sp);
-	  check_relocation(sp);
-	  into_relocation_chain(sp, STG_LOCAL);
+	  if ( !is_old(valPtr(get_value(sp))) )
+	  { check_relocation(sp);
+	    into_relocation_chain(sp, STG_LOCAL);
+	  }
 	}
       }
     }
@@ -3087,7 +3387,7 @@ sweep_trail(void)
   TrailEntry te = tTop - 1;
 
   for( ; te >= tBase; te-- )
-  { if ( te->as_word )
+  { if ( te->as_word && !is_old(valPtr(te->as_word)) )
     {
 #ifdef O_DESTRUCTIVE_ASSIGNMENT
       if ( ttag(te->as_word) == TAG_TRAILVAL )
@@ -3118,8 +3418,10 @@ sweep_frame(DECL_LD LocalFrame fr, int slots)
     { clear_marked(sp);
       if ( isGlobalRef(get_value(sp)) )
       { processLocal(sp);
-	check_relocation(sp);
-	into_relocation_chain(sp, STG_LOCAL);
+	if ( !is_old(valPtr(get_value(sp))) )
+	{ check_relocation(sp);
+	  into_relocation_chain(sp, STG_LOCAL);
+	}
       }
     } else
     { word w = *sp;
@@ -3195,8 +3497,10 @@ sweep_new_arguments(DECL_LD vm_state *state)
       clear_marked(sp);
       if ( isGlobalRef(get_value(sp)) )
       { processLocal(sp);
-	check_relocation(sp);
-	into_relocation_chain(sp, STG_LOCAL);
+	if ( !is_old(valPtr(get_value(sp))) )
+	{ check_relocation(sp);
+	  into_relocation_chain(sp, STG_LOCAL);
+	}
       }
     }
   }
@@ -3295,7 +3599,7 @@ is_downward_ref(DECL_LD Word p)
 
       DEBUG(CHK_SECURE, assert(d >= gBase));
 
-      return d < p;
+      return d < p && !is_old(d);
     }
   }
 
@@ -3406,7 +3710,7 @@ downskip_combine_garbage(DECL_LD Word current, Word dest)
     }
   }
 
-  return make_gc_hole(gBase, top_gc);
+  return make_gc_hole(young_base, top_gc);
 }
 
 
@@ -3414,7 +3718,7 @@ static void
 compact_global(void)
 { GET_LD
   Word dest, current;
-  Word base = gBase, top;
+  Word base = young_base, top;
 #if O_DEBUG
   Word *v = mark_top;
 #endif
@@ -3486,7 +3790,7 @@ compact_global(void)
 
   dest = base;
   top = gTop;
-  for(current = gBase; current < top; )
+  for(current = base; current < top; )
   { if ( is_marked(current) )
     { intptr_t l, n;
 
@@ -3525,9 +3829,9 @@ compact_global(void)
     }
   }
 
-  if ( dest != gBase + total_marked )
-    sysError("Mismatch in up phase: dest = %p, gBase+total_marked = %p\n",
-	     dest, gBase + total_marked );
+  if ( dest != base + total_marked )
+    sysError("Mismatch in up phase: dest = %p, base+total_marked = %p\n",
+	     dest, base + total_marked );
 
   DEBUG(CHK_SECURE,
 	{ Word p = dest;		/* clear top of stack */
@@ -3542,8 +3846,11 @@ compact_global(void)
 static void
 collect_phase(vm_state *state, gc_wordptr *saved_bar_at)
 { GET_LD
+  Word sentinel = (young_base > gBase ? young_base-1 : NULL);
 
   DEBUG(CHK_SECURE, check_marked("Start collect"));
+  if ( sentinel )			/* minor GC: stop scans at young_base */
+    set_marked(sentinel);		/* see sweep_global_mark() */
 
   DEBUG(MSG_GC_PROGRESS, Sdprintf("Sweeping foreign references\n"));
   sweep_foreign();
@@ -3557,6 +3864,8 @@ collect_phase(vm_state *state, gc_wordptr *saved_bar_at)
   }
   DEBUG(MSG_GC_PROGRESS, Sdprintf("Compacting global stack\n"));
   compact_global();
+  if ( sentinel )
+    clear_marked(sentinel);
 
   unsweep_foreign();
   unsweep_stacks(state);
@@ -4347,6 +4656,8 @@ gcEnsureSpace(DECL_LD vm_state *state)
     lneeded += sizeof(struct fliFrame) + LD->gvar.grefs*sizeof(word);
   if ( LD->frozen_bar )
     lneeded += sizeof(Word);
+  if ( young_base > gBase )
+    lneeded += sizeof(struct fliFrame) + count_remembered_cells()*sizeof(word);
   if ( state->save_argp )
     lneeded += sizeof(struct fliFrame) + (aTop+1-aBase)*sizeof(word);
   if ( LD->attvar.call_residue_vars_count && LD->attvar.attvars )
@@ -4404,8 +4715,10 @@ garbageCollect(gc_reason_t reason)
   term_t preShiftLTop;			/* safe over trimStacks() (shift) */
   int verbose = truePrologFlag(PLFLAG_TRACE_GC) && !LD->in_print_message;
   int no_mark_bar;
+  int minor;
   int rc;
-  fid_t gvars, astack, attvars;
+  fid_t gvars, astack, attvars, rset;
+  tmp_buffer remembered;
   gc_wordptr *saved_bar_at;		/* LD->frozen_bar placed on top of local stack */
 #ifdef O_PROFILE
   struct call_node *prof_node = NULL;
@@ -4415,20 +4728,23 @@ garbageCollect(gc_reason_t reason)
   if ( gc_status.blocked || !truePrologFlag(PLFLAG_GC) )
     return FALSE;
 
+  minor = use_minor_gc(reason);
   gc_stat_start(&LD->gc.stats, reason);
 
   assert(LD->fast_condition == NULL);
   save_backtrace("GC");
 
   if ( verbose )
-    Sdprintf("%% GC: ");
+    Sdprintf(minor ? "%% GC (minor): " : "%% GC: ");
 
+  young_base = (minor ? LD->gen_bar : gBase);
   get_vmi_state(LD->query, &state);
   safeLTop = lTop;
   if ( (rc=gcEnsureSpace(&state)) < 0 )
   { return rc;
   } else if ( rc == FALSE )		/* shifted; reload */
   { get_vmi_state(LD->query, &state);
+    young_base = (minor ? LD->gen_bar : gBase);
   }
 
   enterGC();
@@ -4485,6 +4801,8 @@ garbageCollect(gc_reason_t reason)
   attvars = link_attvars();
   astack = argument_stack_to_term_refs(&state);
   gvars = gvars_to_term_refs(&saved_bar_at);
+  initBuffer(&remembered);
+  rset = remembered_set_to_term_refs((Buffer)&remembered);
   save_grefs();
   DEBUG(CHK_SECURE, check_foreign());
   tag_trail();
@@ -4497,10 +4815,14 @@ garbageCollect(gc_reason_t reason)
   untag_trail();
   clean_attvar_chain();
 
+  term_refs_to_remembered_set(rset, (Buffer)&remembered);
+  discardBuffer(&remembered);
   term_refs_to_gvars(gvars, saved_bar_at);
   term_refs_to_argument_stack(&state, astack);
   restore_attvars(attvars);
 
+  if ( LD->mark_bar > gTop )		/* bar raised by generational GC */
+    LD->mark_bar = gTop;		/* see use_minor_gc() */
   assert(LD->mark_bar <= gTop);
 
   DEBUG(CHK_SECURE,
@@ -4525,6 +4847,19 @@ garbageCollect(gc_reason_t reason)
   assert(!LD->query ||
 	 !LD->query->registers.fr ||
 	 state.frame == LD->query->registers.fr);
+  if ( truePrologFlag(PLFLAG_GC_GENERATIONAL) )
+  { if ( minor )			/* promote the survivors */
+      LD->gc.stats.totals.minor_collections++;
+    else
+      LD->gc.gen.major_limit = 2*usedStack(global) + LD->stacks.global.small;
+    LD->gen_bar = gTop;
+    if ( LD->mark_bar < gTop )
+      LD->mark_bar = gTop;
+  } else
+  { LD->gen_bar = NULL;
+  }
+  LD->gc.gen.force_major = FALSE;
+  young_base = gBase;
   if ( no_mark_bar )
     LD->mark_bar = NO_MARK_BAR;
   gc_status.active = FALSE;
@@ -5182,6 +5517,9 @@ update_stacks(vm_state *state, void *lb, void *gb, void *tb)
   if ( gs && LD->mark_bar != NO_MARK_BAR )
   { update_pointer(&LD->mark_bar, gs);
   }
+  if ( gs && LD->gen_bar )
+  { update_pointer(&LD->gen_bar, gs);
+  }
 }
 
 
@@ -5400,6 +5738,7 @@ grow_stacks(DECL_LD size_t l, size_t g, size_t t)
     Word gb = gBase;
     LocalFrame lb = lBase;
     double time, time0 = ThreadCPUTime(CPU_USER);
+    double wall0 = WallTime();
     int verbose = truePrologFlag(PLFLAG_TRACE_GC);
 
     DEBUG(MSG_SHIFT, verbose = TRUE);
@@ -5519,6 +5858,9 @@ grow_stacks(DECL_LD size_t l, size_t g, size_t t)
 
     time = ThreadCPUTime(CPU_USER) - time0;
     LD->shift_status.time += time;
+    GC_TELEMETRY(shift_pause, (WallTime() - wall0)*1000000.0);
+    LD->gc.telemetry.shifts++;
+    ATOMIC_INC(&GD->statistics.gc.shifts);
     DEBUG(CHK_SECURE,
 	  { gBase++;
 	    if ( checkStacks(&state) != key )
@@ -5905,6 +6247,7 @@ markPredicatesInEnvironments(PL_local_data_t *ld, void *ctx)
 
 BeginPredDefs(gc)
   PRED_DEF("$gc_statistics", 5, gc_statistics, 0)
+  PRED_DEF("$gc_telemetry", 2, gc_telemetry, 0)
 #if O_DEBUG || defined(O_MAINTENANCE)
   PRED_DEF("$check_stacks", 1, check_stacks, 0)
 #endif
@@ -50,6 +50,7 @@
 #define	unmark_stacks(fr, ch, mask)			LDFUNC(unmark_stacks, fr, ch, mask)
 #define	blockGC(flags)					LDFUNC(blockGC, flags)
 #define	unblockGC(flags)				LDFUNC(unblockGC, flags)
+#define	gcAssignedOld(p)				LDFUNC(gcAssignedOld, p)
 #endif /*USE_LD_MACROS*/
 
 #define LDFUNC_DECLARATIONS
@@ -81,6 +82,8 @@ void		mark_active_environment(struct bit_vector *active,
 void		unmark_stacks(LocalFrame fr, Choice ch, uintptr_t mask);
 void		blockGC(int flags);	/* disallow garbage collect */
 void		unblockGC(int flags);	/* re-allow garbage collect */
+void		gcAssignedOld(Word p);	/* untrailed write into old data */
+void		gcHistogramAdd(gc_histogram *h, uint64_t value);
 
 #undef LDFUNC_DECLARATIONS
 
@@ -91,6 +94,13 @@ void		unblockGC(int flags);	/* re-allow garbage collect */
 #define ensureTrailSpace(n)     likely(ensureStackSpace_ex(0,n,ALLOW_GC))
 #define ensureStackSpace(g,t)   likely(ensureStackSpace_ex(g,t,ALLOW_GC))
 
+/* Add an observation to the thread and process GC telemetry */
+#define GC_TELEMETRY(field, value) \
+	do { uint64_t _v = (uint64_t)(value); \
+	     gcHistogramAdd(&LD->gc.telemetry.field, _v); \
+	     gcHistogramAdd(&GD->statistics.gc.field, _v); \
+	   } while(0)
+
 		 /*******************************
 		 *	INLINE DEFINITIONS	*
 		 *******************************/
@@ -144,11 +144,14 @@ struct PL_global_data
     size_t	atom_string_space;	/* # bytes used to store atoms */
     size_t	atom_string_space_freed;/* # bytes in freed atoms */
     size_t	stack_space;		/* # bytes on stacks */
+    size_t	slab_space;		/* # bytes in slabs (pl-alloc.c) */
     int		functors;		/* No. of functors defined */
     int		predicates;		/* No. of predicates defined */
     int		modules;		/* No. of modules in the system */
     size_t	clauses;		/* No. clauses */
     size_t	codes;			/* No. of VM codes generated */
+    size_t	retired;		/* # lingering objects */
+    uint64_t	reclaimed;		/* # lingering objects freed */
     double	user_cputime;		/* User CPU time (whole process) */
     double	system_cputime;		/* Kernel CPU time (whole process) */
     struct
@@ -158,12 +161,14 @@ struct PL_global_data
 #ifdef O_ENGINES
     uint64_t	engines_created;	/* # engines created */
     uint64_t	engines_finished;	/* # engines threads */
+    uint64_t	engines_reused;		/* # engines reset for a new goal */
     uint64_t	threads_created;	/* # threads created */
     uint64_t	threads_finished;	/* # finished threads */
     double	thread_cputime;		/* Total CPU time of threads */
 #endif
     int		errors;			/* Printed error messages */
     int		warnings;		/* Printed warning messages */
+    gc_telemetry gc;			/* Process-wide GC telemetry */
   } statistics;
 
 #ifdef O_PROFILE
@@ -222,6 +227,9 @@ struct PL_global_data
     int64_t	collected;		/* # collected atoms */
     size_t	unregistered;		/* # candidate GC atoms */
     double	gc_time;		/* Time spent on atom-gc */
+    double	max_pause;		/* Max time AGC holds L_REHASH_ATOMS */
+    double	slice_start;		/* Start of current AGC time slice */
+    int64_t	gc_yields;		/* # times AGC released the lock */
     PL_agc_hook_t gc_hook;		/* Current hook */
 #endif
     atom_t     *for_code[256];		/* code --> one-char-atom */
@@ -338,6 +346,7 @@ struct PL_global_data
 #endif
     Procedure   comment_hook3;		/* prolog:comment_hook/3 */
     Procedure	tune_gc3;		/* prolog:tune_gc */
+    Procedure	heap_quota_exceeded2;	/* prolog:heap_quota_exceeded */
     Procedure	trie_gen_compiled2;
     Procedure	trie_gen_compiled3;
     Procedure	exception3;		/* user:exception/3 */
@@ -384,10 +393,14 @@ struct PL_global_data
     size_t	erased;			/* # erased pending clauses */
     size_t	erased_size;		/* memory used by them */
     size_t	erased_size_last;	/* memory used by them after last CGC */
+    size_t	retired_last;		/* GD->statistics.retired after CGC */
     size_t	db_erased_refs;		/* Clause references on erased clauses */
     int		cgc_space_factor;	/* Max total/margin garbage */
     double	cgc_stack_factor;	/* Price to scan stack space */
     double	cgc_clause_factor;	/* Pce to scan clauses */
+    double	cgc_max_pause;		/* Max time for a CGC slice */
+    unsigned int cgc_cycle;		/* Current incremental CGC cycle */
+    size_t	cgc_pending;		/* Predicates left for next slice */
   } clauses;
 
   struct
@@ -398,6 +411,18 @@ struct PL_global_data
     int		min_clauses;
   } clause_index;
 
+  struct
+  { unsigned int threshold;		/* S_STATIC calls before S_SWITCH */
+    int		sample_rate;		/* Count one in sample_rate calls */
+    unsigned int samples;		/* Samples before S_SWITCH */
+  } hot_predicates;
+
+#ifdef O_VMI_PAIR_PROFILE
+  struct
+  { uint64_t   *pairs;			/* [I_HIGHEST][I_HIGHEST] counts */
+  } vmi_profile;
+#endif
+
   struct
   { size_t	highest;		/* highest source file index */
     size_t	no_hole_before;		/* All filled before here */
@@ -481,6 +506,7 @@ struct PL_local_data
 #ifdef O_GVAR
   Word		frozen_bar;		/* Frozen part of the global stack */
 #endif
+  Word		gen_bar;		/* Old generation of the global stack */
   Code		fast_condition;		/* Fast condition support */
   pl_stacks_t   stacks;			/* Prolog runtime stacks */
   int		alerted;		/* Special mode. See updateAlerted() */
@@ -589,6 +615,16 @@ struct PL_local_data
     int		warnings;		/* Printed warning messages */
   } statistics;
 
+  struct
+  { int		countdown;		/* S_STATIC calls until next sample */
+  } hot_predicates;
+
+#ifdef O_VMI_PAIR_PROFILE
+  struct
+  { unsigned int prev;			/* Previous VMI executed */
+  } vmi_profile;
+#endif
+
 #ifdef O_BIGNUM
   struct
   { ar_context *context;		/* current allocation context */
@@ -757,6 +793,15 @@ struct PL_local_data
   pl_shift_status_t shift_status;	/* Stack shifter status */
   pl_debugstatus_t _debugstatus;	/* status of the debugger */
   struct btrace *btrace_store;		/* C-backtraces */
+  struct slab_cache *slab_cache;	/* Thread slab magazines */
+  int		slab_cache_freed;	/* freeSlabCache() was called */
+
+  struct
+  { size_t	used;			/* Bags and thread-local clauses */
+    size_t	limit;			/* Hard limit (flag heap_limit) */
+    size_t	soft_limit;		/* Call hook (flag heap_soft_limit) */
+    int		soft_raised;		/* Hook was requested */
+  } heap_quota;
 #if O_DEBUG
   pl_internaldebugstatus_t internal_debug; /* status of C-level debug flags */
 #endif
@@ -776,6 +821,7 @@ struct PL_local_data
     simpleMutex scan_lock;		/* Hold for asynchronous scans */
     thread_wait_for *waiting_for;	/* thread_wait/2 info */
     alert_channel alert;		/* How to alert the thread */
+    record_t in_transit;		/* Message being received */
     struct _PL_thread_info_t *creator;	/* Thread that created me */
     uint64_t creator_seq_id;		/* Seq id of creater */
     double child_cputime;		/* Time of completed children */
@@ -854,6 +900,12 @@ struct PL_local_data
 #endif
     int active;				/* GC is running in this thread */
     gc_stats stats;			/* GC performance history */
+    gc_telemetry telemetry;		/* GC histograms for this thread */
+    Word _young_base;			/* Bottom of the collected region */
+    struct
+    { size_t major_limit;		/* Old size that forces a major GC */
+      int    force_major;		/* Old cells were assigned untrailed */
+    } gen;
 
 					/* These must be at the end to be */
 					/* able to define O_DEBUG in only */
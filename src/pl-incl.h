@@ -1038,6 +1038,7 @@ with one operation, it turns out to be faster as well.
 #define P_REDEFINED		(0x80000000LL) /* Overrules a definition */
 #define P_SIG_ATOMIC	      (0x0100000000LL) /* Do not call handleSignals */
 #define P_TRANSACT	      (0x0200000000LL) /* Subject to transactions */
+#define P_LOCALISED	      (0x0400000000LL) /* Thread copy of P_THREAD_LOCAL */
 #define PROC_DEFINED		(P_DYNAMIC|P_FOREIGN|P_MULTIFILE|\
 				 P_DISCONTIGUOUS|P_LOCKED_SUPERVISOR)
 /* flags for p_reload data (reconsult) */
@@ -1519,15 +1520,43 @@ typedef struct gc_stats
   int		last_index;
   int		aggr_index;
   double	thread_cpu;		/* Last thread CPU time */
+  double	wall_start;		/* Wall time at start of this GC */
+  double	wall_end;		/* Wall time at end of last GC */
   gc_reason_t	request;		/* Requesting stack */
   struct
   { int64_t	collections;
+    int64_t	minor_collections;	/* collections of the young generation */
     int64_t	global_gained;		/* global stack bytes collected */
     int64_t	trail_gained;		/* trail stack bytes collected */
     double	time;			/* time spent in collections */
   } totals;
 } gc_stats;
 
+/* GC telemetry.  Histograms use power-of-two buckets: bucket[i] counts
+   values v with 2^(i-1) <= v < 2^i and bucket[0] counts v == 0.  Times
+   are in microseconds, sizes in bytes and rates in bytes/second.
+*/
+
+#define GC_HIST_BUCKETS 48
+
+typedef struct gc_histogram
+{ uint64_t	count;			/* # observations */
+  uint64_t	sum;			/* Sum of the observations */
+  uint64_t	max;			/* Largest observation */
+  uint64_t	buckets[GC_HIST_BUCKETS];
+} gc_histogram;
+
+typedef struct gc_telemetry
+{ gc_histogram	gc_pause;		/* Stack GC wall time */
+  gc_histogram	gc_reclaimed;		/* Bytes reclaimed per stack GC */
+  gc_histogram	alloc_rate;		/* Global stack allocation rate */
+  gc_histogram	shift_pause;		/* Stack shift wall time */
+  gc_histogram	agc_pause;		/* Atom GC wall time */
+  gc_histogram	cgc_pause;		/* Clause GC wall time */
+  uint64_t	allocated;		/* Bytes allocated on global stacks */
+  uint64_t	shifts;			/* # stack shifts */
+} gc_telemetry;
+
 
 #define VM_DYNARGC    255	/* compute argcount dynamically */
 
@@ -1617,7 +1646,7 @@ struct clause_bucket
   unsigned int	dirty;			/* # of garbage clauses */
 };
 
-#define MAX_MULTI_INDEX  4
+#define MAX_MULTI_INDEX  8
 #define MAXINDEXARG    254
 #define MAXINDEXDEPTH    7
 #define END_INDEX_POS  255
@@ -1633,10 +1662,18 @@ struct clause_index
   unsigned	 is_list : 1;		/* Index with lists */
   unsigned	 incomplete : 1;	/* Index is incomplete */
   unsigned	 invalid : 1;		/* Index is invalid */
+  unsigned char	 grow;			/* Index is too small (see resizeIndex()) */
+  unsigned char	 resizing;		/* A replacement is being built */
   iarg_t	 args[MAX_MULTI_INDEX];	/* Indexed arguments */
   iarg_t	 position[MAXINDEXDEPTH+1]; /* Deep index position */
   float		 speedup;		/* Estimated speedup */
+  unsigned int	 rebuilds;		/* # times rebuilt by resizeIndex() */
   ClauseBucket	 entries;		/* chains holding the clauses */
+  uint64_t	 lookups;		/* # first clause lookups */
+  uint64_t	 misses;		/* # lookups without a candidate */
+  uint64_t	 scanned;		/* # bucket entries inspected */
+  uint64_t	 lookahead;		/* # scans stopped by MAX_LOOKAHEAD */
+  double	 build_time;		/* Wall time used to fill the index */
 };
 
 #define MAX_BLOCKS 20			/* allows for 2M threads */
@@ -1659,10 +1696,15 @@ struct definition
   } impl;
   uint64_t	flags;			/* booleans (P_*) */
   unsigned int  shared;			/* #procedures sharing this def */
+  unsigned int  indexes_created;	/* #clause indexes created */
+  unsigned int  hot_calls;		/* Sampled S_STATIC calls (see S_SWITCH) */
   struct linger_list  *lingering;	/* Assocated lingering objects */
   gen_t		last_modified;		/* Generation I was last modified */
+  size_t	clause_space;		/* Bytes used by live clauses */
   struct event_list  *events;		/* Forward update events */
   struct table_props *tabling;		/* Extended properties for tabling */
+  struct range_index *range_index;	/* Ordered index for range_call/4 */
+  struct bloom_filter *bloom_filter;	/* Prefilter for unindexed calls */
 #if defined(__SANITIZE_ADDRESS__)
   char	       *name;			/* Name for debugging */
 #endif
@@ -1682,6 +1724,7 @@ struct definition_chain
 struct dirty_def_info
 { unsigned short count;			/* # captured generations */
   unsigned short flags;			/* DDI_* */
+  unsigned int	cgc_cycle;		/* CGC cycle that cleaned us */
   Definition	predicate;		/* The dirty predicate */
   gen_t		access[PROC_DIRTY_GENS];/* Accessed generations */
 };
@@ -2084,6 +2127,8 @@ typedef struct module_enum
 			     tTop = tt; \
 			     gTop = (LD->frozen_bar > (b).globaltop ? \
 				     LD->frozen_bar : (b).globaltop); \
+			     if ( LD->gen_bar > gTop ) \
+			       LD->gen_bar = gTop; \
 			    } while(0)
 #endif /*O_DESTRUCTIVE_ASSIGNMENT*/
 
@@ -2101,6 +2146,8 @@ typedef struct module_enum
 			   } while(0)
 #define DiscardMark(b)	do { LD->mark_bar = (LD->frozen_bar > (b).saved_bar.as_ptr ? \
 					     LD->frozen_bar : (b).saved_bar.as_ptr); \
+			     if ( LD->mark_bar < LD->gen_bar ) \
+			       LD->mark_bar = LD->gen_bar; \
 			     DEBUG(CHK_SECURE, \
 				   assert(LD->mark_bar == NO_MARK_BAR || \
 					  (LD->mark_bar >= gBase && \
@@ -2223,10 +2270,11 @@ typedef enum virtual_signum
   VSIG_CLAUSE_GC,
   VSIG_PLABORT,
   VSIG_TUNE_GC,
+  VSIG_HEAP_QUOTA,
   VSIG_MAX
 } virtual_signum;
 
-#define NUM_VSIGS 6 /* Preprocessor can see this constant */
+#define NUM_VSIGS 7 /* Preprocessor can see this constant */
 static_assertion(NUM_VSIGS == VSIG_MAX); /* Make sure it matches the enum */
 static_assertion(NUM_SIGNALS >= VSIG_MAX && NUM_SIGNALS < 128); /* Sanity check, 128 is arbitrary */
 static_assertion(SIG_PROLOG_OFFSET >= MINSIGNAL && SIG_PROLOG_OFFSET + NUM_VSIGS <= MAXSIGNAL);
@@ -2242,6 +2290,7 @@ static_assertion(SIG_PROLOG_OFFSET >= MINSIGNAL && SIG_PROLOG_OFFSET + NUM_VSIGS
 #define SIG_CLAUSE_GC	  (SIG_PROLOG_OFFSET+VSIG_CLAUSE_GC)
 #define SIG_PLABORT	  (SIG_PROLOG_OFFSET+VSIG_PLABORT)
 #define SIG_TUNE_GC	  (SIG_PROLOG_OFFSET+VSIG_TUNE_GC)
+#define SIG_HEAP_QUOTA	  (SIG_PROLOG_OFFSET+VSIG_HEAP_QUOTA)
 
 /* The "search for a free signal" functionality of PL_sigaction starts after
  * the predefined VSIG numbers */
@@ -2644,6 +2693,7 @@ typedef struct
 #define PROCEDURE_dc_call_prolog	(GD->procedures.dc_call_prolog0)
 #define PROCEDURE_dinit_goal		(GD->procedures.dinit_goal3)
 #define PROCEDURE_tune_gc3		(GD->procedures.tune_gc3)
+#define PROCEDURE_heap_quota_exceeded2	(GD->procedures.heap_quota_exceeded2)
 
 extern const code_info codeTable[]; /* Instruction info (read-only) */
 
@@ -2776,7 +2826,14 @@ typedef enum plflag
   PLFLAG_DEBUG_ON_INTERRUPT,		/* Debug on Control-C */
   PLFLAG_OPTIMISE_UNIFY,		/* Move unifications in clauses */
   PLFLAG_SHIFT_CHECK,			/* Check suspicious shifts */
-  PLFLAG_AGC_CLOSE_STREAMS		/* AGC may close open streams */
+  PLFLAG_AGC_CLOSE_STREAMS,		/* AGC may close open streams */
+  PLFLAG_QLF_INDEXES,			/* Save clause indexes in QLF */
+  PLFLAG_INDEX_BLOOM_FILTER,		/* Bloom filters for unindexed calls */
+  PLFLAG_INDEX_STATISTICS,		/* Collect clause index statistics */
+  PLFLAG_GC_GENERATIONAL,		/* Minor collections of new data */
+  PLFLAG_STACK_HUGE_PAGES,		/* Use huge pages for stacks */
+  PLFLAG_STACK_NUMA,			/* Bind stacks to the thread's node */
+  PLFLAG_STACK_RESERVE			/* Reserve address space for stacks */
 } plflag;
 
 typedef struct
@@ -40,6 +40,8 @@
 #include "pl-proc.h"
 #include "pl-fli.h"
 #include "pl-wam.h"
+#include "pl-prims.h"
+#include "pl-dbref.h"
 #include <math.h>
 
 		 /*******************************
@@ -77,13 +79,6 @@
 #define DEAD_INDEX   ((ClauseIndex)1)
 #define ISDEADCI(ci) ((ci) == DEAD_INDEX)
 
-typedef struct hash_hints
-{ iarg_t	args[MAX_MULTI_INDEX];	/* Hash these arguments */
-  float		speedup;		/* Expected speedup */
-  unsigned int	ln_buckets;		/* Lg2 of #buckets to use */
-  unsigned	list : 1;		/* Use a list per key */
-} hash_hints;
-
 typedef struct index_context
 { gen_t		generation;		/* Current generation */
   Definition	predicate;		/* Current predicate */
@@ -96,6 +91,7 @@ typedef struct index_context
 #define	bestHash(av, ac, clist, min_speedup, hints, ctx)	LDFUNC(bestHash, av, ac, clist, min_speedup, hints, ctx)
 #define	setClauseChoice(chp, cref, generation)			LDFUNC(setClauseChoice, chp, cref, generation)
 #define	first_clause_guarded(argv, argc, clist, ctx)		LDFUNC(first_clause_guarded, argv, argc, clist, ctx)
+#define	bloomRejects(argv, argc, clist, ctx)			LDFUNC(bloomRejects, argv, argc, clist, ctx)
 #endif /*USE_LD_MACROS*/
 
 #define LDFUNC_DECLARATIONS
@@ -104,6 +100,10 @@ static int	bestHash(Word av, size_t ac, ClauseList clist, float min_speedup,
 			 hash_hints *hints, IndexContext ctx);
 static ClauseIndex hashDefinition(ClauseList clist, hash_hints *h,
 				  IndexContext ctx);
+static ClauseIndex resizeIndex(ClauseList clist, ClauseIndex old,
+			       IndexContext ctx);
+static ClauseIndex fillIndex(ClauseList clist, ClauseIndex ci,
+			     IndexContext ctx);
 static void	replaceIndex(Definition def, ClauseList cl,
 			     ClauseIndex *cip, ClauseIndex ci);
 static void	deleteIndexP(Definition def, ClauseList cl, ClauseIndex *cip);
@@ -119,10 +119,20 @@ static void	insertIntoSparseList(ClauseRef cref,
 				     ClauseRef where);
 static ClauseRef first_clause_guarded(Word argv, size_t argc, ClauseList clist,
 				      IndexContext ctx);
+static int	bloomRejects(Word argv, size_t argc, ClauseList clist,
+			     IndexContext ctx);
 static Code	skipToTerm(Clause clause, const iarg_t *position);
 static void	unalloc_index_array(void *p);
 static void	wait_for_index(const ClauseIndex ci);
 static void	completed_index(ClauseIndex ci);
+static void	addClauseToRangeIndex(Definition def, Clause cl);
+static void	deleteClauseFromRangeIndex(Definition def);
+static void	dropRangeIndex(Definition def);
+static size_t	sizeofRangeIndex(Definition def);
+static void	addClauseToBloomFilter(Definition def, Clause cl);
+static void	deleteClauseFromBloomFilter(Definition def);
+static void	dropBloomFilter(Definition def);
+static size_t	sizeofBloomFilter(Definition def);
 
 #undef LDFUNC_DECLARATIONS
 
@@ -167,6 +177,33 @@ canIndex(DECL_LD word w)
 }
 
 
+/* deepIndexable() is TRUE if a deep index on the argument at a can select
+   on an inner argument, i.e., it is not a compound or has at least one
+   instantiated argument.  A deep index for p(_,_) merely collects all p/2
+   clauses.
+*/
+
+#define deepIndexable(a) LDFUNC(deepIndexable, a)
+static int
+deepIndexable(DECL_LD Word a)
+{ Word p;
+  size_t i, arity;
+
+  deRef2(a, p);
+  if ( !isTerm(*p) )
+    return TRUE;
+  arity = arityTerm(*p);
+  if ( arity > MAXINDEXARG )
+    arity = MAXINDEXARG;
+  for(i=0; i<arity; i++)
+  { if ( canIndex(argTerm(*p, i)) )
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
 #define indexOfWord(w) LDFUNC(indexOfWord, w)
 static inline word
 indexOfWord(DECL_LD word w)
@@ -214,6 +251,12 @@ getIndexOfTerm(term_t t)
 }
 
 
+word
+getIndexOfWord(DECL_LD word w)
+{ return indexOfWord(w);
+}
+
+
 #define nextClauseArg1(chp, generation) \
 	LDFUNC(nextClauseArg1, chp, generation)
 
@@ -265,13 +308,40 @@ argument inside nextClause, but  unfortunately  we   do  not  know which
 argument we are processing.
 
 TBD: Keep a flag telling whether there are non-indexable clauses.
+
+If the Prolog flag `index_statistics` is  set, the lookup updates the
+usage statistics of the index   (see  '$index_statistics'/3). These are
+updated without synchronization and  are  thus   approximate  if  multiple
+threads use the index.  The flag is off by default, such that the lookup
+does not write to the shared index.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#define IDX_FOUND	0
+#define IDX_MISSED	1
+#define IDX_LOOKAHEAD	2
+
+#define INDEX_STAT(ci, scanned, how) \
+	do \
+	{ if ( unlikely(truePrologFlag(PLFLAG_INDEX_STATISTICS)) ) \
+	    index_stat(ci, scanned, how); \
+	} while(0)
+
+static void
+index_stat(ClauseIndex ci, uint64_t scanned, int how)
+{ ci->lookups++;
+  ci->scanned += scanned;
+  if ( how == IDX_MISSED )
+    ci->misses++;
+  else if ( how == IDX_LOOKAHEAD )
+    ci->lookahead++;
+}
+
 #define nextClauseFromBucket(ci, argv, ctx) LDFUNC(nextClauseFromBucket, ci, argv, ctx)
 static ClauseRef
 nextClauseFromBucket(DECL_LD ClauseIndex ci, Word argv, IndexContext ctx)
 { ClauseRef cref;
   word key = ctx->chp->key;
+  uint64_t scanned = 0;
 
   if ( ci->is_list )
   { DEBUG(MSG_INDEX_FIND, Sdprintf("Searching for %s\n", keyName(key)));
@@ -280,7 +350,8 @@ nextClauseFromBucket(DECL_LD ClauseIndex ci, Word argv, IndexContext ctx)
 
   non_indexed:
     for(cref = ctx->chp->cref; cref; cref = cref->next)
-    { if ( cref->d.key == key )
+    { scanned++;
+      if ( cref->d.key == key )
       { ClauseList cl = &cref->value.clauses;
 	ClauseRef cr;
 
@@ -304,17 +375,21 @@ nextClauseFromBucket(DECL_LD ClauseIndex ci, Word argv, IndexContext ctx)
 	  DEBUG(MSG_INDEX_DEEP,
 		Sdprintf("Recursive index for %s at level %d\n",
 			 keyName(cref->d.key), ctx->depth));
+	  INDEX_STAT(ci, scanned, IDX_FOUND);
 	  return first_clause_guarded(argv, argc, cl, ctx);
 	}
 
 	ctx->chp->key = 0;		/* See (*) */
 	for(cr=cl->first_clause; cr; cr=cr->next)
-	{ if ( visibleClauseCNT(cr->value.clause, ctx->generation) )
+	{ scanned++;
+	  if ( visibleClauseCNT(cr->value.clause, ctx->generation) )
 	  { setClauseChoice(ctx->chp, cr->next, ctx->generation);
+	    INDEX_STAT(ci, scanned, IDX_FOUND);
 	    return cr;
 	  }
 	}
 
+	INDEX_STAT(ci, scanned, IDX_MISSED);
 	return NULL;
       }
     }
@@ -327,30 +402,36 @@ nextClauseFromBucket(DECL_LD ClauseIndex ci, Word argv, IndexContext ctx)
     { DEBUG(MSG_INDEX_FIND, Sdprintf("Not found\n"));
     }
 
+    INDEX_STAT(ci, scanned, IDX_MISSED);
     return NULL;
   }
 
   for(cref = ctx->chp->cref; cref; cref = cref->next)
-  { if ( (!cref->d.key || key == cref->d.key) &&
+  { scanned++;
+    if ( (!cref->d.key || key == cref->d.key) &&
 	 visibleClauseCNT(cref->value.clause, ctx->generation))
     { ClauseRef result = cref;
       int maxsearch = MAX_LOOKAHEAD;
 
       for( cref = cref->next; cref; cref = cref->next )
-      { if ( ((!cref->d.key || key == cref->d.key) &&
+      { scanned++;
+	if ( ((!cref->d.key || key == cref->d.key) &&
 	      visibleClauseCNT(cref->value.clause, ctx->generation)) ||
 	     --maxsearch == 0 )
-	{ setClauseChoice(ctx->chp, cref, ctx->generation);
+	{ INDEX_STAT(ci, scanned, maxsearch == 0 ? IDX_LOOKAHEAD : IDX_FOUND);
+	  setClauseChoice(ctx->chp, cref, ctx->generation);
 
 	  return result;
 	}
       }
       ctx->chp->cref = NULL;
+      INDEX_STAT(ci, scanned, IDX_FOUND);
 
       return result;
     }
   }
 
+  INDEX_STAT(ci, scanned, IDX_MISSED);
   return NULL;
 }
 
@@ -370,17 +451,17 @@ setClauseChoice(DECL_LD ClauseChoice chp, ClauseRef cref, gen_t generation)
 }
 
 
-#define indexKeyFromArgv(ci, argv) LDFUNC(indexKeyFromArgv, ci, argv)
+#define argsKeyFromArgv(args, argv) LDFUNC(argsKeyFromArgv, args, argv)
 static inline word
-indexKeyFromArgv(DECL_LD ClauseIndex ci, Word argv)
-{ if ( likely(ci->args[1] == 0) )
-  { return indexOfWord(argv[ci->args[0]-1]);
+argsKeyFromArgv(DECL_LD const iarg_t *args, Word argv)
+{ if ( likely(args[1] == 0) )
+  { return indexOfWord(argv[args[0]-1]);
   } else
   { word key[MAX_MULTI_INDEX];
     int  harg;
 
-    for(harg=0; ci->args[harg]; harg++)
-    { if ( !(key[harg] = indexOfWord(argv[ci->args[harg]-1])) )
+    for(harg=0; harg < MAX_MULTI_INDEX && args[harg]; harg++)
+    { if ( !(key[harg] = indexOfWord(argv[args[harg]-1])) )
 	return 0;
     }
 
@@ -388,6 +469,8 @@ indexKeyFromArgv(DECL_LD ClauseIndex ci, Word argv)
   }
 }
 
+#define indexKeyFromArgv(ci, argv) argsKeyFromArgv((ci)->args, argv)
+
 
 #if defined(O_DEBUG) || defined(O_MAINTENANCE)
 static char *
@@ -401,7 +484,7 @@ iargsName(const iarg_t args[MAX_MULTI_INDEX], char *buf)
 
   s = buf;
   *s++ = '[';
-  for(i=0; args[i]; i++)
+  for(i=0; i < MAX_MULTI_INDEX && args[i]; i++)
   { if ( i > 0 )
       *s++ = ',';
     Ssprintf(s, "%d", args[i]);
@@ -443,24 +526,46 @@ first_clause_guarded(DECL_LD Word argv, size_t argc, ClauseList clist,
 retry:
   if ( (cip=clist->clause_indexes) )
   { ClauseIndex best_index = NULL;
+    ClauseIndex shallow = NULL;		/* deep index that cannot select */
+    word shallow_key = 0;
 
     for(; *cip; cip++)
     { ClauseIndex ci = *cip;
       word k;
 
-      if ( ISDEADCI(ci) )
+      if ( ISDEADCI(ci) || ci->incomplete ) /* do not wait for a new index */
 	continue;
 
       if ( (k=indexKeyFromArgv(ci, argv)) )
-      { best_index = ci;
+      { if ( ci->is_list && !deepIndexable(argv+ci->args[0]-1) )
+	{ if ( !shallow )
+	  { shallow = ci;
+	    shallow_key = k;
+	  }
+	  continue;
+	}
+	best_index = ci;
 	chp->key = k;
 	break;
       }
     }
 
+    if ( !best_index && shallow )
+    { best_index = shallow;
+      chp->key = shallow_key;
+    }
+
     if ( best_index )
     { int hi;
 
+      if ( best_index->grow && !best_index->resizing &&
+	   !STATIC_RELOADING() )
+      { ClauseIndex ci;
+
+	if ( (ci=resizeIndex(clist, best_index, ctx)) )
+	  best_index = ci;
+      }
+
       if ( clist->number_of_clauses > MIN_CLAUSES_FOR_INDEX &&
 	   (float)clist->number_of_clauses/best_index->speedup > MIN_SPEEDUP_RATIO &&
 	   !STATIC_RELOADING() )
@@ -469,8 +574,11 @@ retry:
 		       iargsName(best_index->args, NULL),
 		       predicateName(ctx->predicate)));
 
-	if ( bestHash(argv, argc, clist, best_index->speedup,
-		      &hints, ctx) )
+	if ( bestHash(argv, argc, clist,
+		      best_index == shallow ? 0.0 : best_index->speedup,
+		      &hints, ctx) &&
+	     !(best_index == shallow &&
+	       memcmp(hints.args, best_index->args, sizeof(hints.args)) == 0) )
 	{ ClauseIndex ci;
 
 	  DEBUG(MSG_JIT, Sdprintf("[%d] Found better at args %s\n",
@@ -478,20 +586,17 @@ retry:
 				  iargsName(hints.args, NULL)));
 
 	  if ( (ci=hashDefinition(clist, &hints, ctx)) )
-	  { chp->key = indexKeyFromArgv(ci, argv);
-	    assert(chp->key);
-	    best_index = ci;
+	  { if ( !ci->incomplete )	/* else being built by another thread */
+	    { chp->key = indexKeyFromArgv(ci, argv);
+	      assert(chp->key);
+	      best_index = ci;
+	    }
 	  } else
 	  { goto retry;
 	  }
 	}
       }
 
-      if ( best_index->incomplete )
-      { wait_for_index(best_index);
-	goto retry;
-      }
-
       hi = hashIndex(chp->key, best_index->buckets);
       chp->cref = best_index->entries[hi].head;
       return nextClauseFromBucket(best_index, argv, ctx);
@@ -528,8 +633,8 @@ retry:
     if ( (ci=hashDefinition(clist, &hints, ctx)) )
     { int hi;
 
-      while ( ci->incomplete )
-	wait_for_index(ci);
+      if ( ci->incomplete )		/* being built by another thread */
+	goto scan;
       if ( ci->invalid )
 	goto retry;
 
@@ -543,6 +648,11 @@ retry:
     }
   }
 
+  if ( clist == &ctx->predicate->impl.clauses && !STATIC_RELOADING() &&
+       bloomRejects(argv, argc, clist, ctx) )
+    return NULL;
+
+scan:
   if ( chp->key )
   { chp->cref = clist->first_clause;
     return nextClauseArg1(chp, ctx->generation);
@@ -679,6 +789,7 @@ newClauseIndexTable(iarg_t *hap, hash_hints *hints, IndexContext ctx)
 
   memset(ci->entries, 0, bytes);
   ATOMIC_INC(&GD->statistics.indexes.created);
+  ATOMIC_INC(&ctx->predicate->indexes_created);
 
   return ci;
 }
@@ -701,7 +812,7 @@ freeClauseListRef(ClauseRef cref)
 
     freeHeap(cl->args, arityFunctor(cref->d.key)*sizeof(*cl->args));
   }
-  freeHeap(cref, SIZEOF_CREF_LIST);
+  freeSlab(cref, SIZEOF_CREF_LIST);
 }
 
 
@@ -713,7 +824,7 @@ vfree_clause_list_ref(void *cref)
 
 static void
 lingerClauseListRef(Definition def, ClauseRef cref)
-{ linger_always(&def->lingering, vfree_clause_list_ref, cref);
+{ retireDefinitionData(def, vfree_clause_list_ref, cref);
 }
 
 
@@ -748,7 +859,7 @@ unallocClauseIndexTable(ClauseIndex ci)
 
 static ClauseRef
 newClauseListRef(word key)
-{ ClauseRef cref = allocHeapOrHalt(SIZEOF_CREF_LIST);
+{ ClauseRef cref = allocSlab(SIZEOF_CREF_LIST);
 
   memset(cref, 0, SIZEOF_CREF_LIST);
   cref->d.key = key;
@@ -800,9 +911,10 @@ addClauseToListIndexes(Definition def, ClauseList cl, Clause clause,
       if ( ci->invalid )
 	return;
 
-      if ( ci->size >= ci->resize_above ||
-	   !addClauseToIndex(ci, clause, where) )
+      if ( !addClauseToIndex(ci, clause, where) )
 	deleteIndexP(def, cl, cip);
+      else if ( ci->size >= ci->resize_above )
+	ci->grow = TRUE;		/* next lookup calls resizeIndex() */
     }
   }
 }
@@ -1336,11 +1448,12 @@ deleteActiveClauseFromBucket(ClauseBucket cb, word key)
 
 
 static inline word
-indexKeyFromClause(ClauseIndex ci, Clause cl, Code *end)
-{ Code PC = skipToTerm(cl, ci->position);
+argsKeyFromClause(const iarg_t *args, const iarg_t *position,
+		  Clause cl, Code *end)
+{ Code PC = skipToTerm(cl, position);
 
-  if ( likely(ci->args[1] == 0) )
-  { int arg = ci->args[0] - 1;
+  if ( likely(args[1] == 0) )
+  { int arg = args[0] - 1;
     word key;
 
     if ( arg > 0 )
@@ -1357,10 +1470,10 @@ indexKeyFromClause(ClauseIndex ci, Clause cl, Code *end)
 
     DEBUG(CHK_SECURE, if ( end ) *end = NULL);
 
-    for(harg=0; ci->args[harg]; harg++)
-    { if ( ci->args[harg] > pcarg )
-	PC = skipArgs(PC, ci->args[harg]-pcarg);
-      pcarg = ci->args[harg];
+    for(harg=0; harg < MAX_MULTI_INDEX && args[harg]; harg++)
+    { if ( args[harg] > pcarg )
+	PC = skipArgs(PC, args[harg]-pcarg);
+      pcarg = args[harg];
       if ( !argKey(PC, 0, &key[harg]) )
 	return 0;
     }
@@ -1369,6 +1482,9 @@ indexKeyFromClause(ClauseIndex ci, Clause cl, Code *end)
   }
 }
 
+#define indexKeyFromClause(ci, cl, end) \
+	argsKeyFromClause((ci)->args, (ci)->position, cl, end)
+
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Deal with deletion of an active  clause   from  the indexes. This clause
@@ -1430,6 +1546,8 @@ deleteActiveClauseFromIndexes(Definition def, Clause cl)
 { ClauseIndex *cip;
 
   shrunkpow2(def);
+  deleteClauseFromRangeIndex(def);
+  deleteClauseFromBloomFilter(def);
 
   if ( (cip=def->impl.clauses.clause_indexes) )
   { for(; *cip; cip++)
@@ -1496,6 +1614,8 @@ deleteIndexesDefinition(Definition def)
 { ClauseList clist = &def->impl.clauses;
   ClauseIndex *cip0;
 
+  dropRangeIndex(def);
+  dropBloomFilter(def);
   if ( (cip0=clist->clause_indexes) )
   { ClauseIndex *cip;
 
@@ -1569,6 +1689,8 @@ the definition locked.
 int
 addClauseToIndexes(Definition def, Clause clause, ClauseRef where)
 { addClauseToListIndexes(def, &def->impl.clauses, clause, where);
+  addClauseToRangeIndex(def, clause);
+  addClauseToBloomFilter(def, clause);
   reconsider_index(def);
 
   DEBUG(CHK_SECURE, checkDefinition(def));
@@ -1653,8 +1775,7 @@ the new index to the indexes of the predicate.
 
 static ClauseIndex
 hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
-{ ClauseRef cref;
-  ClauseIndex ci;
+{ ClauseIndex ci;
   ClauseIndex *cip;
 
   DEBUG(MSG_JIT, Sdprintf("[%d] hashDefinition(%s, %s, %d) (%s)\n",
@@ -1679,7 +1800,12 @@ hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
 	continue;
 
       if ( memcmp(cio->args, hints->args, sizeof(cio->args)) == 0 )
-      { UNLOCKDEF(ctx->predicate);
+      { if ( !cio->incomplete )		/* update from a new assessment */
+	{ cio->speedup = hints->speedup;
+	  if ( cio->buckets < (2U<<hints->ln_buckets) )
+	    cio->grow = TRUE;
+	}
+	UNLOCKDEF(ctx->predicate);
 	DEBUG(MSG_JIT, Sdprintf("[%d] already created\n", PL_thread_self()));
 	return cio;
       }
@@ -1699,6 +1825,21 @@ See the test_cgc_1 test case in src/Tests/GC/test_cgc_1.pl
   usleep(1000);
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+  return fillIndex(clist, ci, ctx);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Fill a new index that is  already   added  to clist as incomplete. While
+we are filling the index, other   threads  ignore it for lookups. Threads
+that modify the predicate wait for it to complete in wait_for_index().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static ClauseIndex
+fillIndex(ClauseList clist, ClauseIndex ci, IndexContext ctx)
+{ ClauseRef cref;
+  double t0 = WallTime();
+
   for(cref = clist->first_clause; cref; cref = cref->next)
   { if ( false(cref->value.clause, CL_ERASED) )
     { if ( !addClauseToIndex(ci, cref->value.clause, CL_END) )
@@ -1712,6 +1853,7 @@ See the test_cgc_1 test case in src/Tests/GC/test_cgc_1.pl
 
   ci->resize_above = ci->size*2;
   ci->resize_below = ci->size/4;
+  ci->build_time   = WallTime()-t0;
 
   completed_index(ci);
 
@@ -1719,6 +1861,101 @@ See the test_cgc_1 test case in src/Tests/GC/test_cgc_1.pl
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+resizeIndex() replaces an index that has grown beyond resize_above by a
+fresh one, scaling the number of buckets with the growth of the number
+of live clauses since the old index was created. Instead of deleting
+the index on the assert that makes it too large, which forces all
+threads into a linear scan until some thread has re-assessed the
+predicate and created a new index, the old index remains in use by
+other threads while the new one is being filled.  The old index is
+removed after the new one is complete.
+
+Returns the new index or NULL if  another   thread  is  already doing the
+job, the old index is no longer current or the new index is invalid.  In
+the latter case the old index is not  resized again until its size has
+doubled once more, such that lookups do not retry the resize each time.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static ClauseIndex *
+currentIndexP(ClauseList clist, ClauseIndex ci)
+{ ClauseIndex *cip;
+
+  if ( (cip=clist->clause_indexes) )
+  { for(; *cip; cip++)
+    { if ( *cip == ci )
+	return cip;
+    }
+  }
+
+  return NULL;
+}
+
+
+static ClauseIndex
+resizeIndex(ClauseList clist, ClauseIndex old, IndexContext ctx)
+{ Definition def = ctx->predicate;
+  hash_hints hints;
+  ClauseIndex ci;
+  ClauseIndex *cip;
+  size_t created, live, buckets;
+
+  LOCKDEF(def);
+  if ( old->resizing || !currentIndexP(clist, old) )
+  { UNLOCKDEF(def);
+    return NULL;
+  }
+  old->resizing = TRUE;
+					/* scale with growth since creation */
+  created = old->resize_above/2;	/* ->size includes erased clauses */
+  live    = clist->number_of_clauses;
+  buckets = old->buckets;
+  while ( live > 0 &&
+	  buckets*created < (size_t)old->buckets*live &&
+	  buckets < ((size_t)2<<MSB(live)) )
+    buckets *= 2;
+
+  memset(&hints, 0, sizeof(hints));
+  memcpy(hints.args, old->args, sizeof(hints.args));
+  hints.ln_buckets = MSB(buckets)-1;
+  hints.speedup    = old->speedup;
+  hints.list       = old->is_list;
+
+  DEBUG(MSG_JIT, Sdprintf("[%d] resizeIndex(%s, %s): %d --> %d buckets\n",
+			  PL_thread_self(),
+			  predicateName(def),
+			  iargsName(old->args, NULL),
+			  old->buckets, 2<<hints.ln_buckets));
+
+  ci = newClauseIndexTable(old->args, &hints, ctx);
+  ci->rebuilds = old->rebuilds+1;
+  insertIndex(def, clist, ci);
+  UNLOCKDEF(def);
+
+  if ( !(ci=fillIndex(clist, ci, ctx)) )
+  { LOCKDEF(def);			/* back off until it doubles again */
+    old->grow = FALSE;
+    old->resize_above = old->size*2;
+    old->resizing = FALSE;
+    UNLOCKDEF(def);
+    return NULL;
+  }
+					/* continue the statistics */
+  ci->lookups    += old->lookups;
+  ci->misses     += old->misses;
+  ci->scanned    += old->scanned;
+  ci->lookahead  += old->lookahead;
+  ci->build_time += old->build_time;
+
+  LOCKDEF(def);
+  if ( (cip=currentIndexP(clist, old)) )
+    deleteIndexP(def, clist, cip);
+  UNLOCKDEF(def);
+
+  return ci;
+}
+
+
 static ClauseIndex *
 copyIndex(ClauseIndex *org, int extra)
 { ClauseIndex *ncip;
@@ -1822,7 +2059,7 @@ setIndexes(Definition def, ClauseList cl, ClauseIndex *cip)
   MEMORY_BARRIER();
   cl->clause_indexes = cip;
   if ( cipo )
-    linger_always(&def->lingering, unalloc_index_array, cipo);
+    retireDefinitionData(def, unalloc_index_array, cipo);
 }
 
 
@@ -1857,7 +2094,7 @@ replaceIndex(Definition def, ClauseList cl, ClauseIndex *cip, ClauseIndex ci)
       }
     }
 
-    linger_always(&def->lingering, unalloc_ci, old);
+    retireDefinitionData(def, unalloc_ci, old);
   }
 
   if ( !isSortedIndexes(cl->clause_indexes) )
@@ -2457,7 +2694,7 @@ assess_scan_clauses(ClauseList clist, size_t arity,
   for(i=0, a=assessments; i<assess_count; i++, a++)
   { int j;
 
-    for(j=0; a->args[j]; j++)
+    for(j=0; j < MAX_MULTI_INDEX && a->args[j]; j++)
     { if ( !true_bit(ai, a->args[j]-1) )
       { set_bit(ai, a->args[j]-1);
       }
@@ -2508,7 +2745,7 @@ assess_scan_clauses(ClauseList clist, size_t arity,
       { word key[MAX_MULTI_INDEX];
 	int  harg;
 
-	for(harg=0; a->args[harg]; harg++)
+	for(harg=0; harg < MAX_MULTI_INDEX && a->args[harg]; harg++)
 	{ if ( !(key[harg] = keys[a->args[harg]-1]) )
 	  { a->var_count++;
 	    goto next_assessment;
@@ -2543,57 +2780,79 @@ best_assessment(hash_assessment *assessments, int count, size_t clause_count)
 
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bestHash() finds the best argument for creating a hash, given a concrete
-argument vector and a list of  clauses.   To  do  so, it establishes the
-following figures:
+extend_multi_hash() tries to improve  a   multi-argument  index found by
+bestHash() by adding more of the  promising   arguments,  one  at a time.
+This is needed if no pair of arguments  is selective enough, e.g., if the
+clauses are only distinguished by the combination of three arguments. We
+stop if the index is good enough, the   extension  does not provide a
+significant additional speedup or we reach MAX_MULTI_INDEX arguments.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  - Total number of non-erased clauses in cref
-  - For each indexable argument
-    - The count of distinct values
-    - The count of non-indexable clauses (i.e. clauses with a var
-      at that argument)
+static void
+extend_multi_hash(ClauseList clist, size_t ac,
+		  const iarg_t *instantiated, int ok,
+		  hash_hints *hints, IndexContext ctx)
+{ int nargs;
+
+  for(nargs=2;
+      nargs < MAX_MULTI_INDEX && nargs < ok &&
+      (float)clist->number_of_clauses/hints->speedup > 3;
+      nargs++)
+  { assessment_set aset;
+    hash_assessment *nbest;
+    iarg_t ia[MAX_MULTI_INDEX];
+    int m;
+
+    init_assessment_set(&aset);
+    for(m=0; m<ok; m++)
+    { iarg_t arg = instantiated[m]+1;
+
+      if ( !memchr(hints->args, arg, nargs) )
+      { memcpy(ia, hints->args, sizeof(ia));
+	ia[nargs] = arg;
+	alloc_assessment(&aset, ia);
+      }
+    }
 
-Now, the hash-table has a space   that  is #clauses*(nvars+1), while the
-expected speedup is
+    assess_scan_clauses(clist, ac, aset.assessments, aset.count, ctx);
+    nbest = best_assessment(aset.assessments, aset.count,
+			    clist->number_of_clauses);
+    if ( nbest && nbest->speedup > hints->speedup*MIN_SPEEDUP )
+    { DEBUG(MSG_JIT, Sdprintf("%s: extending index to %s, speedup = %f\n",
+			      predicateName(ctx->predicate),
+			      iargsName(nbest->args, NULL),
+			      nbest->speedup));
+      memcpy(hints->args, nbest->args, sizeof(nbest->args));
+      hints->ln_buckets = MSB(nbest->size);
+      hints->speedup    = nbest->speedup;
+    } else
+    { nbest = NULL;
+    }
 
-	       #clauses * #distinct
-	----------------------------------
-	#clauses - #var + #var * #distinct
+    free_keys_in_assessment_set(&aset);
+    free_assessment_set(&aset);
+    if ( !nbest )
+      break;
+  }
+}
 
-@returns TRUE if a best hash was found.  Details on the best hash are in
-*hints.
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+assessArguments() assesses the arguments in args[0..nargs) of clist that
+have not yet been assessed and  stores   the  result in clist->args[].
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-static int
-bestHash(DECL_LD Word av, size_t ac, ClauseList clist, float min_speedup,
-	 hash_hints *hints, IndexContext ctx)
-{ int i;
-  assessment_set aset;
+static void
+assessArguments(ClauseList clist, size_t ac,
+		const iarg_t *args, int nargs, IndexContext ctx)
+{ assessment_set aset;
   hash_assessment *a;
-  int best = -1;
-  float best_speedup = 0.0;
   iarg_t ia[MAX_MULTI_INDEX] = {0};
-  iarg_t *instantiated;
-  int ninstantiated = 0;
+  int i;
 
-  instantiated = alloca(ac*sizeof(*instantiated));
   init_assessment_set(&aset);
-  if ( !clist->args )
-  { arg_info *ai = allocHeapOrHalt(ac*sizeof(*ai));
-    memset(ai, 0, ac*sizeof(*ai));
-    if ( !COMPARE_AND_SWAP_PTR(&clist->args, NULL, ai) )
-      freeHeap(ai, ac*sizeof(*ai));
-  }
-
-					/* Step 1: find instantiated args */
-  for(i=0; i<ac; i++)
-  { if ( canIndex(av[i]) )
-      instantiated[ninstantiated++] = (iarg_t)i;
-  }
-
-					/* Step 2: find non-yet assessed args */
-  for(i=0; i<ninstantiated; i++)
-  { int arg = instantiated[i];
+  for(i=0; i<nargs; i++)
+  { int arg = args[i];
 
     if ( !clist->args[arg].assessed )
     { ia[0] = (iarg_t)(arg+1);
@@ -2601,7 +2860,7 @@ bestHash(DECL_LD Word av, size_t ac, ClauseList clist, float min_speedup,
     }
   }
 
-  if ( aset.count )			/* Step 3: assess them */
+  if ( aset.count )
   { assess_scan_clauses(clist, ac, aset.assessments, aset.count, ctx);
 
     for(i=0, a=aset.assessments; i<aset.count; i++, a++)
@@ -2635,13 +2894,83 @@ bestHash(DECL_LD Word av, size_t ac, ClauseList clist, float min_speedup,
 
     free_assessment_set(&aset);
   }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+shallowDeepIndex() is TRUE if a deep  index   on  argument arg cannot
+select on an inner argument of the  call.   If several arguments hold a
+compound with the same functor  in  all   clauses,  they  have the same
+speedup and we prefer the one that   allows  the deep index to continue,
+e.g., the third argument for t(_, p(_,_), o(Type,_)).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define shallowDeepIndex(clist, av, arg) LDFUNC(shallowDeepIndex, clist, av, arg)
+static int
+shallowDeepIndex(DECL_LD ClauseList clist, Word av, int arg)
+{ return clist->args[arg].list && !deepIndexable(av+arg);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bestHash() finds the best argument for creating a hash, given a concrete
+argument vector and a list of  clauses.   To  do  so, it establishes the
+following figures:
+
+  - Total number of non-erased clauses in cref
+  - For each indexable argument
+    - The count of distinct values
+    - The count of non-indexable clauses (i.e. clauses with a var
+      at that argument)
+
+Now, the hash-table has a space   that  is #clauses*(nvars+1), while the
+expected speedup is
+
+	       #clauses * #distinct
+	----------------------------------
+	#clauses - #var + #var * #distinct
+
+@returns TRUE if a best hash was found.  Details on the best hash are in
+*hints.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+bestHash(DECL_LD Word av, size_t ac, ClauseList clist, float min_speedup,
+	 hash_hints *hints, IndexContext ctx)
+{ int i;
+  assessment_set aset;
+  int best = -1;
+  float best_speedup = 0.0;
+  iarg_t ia[MAX_MULTI_INDEX] = {0};
+  iarg_t *instantiated;
+  int ninstantiated = 0;
+
+  instantiated = alloca(ac*sizeof(*instantiated));
+  if ( !clist->args )
+  { arg_info *ai = allocHeapOrHalt(ac*sizeof(*ai));
+    memset(ai, 0, ac*sizeof(*ai));
+    if ( !COMPARE_AND_SWAP_PTR(&clist->args, NULL, ai) )
+      freeHeap(ai, ac*sizeof(*ai));
+  }
+
+					/* Step 1: find instantiated args */
+  for(i=0; i<ac; i++)
+  { if ( canIndex(av[i]) )
+      instantiated[ninstantiated++] = (iarg_t)i;
+  }
+
+					/* Step 2,3: assess new args */
+  assessArguments(clist, ac, instantiated, ninstantiated, ctx);
 
 					/* Step 4: find the best (single) arg */
   for(i=0; i<ninstantiated; i++)
   { int arg = instantiated[i];
     arg_info *ainfo = &clist->args[arg];
 
-    if ( ainfo->speedup > best_speedup )
+    if ( ainfo->speedup > best_speedup ||
+	 (ainfo->speedup == best_speedup && best >= 0 &&
+	  shallowDeepIndex(clist, av, best) &&
+	  !shallowDeepIndex(clist, av, arg)) )
     { best = arg;
       best_speedup = ainfo->speedup;
     }
@@ -2691,6 +3020,8 @@ bestHash(DECL_LD Word av, size_t ac, ClauseList clist, float min_speedup,
 
 	free_keys_in_assessment_set(&aset);
 	free_assessment_set(&aset);
+	if ( ok > 2 )
+	  extend_multi_hash(clist, ac, instantiated, ok, hints, ctx);
 	return TRUE;
       }
       free_keys_in_assessment_set(&aset);
@@ -2755,7 +3086,7 @@ size_t
 sizeofClauseIndexes(Definition def)
 { GET_LD
   ClauseIndex *cip;
-  size_t size = 0;
+  size_t size = sizeofRangeIndex(def) + sizeofBloomFilter(def);
 
   if ( (cip=def->impl.clauses.clause_indexes) )
   { acquire_def(def);
@@ -2774,7 +3105,7 @@ sizeofClauseIndexes(Definition def)
 
 
 static int
-unify_clause_index(term_t t, ClauseIndex ci)
+unify_clause_index(term_t t, ClauseIndex ci, int stats)
 { GET_LD
   term_t where = PL_new_term_ref();
   term_t tmp  = PL_new_term_ref();
@@ -2823,6 +3154,20 @@ unify_clause_index(term_t t, ClauseIndex ci)
       return FALSE;
   }
 
+  if ( stats )
+    return PL_unify_term(t,
+			 PL_FUNCTOR, FUNCTOR_minus2,
+			   PL_TERM, where,
+			   PL_FUNCTOR_CHARS, "index_stats", 8,
+			     PL_INT, (int)ci->buckets,
+			     PL_DOUBLE, (double)ci->speedup,
+			     PL_INT64, (int64_t)ci->lookups,
+			     PL_INT64, (int64_t)ci->misses,
+			     PL_INT64, (int64_t)ci->scanned,
+			     PL_INT64, (int64_t)ci->lookahead,
+			     PL_INT, (int)ci->rebuilds,
+			     PL_DOUBLE, ci->build_time);
+
   return PL_unify_term(t,
 		       PL_FUNCTOR, FUNCTOR_minus2,
 			 PL_TERM, where,
@@ -2834,9 +3179,9 @@ unify_clause_index(term_t t, ClauseIndex ci)
 }
 
 
-#define add_deep_indexes(ci, head, tail) LDFUNC(add_deep_indexes, ci, head, tail)
+#define add_deep_indexes(ci, head, tail, stats) LDFUNC(add_deep_indexes, ci, head, tail, stats)
 static int
-add_deep_indexes(DECL_LD ClauseIndex ci, term_t head, term_t tail)
+add_deep_indexes(DECL_LD ClauseIndex ci, term_t head, term_t tail, int stats)
 { size_t i;
 
   for(i=0; i<ci->buckets; i++)
@@ -2855,10 +3200,10 @@ add_deep_indexes(DECL_LD ClauseIndex ci, term_t head, term_t tail)
 	      continue;
 
 	    if ( !PL_unify_list(tail, head, tail) ||
-		 !unify_clause_index(head, ci) )
+		 !unify_clause_index(head, ci, stats) )
 	      return FALSE;
 	    if ( ci->is_list &&
-		 !add_deep_indexes(ci, head, tail) )
+		 !add_deep_indexes(ci, head, tail, stats) )
 	      return FALSE;
 	  }
 	}
@@ -2870,11 +3215,10 @@ add_deep_indexes(DECL_LD ClauseIndex ci, term_t head, term_t tail)
 }
 
 
-bool
-unify_index_pattern(Procedure proc, term_t value)
-{ GET_LD
-  Definition def = getProcDefinition(proc);
-  ClauseIndex *cip;
+#define unify_indexes(def, value, stats) LDFUNC(unify_indexes, def, value, stats)
+static bool
+unify_indexes(DECL_LD Definition def, term_t value, int stats)
+{ ClauseIndex *cip;
   int rc = FALSE;
   int found = 0;
 
@@ -2891,10 +3235,10 @@ unify_index_pattern(Procedure proc, term_t value)
 
       found++;
       if ( !PL_unify_list(tail, head, tail) ||
-	   !unify_clause_index(head, ci) )
+	   !unify_clause_index(head, ci, stats) )
 	goto out;
       if ( ci->is_list )
-      { if ( !add_deep_indexes(ci, head, tail) )
+      { if ( !add_deep_indexes(ci, head, tail, stats) )
 	  goto out;
       }
     }
@@ -2908,6 +3252,997 @@ out:
 }
 
 
+bool
+unify_index_pattern(Procedure proc, term_t value)
+{ GET_LD
+
+  return unify_indexes(getProcDefinition(proc), value, FALSE);
+}
+
+
+/** '$index_statistics'(:Head, -Created, -Indexes) is semidet.
+ *
+ * Provide usage statistics on the clause indexes of a predicate.
+ * Created is the number of indexes that  were created for the predicate,
+ * including deep indexes and indexes that have been deleted.  Indexes is
+ * a list Where-index_stats(Buckets, Speedup, Lookups, Misses, Scanned,
+ * Lookahead, Rebuilds, BuildTime) for each current index.  Fails if the
+ * predicate has no indexes.
+ */
+
+static
+PRED_IMPL("$index_statistics", 3, index_statistics, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Procedure proc;
+  Definition def;
+
+  if ( !get_procedure(A1, &proc, 0, GP_FIND) )
+    return FALSE;
+  def = getProcDefinition(proc);
+  if ( true(def, P_FOREIGN|P_THREAD_LOCAL) )
+    return FALSE;
+
+  return ( PL_unify_integer(A2, def->indexes_created) &&
+	   unify_indexes(def, A3, TRUE) );
+}
+
+
+		 /*******************************
+		 *	  INDEX LAYOUTS		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Index layouts describe the  top  level   hash  indexes  of  a predicate,
+allowing QLF files and saved states to   store  them  such that they are
+rebuilt while loading rather than assessed and created on the first call
+(see pl-qlf.c).
+
+getIndexLayouts() stores the layouts of the complete indexes of `def` in
+`layouts` and returns  their  number.  If   there  are  no  indexes,  it
+assesses the arguments and proposes the  best single argument index, so
+a  predicate  that  is  compiled  to   QLF    without   being  called  is
+indexed as well.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+getIndexLayouts(Definition def, hash_hints *layouts, int max)
+{ GET_LD
+  ClauseList clist = &def->impl.clauses;
+  size_t arity = def->functor->arity;
+  ClauseIndex *cip;
+  int count = 0;
+
+  if ( true(def, P_FOREIGN|P_THREAD_LOCAL) || arity == 0 || max <= 0 )
+    return 0;
+  if ( arity > MAXINDEXARG )
+    arity = MAXINDEXARG;
+
+  LOCKDEF(def);
+  if ( (cip=clist->clause_indexes) )
+  { for(; *cip && count < max; cip++)
+    { ClauseIndex ci = *cip;
+      hash_hints *h;
+
+      if ( ISDEADCI(ci) || ci->incomplete || ci->invalid )
+	continue;
+
+      h = &layouts[count++];
+      memset(h, 0, sizeof(*h));
+      memcpy(h->args, ci->args, sizeof(h->args));
+      h->ln_buckets = MSB(ci->buckets)-1;
+      h->speedup    = ci->speedup;
+      h->list       = ci->is_list;
+    }
+  }
+  UNLOCKDEF(def);
+
+  if ( count == 0 && clist->number_of_clauses > MIN_CLAUSES_FOR_INDEX )
+  { definition_ref *dref;
+    Definition old;
+    index_context ctx;
+    iarg_t *args = alloca(arity*sizeof(*args));
+    float best_speedup = 0.0;
+    int i, best = -1;
+
+    if ( !(dref=pushPredicateAccessObj(def)) )
+      return 0;
+    acquire_def2(def, old);
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.predicate   = def;
+    ctx.generation  = dref->generation;
+    ctx.position[0] = END_INDEX_POS;
+    for(i=0; i<arity; i++)
+      args[i] = (iarg_t)i;
+    assessArguments(clist, arity, args, (int)arity, &ctx);
+    release_def2(def, old);
+    popPredicateAccess(def);
+
+    for(i=0; i<arity; i++)
+    { if ( clist->args[i].speedup > best_speedup )
+      { best = i;
+	best_speedup = clist->args[i].speedup;
+      }
+    }
+
+    if ( best >= 0 )
+    { arg_info *ainfo = &clist->args[best];
+      hash_hints *h = &layouts[count++];
+
+      memset(h, 0, sizeof(*h));
+      h->args[0]    = (iarg_t)(best+1);
+      h->ln_buckets = ainfo->ln_buckets;
+      h->speedup    = ainfo->speedup;
+      h->list       = ainfo->list;
+    }
+  }
+
+  return count;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+restoreIndexLayouts() creates the indexes described by `layouts` for the
+clauses of `def`.  Layouts come from a file and are thus validated.  The
+number of buckets is limited by the  number   of  clauses; if the index
+turns out too small it is resized as usual.  For single argument indexes
+we also restore the assessment of the argument.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+validIndexLayout(const hash_hints *h, size_t arity)
+{ int i;
+
+  if ( !h->args[0] )
+    return FALSE;
+  for(i=0; i<MAX_MULTI_INDEX && h->args[i]; i++)
+  { if ( h->args[i] > arity )
+      return FALSE;
+  }
+  for(; i<MAX_MULTI_INDEX; i++)
+  { if ( h->args[i] )
+      return FALSE;
+  }
+
+  return h->speedup > 0.0;
+}
+
+
+void
+restoreIndexLayouts(Definition def, hash_hints *layouts, int count)
+{ GET_LD
+  ClauseList clist = &def->impl.clauses;
+  size_t arity = def->functor->arity;
+  definition_ref *dref;
+  Definition old;
+  index_context ctx;
+  int i;
+
+  if ( count == 0 || true(def, P_FOREIGN|P_THREAD_LOCAL) ||
+       clist->number_of_clauses == 0 )
+    return;
+  if ( arity > MAXINDEXARG )
+    arity = MAXINDEXARG;
+
+  if ( !(dref=pushPredicateAccessObj(def)) )
+    return;
+  acquire_def2(def, old);
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.predicate   = def;
+  ctx.generation  = dref->generation;
+  ctx.position[0] = END_INDEX_POS;
+
+  for(i=0; i<count; i++)
+  { hash_hints *h = &layouts[i];
+    unsigned int max_ln = MSB(clist->number_of_clauses);
+
+    if ( !validIndexLayout(h, arity) )
+      continue;
+    if ( h->ln_buckets > max_ln )
+      h->ln_buckets = max_ln;
+
+    if ( !h->args[1] )
+    { arg_info *ainfo = &clist->args[h->args[0]-1];
+
+      if ( !ainfo->assessed )
+      { ainfo->speedup    = h->speedup;
+	ainfo->list       = h->list;
+	ainfo->ln_buckets = h->ln_buckets&0x1f;
+	ainfo->assessed   = TRUE;
+      }
+    }
+
+    DEBUG(MSG_JIT, Sdprintf("Restoring index %s of %s\n",
+			    iargsName(h->args, NULL), predicateName(def)));
+    hashDefinition(clist, h, &ctx);
+  }
+
+  release_def2(def, old);
+  popPredicateAccess(def);
+}
+
+
+		 /*******************************
+		 *	  RANGE INDEXES		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The hash indexes above  only  serve  calls   where  the  argument  is
+instantiated to a specific key. Range   queries  (timestamps, numeric
+identifiers, etc.) over large  predicates  need   an  ordered  index
+instead.  A range index is created  on   the  first  call  to
+range_call/4 (through '$range_clause'/5) and maps the  keys of one
+argument to the clauses in standard order of terms.
+
+Keys are numbers (as double, which  preserves   the  order  for  the
+purpose of filtering) and atoms (ordered using compareAtoms()). Clauses
+that have something else  at  the  indexed   position  (variables,
+strings, compounds, big integers, NaN) are   _residual_. They sort before
+all keys and are always candidates. The index  is a _filter_: the final
+test is done in Prolog using standard order of terms.
+
+The index is a sorted array   followed  by an unsorted _tail_ to which
+addClauseToIndexes() appends new  clauses.  The   index  holds  a clause
+reference to all its clauses,  so  readers   only  need  to protect the
+predicate generation. Readers that find a too  long tail or many erased
+clauses rebuild the index. Old  indexes   are  released  through the
+lingering mechanism of the predicate.
+
+All modifications are done holding LOCKDEF()  (which is L_PREDICATE).
+There is at most one range index per predicate.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define RK_RESIDUAL	0		/* Not indexable: always a candidate */
+#define RK_NUMBER	1		/* Integer or float */
+#define RK_STRING	2		/* Strings sort between numbers and atoms */
+#define RK_ATOM		3		/* Atom (text or blob) */
+#define RK_MAX		4		/* Above all keys (compound) */
+
+#define RANGE_MIN_TAIL	32		/* Allow at least this unsorted tail */
+#define RANGE_MIN_ERASED 32		/* Rebuild on at least this #erased */
+
+typedef struct range_key
+{ int		type;			/* RK_* */
+  union
+  { double	number;			/* RK_NUMBER */
+    atom_t	atom;			/* RK_ATOM */
+  } value;
+} range_key;
+
+typedef struct range_entry
+{ range_key	key;			/* Key for the clause */
+  size_t	order;			/* Order of addition */
+  Clause	clause;			/* The clause */
+} range_entry;
+
+typedef struct range_index
+{ unsigned int	arg;			/* Indexed argument (1-based) */
+  size_t	size;			/* #entries in use */
+  size_t	sorted;			/* entries[0..sorted) are ordered */
+  size_t	allocated;		/* #entries allocated */
+  size_t	order;			/* Order for the next entry */
+  size_t	erased;			/* #entries erased since creation */
+  range_entry  *entries;		/* The entries */
+} range_index, *RangeIndex;
+
+
+static void
+rangeKeyFromClause(Clause cl, unsigned int arg, range_key *key)
+{ Code PC = cl->codes;
+
+  key->type = RK_RESIDUAL;
+  if ( arg > 1 )
+    PC = skipArgs(PC, arg-1);
+
+  for(;;)
+  { code c = decode(*PC++);
+
+#if O_DEBUGGER
+  again:
+#endif
+    switch(c)
+    { case H_SMALLINT:
+	key->type = RK_NUMBER;
+	key->value.number = (double)(scode)*PC;
+	return;
+#if CODES_PER_WORD > 1
+      case H_SMALLINTW:
+      { word m;
+
+	code_get_word(PC, &m);
+	key->type = RK_NUMBER;
+	key->value.number = (double)(intptr_t)m;
+	return;
+      }
+#endif
+      case H_FLOAT:
+      { double f;
+
+	memcpy(&f, PC, sizeof(f));
+	if ( !isnan(f) )
+	{ key->type = RK_NUMBER;
+	  key->value.number = f;
+	}
+	return;
+      }
+      case H_ATOM:
+	key->type = RK_ATOM;
+	key->value.atom = code2atom(*PC);
+	return;
+      case H_NIL:
+	key->type = RK_ATOM;
+	key->value.atom = ATOM_nil;
+	return;
+      case I_NOP:
+      case I_CHP:
+	continue;
+#ifdef O_DEBUGGER
+      case D_BREAK:
+	c = decode(replacedBreak(PC-1));
+	goto again;
+#endif
+      default:
+	return;
+    }
+  }
+}
+
+
+static int
+compareRangeKeys(const range_key *k1, const range_key *k2)
+{ if ( k1->type != k2->type )
+    return k1->type < k2->type ? CMP_LESS : CMP_GREATER;
+
+  switch(k1->type)
+  { case RK_NUMBER:
+      return ( k1->value.number < k2->value.number ? CMP_LESS :
+	       k1->value.number > k2->value.number ? CMP_GREATER :
+						     CMP_EQUAL );
+    case RK_ATOM:
+      if ( k1->value.atom == k2->value.atom )
+	return CMP_EQUAL;
+      return compareAtoms(k1->value.atom, k2->value.atom);
+    default:
+      return CMP_EQUAL;
+  }
+}
+
+
+static int
+compareRangeEntries(const void *p1, const void *p2)
+{ const range_entry *e1 = p1;
+  const range_entry *e2 = p2;
+  int rc = compareRangeKeys(&e1->key, &e2->key);
+
+  if ( rc == CMP_EQUAL )
+    rc = ( e1->order < e2->order ? CMP_LESS :
+	   e1->order > e2->order ? CMP_GREATER : CMP_EQUAL );
+
+  return rc;
+}
+
+
+/* lowerBoundRangeIndex() returns the first index in the sorted part
+   of the range index whose key is not below key
+*/
+
+static size_t
+lowerBoundRangeIndex(RangeIndex ri, size_t sorted, const range_key *key)
+{ size_t l = 0, h = sorted;
+
+  while(l < h)
+  { size_t m = l+(h-l)/2;
+
+    if ( compareRangeKeys(&ri->entries[m].key, key) < 0 )
+      l = m+1;
+    else
+      h = m;
+  }
+
+  return l;
+}
+
+
+static void
+freeRangeIndex(RangeIndex ri)
+{ size_t i;
+
+  for(i=0; i<ri->size; i++)
+    release_clause(ri->entries[i].clause);
+  freeHeap(ri->entries, sizeof(*ri->entries)*ri->allocated);
+  freeHeap(ri, sizeof(*ri));
+}
+
+
+static void
+unalloc_range_index(void *p)
+{ freeRangeIndex(p);
+}
+
+
+static void				/* definition must be locked */
+dropRangeIndex(Definition def)
+{ RangeIndex ri;
+
+  if ( (ri=def->range_index) )
+  { DEBUG(MSG_JIT_DELINDEX,
+	  Sdprintf("Deleted range index %d from %s\n",
+		   ri->arg, predicateName(def)));
+    def->range_index = NULL;
+    MEMORY_RELEASE();
+    retireDefinitionData(def, unalloc_range_index, ri);
+  }
+}
+
+
+static RangeIndex			/* definition must be locked */
+buildRangeIndex(Definition def, unsigned int arg)
+{ RangeIndex ri = allocHeapOrHalt(sizeof(*ri));
+  ClauseRef cref;
+  size_t n = 0;
+
+  for(cref=def->impl.clauses.first_clause; cref; cref=cref->next)
+    n++;
+
+  memset(ri, 0, sizeof(*ri));
+  ri->arg       = arg;
+  ri->allocated = n+n/2+RANGE_MIN_TAIL;
+  ri->entries   = allocHeapOrHalt(sizeof(*ri->entries)*ri->allocated);
+
+					/* includes erased clauses that may */
+					/* still be visible to some thread */
+  for(cref=def->impl.clauses.first_clause; cref; cref=cref->next)
+  { range_entry *e = &ri->entries[ri->size++];
+
+    e->clause = cref->value.clause;
+    e->order  = ri->order++;
+    acquire_clause(e->clause);
+    rangeKeyFromClause(e->clause, arg, &e->key);
+  }
+
+  qsort(ri->entries, ri->size, sizeof(*ri->entries), compareRangeEntries);
+  ri->sorted = ri->size;
+
+  DEBUG(MSG_JIT,
+	Sdprintf("Created range index on arg %d of %s with %zd clauses\n",
+		 arg, predicateName(def), ri->size));
+
+  return ri;
+}
+
+
+static int
+rangeIndexNeedsRebuild(const RangeIndex ri)
+{ size_t tail = ri->size - ri->sorted;
+
+  return ( (tail > RANGE_MIN_TAIL && tail > ri->sorted/8) ||
+	   (ri->erased > RANGE_MIN_ERASED && ri->erased > ri->size/2) );
+}
+
+
+static RangeIndex
+getRangeIndex(Definition def, unsigned int arg)
+{ RangeIndex ri = def->range_index;
+
+  MEMORY_ACQUIRE();
+  if ( !ri || ri->arg != arg || rangeIndexNeedsRebuild(ri) )
+  { LOCKDEF(def);
+    ri = def->range_index;
+    if ( !ri || ri->arg != arg || rangeIndexNeedsRebuild(ri) )
+    { RangeIndex nri = buildRangeIndex(def, arg);
+
+      dropRangeIndex(def);
+      MEMORY_RELEASE();
+      def->range_index = ri = nri;
+    }
+    UNLOCKDEF(def);
+  }
+
+  return ri;
+}
+
+
+/* Called from addClauseToIndexes() with the definition locked.  If the
+   tail is full we drop the index; the next range query rebuilds it.
+*/
+
+static void
+addClauseToRangeIndex(Definition def, Clause cl)
+{ RangeIndex ri;
+
+  if ( (ri=def->range_index) )
+  { if ( ri->size < ri->allocated )
+    { range_entry *e = &ri->entries[ri->size];
+
+      e->clause = cl;
+      e->order  = ri->order++;
+      acquire_clause(cl);
+      rangeKeyFromClause(cl, ri->arg, &e->key);
+      MEMORY_RELEASE();
+      ri->size++;
+    } else
+    { dropRangeIndex(def);
+    }
+  }
+}
+
+
+/* Called when a clause is erased.  Dynamic predicates drop the index
+   if it is dominated by erased clauses to avoid keeping these alive.
+*/
+
+static void
+deleteClauseFromRangeIndex(Definition def)
+{ RangeIndex ri;
+
+  if ( (ri=def->range_index) )
+  { ri->erased++;
+    if ( true(def, P_DYNAMIC) &&
+	 ri->erased > RANGE_MIN_ERASED && ri->erased > ri->size/2 )
+      dropRangeIndex(def);
+  }
+}
+
+
+static size_t
+sizeofRangeIndex(Definition def)
+{ RangeIndex ri = def->range_index;
+
+  if ( ri )
+    return sizeof(*ri) + sizeof(*ri->entries)*ri->allocated;
+
+  return 0;
+}
+
+
+/* get_range_bound() translates a bound into a key.  Unbound is
+   unbounded.  Numbers that cannot be represented as a double are
+   unbounded as well; the index is only a filter.
+*/
+
+#define get_range_bound(t, upper, key) LDFUNC(get_range_bound, t, upper, key)
+
+static void
+get_range_bound(DECL_LD term_t t, int upper, range_key *key)
+{ atom_t a;
+  double f;
+
+  if ( PL_is_variable(t) )
+  { if ( upper )
+    { key->type = RK_MAX;
+    } else
+    { key->type = RK_NUMBER;
+      key->value.number = -INFINITY;
+    }
+  } else if ( PL_is_number(t) )
+  { key->type = RK_NUMBER;
+    if ( PL_get_float(t, &f) && !isnan(f) )
+      key->value.number = f;
+    else
+      key->value.number = upper ? INFINITY : -INFINITY;
+    PL_clear_exception();
+  } else if ( PL_is_string(t) )
+  { key->type = RK_STRING;
+  } else if ( PL_get_atom(t, &a) )
+  { key->type = RK_ATOM;
+    key->value.atom = a;
+  } else
+  { key->type = RK_MAX;
+  }
+}
+
+
+#define rangeCandidates(ri, lo, hi, gen, b) \
+	LDFUNC(rangeCandidates, ri, lo, hi, gen, b)
+
+static void
+rangeCandidates(DECL_LD RangeIndex ri,
+		const range_key *lo, const range_key *hi,
+		gen_t gen, Buffer b)
+{ size_t size   = ri->size;
+  size_t sorted = ri->sorted;
+  size_t i, nres, from;
+  range_key first = { .type = RK_NUMBER, .value.number = -INFINITY };
+  int resort = FALSE;
+
+  MEMORY_ACQUIRE();			/* sync with addClauseToRangeIndex() */
+  nres = lowerBoundRangeIndex(ri, sorted, &first);
+  for(i=0; i<nres; i++)
+  { range_entry *e = &ri->entries[i];
+
+    if ( visibleClause(e->clause, gen) )
+      addBuffer(b, *e, range_entry);
+  }
+
+  from = lowerBoundRangeIndex(ri, sorted, lo);
+  if ( from < nres )
+    from = nres;
+  for(i=from; i<sorted; i++)
+  { range_entry *e = &ri->entries[i];
+
+    if ( compareRangeKeys(&e->key, hi) > 0 )
+      break;
+    if ( visibleClause(e->clause, gen) )
+      addBuffer(b, *e, range_entry);
+  }
+
+  for(i=sorted; i<size; i++)
+  { range_entry *e = &ri->entries[i];
+
+    if ( (e->key.type == RK_RESIDUAL ||
+	  ( compareRangeKeys(&e->key, lo) >= 0 &&
+	    compareRangeKeys(&e->key, hi) <= 0 )) &&
+	 visibleClause(e->clause, gen) )
+    { addBuffer(b, *e, range_entry);
+      resort = TRUE;
+    }
+  }
+
+  if ( resort )
+    qsort(baseBuffer(b, range_entry), entriesBuffer(b, range_entry),
+	  sizeof(range_entry), compareRangeEntries);
+}
+
+
+/** '$range_clause'(:Head, +Arg, ?Low, ?High, -ClauseRef) is nondet.
+
+True when ClauseRef is a clause of  Head that may have a value for the
+Arg-th argument in the range Low..High  (inclusive, standard order of
+terms, unbound is unbounded).  Clauses   are  enumerated  in  standard
+order of the argument.  This is a  filter; clauses with e.g., a variable
+at the argument are always returned.  See range_call/4.
+*/
+
+typedef struct range_enum
+{ Definition	def;			/* Predicate we enumerate */
+  size_t	count;			/* #candidate clauses */
+  size_t	current;		/* Next to return */
+  Clause       *clauses;		/* Candidate clauses */
+} range_enum;
+
+#define free_range_enum(state) LDFUNC(free_range_enum, state)
+
+static void
+free_range_enum(DECL_LD range_enum *state)
+{ popPredicateAccess(state->def);
+  if ( state->clauses )
+    freeHeap(state->clauses, sizeof(Clause)*state->count);
+  freeForeignState(state, sizeof(*state));
+}
+
+static
+PRED_IMPL("$range_clause", 5, range_clause,
+	  PL_FA_TRANSPARENT|PL_FA_NONDETERMINISTIC)
+{ PRED_LD
+  range_enum *state;
+
+  switch( CTX_CNTRL )
+  { case FRG_FIRST_CALL:
+    { Procedure proc;
+      Definition def;
+      definition_ref *dref;
+      RangeIndex ri;
+      range_key lo, hi;
+      int arg;
+      tmp_buffer b;
+
+      if ( !get_procedure(A1, &proc, 0, GP_FIND|GP_EXISTENCE_ERROR) ||
+	   !PL_get_integer_ex(A2, &arg) )
+	return FALSE;
+      def = getProcDefinition(proc);
+      if ( true(def, P_FOREIGN) )
+	return PL_error(NULL, 0, NULL, ERR_PERMISSION_PROC,
+			ATOM_access, ATOM_private_procedure, proc);
+      if ( arg < 1 || arg > (int)def->functor->arity )
+	return PL_domain_error("argument", A2);
+      get_range_bound(A3, FALSE, &lo);
+      get_range_bound(A4, TRUE,  &hi);
+
+      if ( !(dref=pushPredicateAccessObj(def)) )
+	return FALSE;
+      ri = getRangeIndex(def, arg);
+      initBuffer(&b);
+      rangeCandidates(ri, &lo, &hi, dref->generation, (Buffer)&b);
+
+      state = allocForeignState(sizeof(*state));
+      state->def     = def;
+      state->current = 0;
+      state->count   = entriesBuffer(&b, range_entry);
+      if ( state->count )
+      { range_entry *e = baseBuffer(&b, range_entry);
+	size_t i;
+
+	state->clauses = allocHeapOrHalt(sizeof(Clause)*state->count);
+	for(i=0; i<state->count; i++)
+	  state->clauses[i] = e[i].clause;
+      } else
+      { state->clauses = NULL;
+      }
+      discardBuffer(&b);
+      break;
+    }
+    case FRG_REDO:
+      state = CTX_PTR;
+      break;
+    case FRG_CUTTED:
+      state = CTX_PTR;
+      free_range_enum(state);
+      return TRUE;
+    default:
+      assert(0);
+      return FALSE;
+  }
+
+  while( state->current < state->count )
+  { Clause cl = state->clauses[state->current++];
+
+    if ( PL_unify_clref(A5, cl) )
+    { if ( state->current < state->count )
+	ForeignRedoPtr(state);
+      free_range_enum(state);
+      return TRUE;
+    }
+    if ( PL_exception(0) )
+      break;
+  }
+
+  free_range_enum(state);
+  return FALSE;
+}
+
+
+		 /*******************************
+		 *	  BLOOM FILTERS		*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If no index is suitable for a call,  we   must  scan all clauses. If the
+Prolog flag `index_bloom_filter` is set,  predicates with more than
+MIN_CLAUSES_FOR_INDEX  clauses  get  a  Bloom  filter  over  the  key
+combination of the arguments that are instantiated  in the call that
+creates the filter.  Calls that  have  these  arguments instantiated and
+whose key is not in the filter fail without scanning the clauses.
+
+The filter uses BLOOM_BITS_PER_KEY bits  per   clause and BLOOM_HASHES
+bit positions per key.  It  holds  the  keys  of  all  clauses  in the
+clause list, including erased  ones  that  may   be  visible  to  older
+generations.  As we cannot delete keys, the filter is dropped if half of
+its keys are erased or the number of  clauses doubles.  The next call
+without a suitable index creates a new one.  A clause that cannot be
+indexed on the filter arguments, i.e., has  a variable there, disables
+the filter until it is rebuilt.
+
+The bits are only set with the  definition locked. Readers access them
+without locking.  Old filters are reclaimed using linger_always().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BLOOM_BITS_PER_KEY 16
+#define BLOOM_HASHES	    4
+#define BLOOM_MIN_BITS	  256
+
+typedef struct bloom_filter
+{ iarg_t	args[MAX_MULTI_INDEX];	/* Arguments (1-based) */
+  size_t	nbits;			/* #bits (power of 2) */
+  size_t	count;			/* #keys added */
+  size_t	capacity;		/* Drop if count exceeds this */
+  size_t	erased;			/* #keys erased since creation */
+  size_t	nvars;			/* #clauses without a key */
+  uint64_t	rejected;		/* #calls that failed early */
+  uint64_t     *bits;			/* The bit vector */
+} bloom_filter, *BloomFilter;
+
+
+static void
+bloomPositions(word key, size_t nbits, size_t pos[BLOOM_HASHES])
+{ unsigned int h1 = MurmurHashAligned2(&key, sizeof(key), MURMUR_SEED);
+  unsigned int h2 = MurmurHashAligned2(&key, sizeof(key), ~MURMUR_SEED)|1;
+  int i;
+
+  for(i=0; i<BLOOM_HASHES; i++)
+    pos[i] = (h1 + (size_t)i*h2) & (nbits-1);
+}
+
+
+static void
+addKeyToBloomFilter(BloomFilter bf, word key)
+{ size_t pos[BLOOM_HASHES];
+  int i;
+
+  bloomPositions(key, bf->nbits, pos);
+  for(i=0; i<BLOOM_HASHES; i++)
+    ATOMIC_OR(&bf->bits[pos[i]/64], (uint64_t)1<<(pos[i]%64));
+}
+
+
+static int
+keyInBloomFilter(const BloomFilter bf, word key)
+{ size_t pos[BLOOM_HASHES];
+  int i;
+
+  bloomPositions(key, bf->nbits, pos);
+  for(i=0; i<BLOOM_HASHES; i++)
+  { if ( !(bf->bits[pos[i]/64] & ((uint64_t)1<<(pos[i]%64))) )
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static void
+addClauseKeyToBloomFilter(BloomFilter bf, Clause cl)
+{ static const iarg_t top[1] = {END_INDEX_POS};
+  word key = argsKeyFromClause(bf->args, top, cl, NULL);
+
+  if ( key )
+    addKeyToBloomFilter(bf, key);
+  else
+    bf->nvars++;
+  bf->count++;
+}
+
+
+static void
+freeBloomFilter(BloomFilter bf)
+{ freeHeap(bf->bits, bf->nbits/8);
+  freeHeap(bf, sizeof(*bf));
+}
+
+
+static void
+unalloc_bloom_filter(void *p)
+{ freeBloomFilter(p);
+}
+
+
+static void				/* definition must be locked */
+dropBloomFilter(Definition def)
+{ BloomFilter bf;
+
+  if ( (bf=def->bloom_filter) )
+  { DEBUG(MSG_JIT_DELINDEX,
+	  Sdprintf("Deleted Bloom filter %s from %s (%" PRIu64 " rejected)\n",
+		   iargsName(bf->args, NULL), predicateName(def),
+		   bf->rejected));
+    def->bloom_filter = NULL;
+    MEMORY_RELEASE();
+    retireDefinitionData(def, unalloc_bloom_filter, bf);
+  }
+}
+
+
+static BloomFilter			/* definition must be locked */
+buildBloomFilter(Definition def, const iarg_t *args)
+{ BloomFilter bf = allocHeapOrHalt(sizeof(*bf));
+  ClauseRef cref;
+  size_t n = 0;
+
+  for(cref=def->impl.clauses.first_clause; cref; cref=cref->next)
+    n++;
+
+  memset(bf, 0, sizeof(*bf));
+  memcpy(bf->args, args, sizeof(bf->args));
+  bf->nbits = BLOOM_MIN_BITS;
+  while ( bf->nbits < n*BLOOM_BITS_PER_KEY )
+    bf->nbits *= 2;
+  bf->capacity = 2*(bf->nbits/BLOOM_BITS_PER_KEY);
+  bf->bits = allocHeapOrHalt(bf->nbits/8);
+  memset(bf->bits, 0, bf->nbits/8);
+
+  for(cref=def->impl.clauses.first_clause; cref; cref=cref->next)
+    addClauseKeyToBloomFilter(bf, cref->value.clause);
+
+  DEBUG(MSG_JIT,
+	Sdprintf("Created Bloom filter %s for %s: %zd clauses, %zd bits\n",
+		 iargsName(bf->args, NULL), predicateName(def),
+		 bf->count, bf->nbits));
+
+  return bf;
+}
+
+
+/* Find or create the filter for a call.  Returns NULL if there is no
+   filter and we should not create one.
+*/
+
+#define getBloomFilter(argv, argc, clist, ctx) \
+	LDFUNC(getBloomFilter, argv, argc, clist, ctx)
+
+static BloomFilter
+getBloomFilter(DECL_LD Word argv, size_t argc, ClauseList clist,
+	       IndexContext ctx)
+{ Definition def = ctx->predicate;
+  BloomFilter bf;
+
+  if ( (bf=def->bloom_filter) )
+  { MEMORY_ACQUIRE();
+    return bf;
+  }
+
+  if ( truePrologFlag(PLFLAG_INDEX_BLOOM_FILTER) &&
+       ctx->depth == 0 &&
+       clist->number_of_clauses > MIN_CLAUSES_FOR_INDEX )
+  { iarg_t args[MAX_MULTI_INDEX] = {0};
+    int i, n = 0;
+
+    for(i=0; i<argc && n < MAX_MULTI_INDEX; i++)
+    { if ( canIndex(argv[i]) )
+	args[n++] = (iarg_t)(i+1);
+    }
+
+    if ( n > 0 )
+    { LOCKDEF(def);
+      if ( !(bf=def->bloom_filter) )
+      { bf = buildBloomFilter(def, args);
+	MEMORY_RELEASE();
+	def->bloom_filter = bf;
+      }
+      UNLOCKDEF(def);
+    }
+  }
+
+  return bf;
+}
+
+
+/* bloomRejects() is called before scanning all clauses of a predicate.
+   It returns TRUE if no clause can match the call.
+*/
+
+static int
+bloomRejects(DECL_LD Word argv, size_t argc, ClauseList clist,
+	     IndexContext ctx)
+{ BloomFilter bf;
+  word key;
+
+  if ( (bf=getBloomFilter(argv, argc, clist, ctx)) &&
+       bf->nvars == 0 &&
+       (key=argsKeyFromArgv(bf->args, argv)) &&
+       !keyInBloomFilter(bf, key) )
+  { bf->rejected++;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+/* Called from addClauseToIndexes() with the definition locked */
+
+static void
+addClauseToBloomFilter(Definition def, Clause cl)
+{ BloomFilter bf;
+
+  if ( (bf=def->bloom_filter) )
+  { if ( bf->count < bf->capacity )
+      addClauseKeyToBloomFilter(bf, cl);
+    else
+      dropBloomFilter(def);
+  }
+}
+
+
+static void
+deleteClauseFromBloomFilter(Definition def)
+{ BloomFilter bf;
+
+  if ( (bf=def->bloom_filter) )
+  { if ( ++bf->erased > bf->count/2 && bf->count > MIN_CLAUSES_FOR_INDEX )
+      dropBloomFilter(def);
+  }
+}
+
+
+static size_t
+sizeofBloomFilter(Definition def)
+{ BloomFilter bf = def->bloom_filter;
+
+  if ( bf )
+    return sizeof(*bf) + bf->nbits/8;
+
+  return 0;
+}
+
+
 		 /*******************************
 		 *             INIT             *
 		 *******************************/
@@ -2927,4 +4262,7 @@ initClauseIndexing(void)
 		 *******************************/
 
 BeginPredDefs(index)
+  PRED_DEF("$index_statistics", 3, index_statistics, PL_FA_TRANSPARENT)
+  PRED_DEF("$range_clause", 5, range_clause,
+	   PL_FA_TRANSPARENT|PL_FA_NONDETERMINISTIC)
 EndPredDefs
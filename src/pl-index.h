@@ -38,6 +38,13 @@
 #ifndef _PL_INDEX_H
 #define _PL_INDEX_H
 
+typedef struct hash_hints
+{ iarg_t	args[MAX_MULTI_INDEX];	/* Hash these arguments */
+  float		speedup;		/* Expected speedup */
+  unsigned int	ln_buckets;		/* Lg2 of #buckets to use */
+  unsigned	list : 1;		/* Use a list per key */
+} hash_hints;
+
 		 /*******************************
 		 *    FUNCTION DECLARATIONS	*
 		 *******************************/
@@ -45,11 +52,13 @@
 #if USE_LD_MACROS
 #define	firstClause(argv, fr, def, next)	LDFUNC(firstClause, argv, fr, def, next)
 #define	nextClause(chp, argv, fr, def)		LDFUNC(nextClause, chp, argv, fr, def)
+#define	getIndexOfWord(w)			LDFUNC(getIndexOfWord, w)
 #endif /*USE_LD_MACROS*/
 
 #define LDFUNC_DECLARATIONS
 
 word		getIndexOfTerm(term_t t);
+word		getIndexOfWord(word w);
 ClauseRef	firstClause(Word argv, LocalFrame fr, Definition def,
 			    ClauseChoice next);
 ClauseRef	nextClause(ClauseChoice chp, Word argv, LocalFrame fr,
@@ -70,6 +79,9 @@ int		checkClauseIndexSizes(Definition def, int nindexable);
 void		checkClauseIndexes(Definition def);
 void		listIndexGenerations(Definition def, gen_t gen);
 size_t		sizeofClauseIndexes(Definition def);
+int		getIndexLayouts(Definition def, hash_hints *layouts, int max);
+void		restoreIndexLayouts(Definition def,
+				    hash_hints *layouts, int count);
 void		initClauseIndexing();
 
 #undef LDFUNC_DECLARATIONS
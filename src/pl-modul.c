@@ -1425,6 +1425,45 @@ sizeof_module(Module m)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+'$module_memory'(+Module, -Usage) rolls up   the memory accounted to the
+predicates defined in Module.  Unlike sizeof_module() this does not walk
+the clauses.  Usage is a term memory(Clauses, Indexes, Code, Tables),
+where Tables is the size of the module's own tables and procedures.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static
+PRED_IMPL("$module_memory", 2, module_memory, 0)
+{ PRED_LD
+  Module m;
+  pred_memory mem = {0};
+  size_t tables = sizeof(*m);
+
+  if ( !get_module(A1, &m, FALSE) )
+    fail;
+
+  if ( m->public)     tables += sizeofTableWP(m->public);
+  if ( m->procedures) tables += sizeofTableWP(m->procedures);
+  if ( m->operators)  tables += sizeofTableWP(m->operators);
+
+  FOR_TABLE(m->procedures, name, value)
+  { Procedure proc = val2ptr(value);
+    Definition def = proc->definition;
+
+    tables += sizeof(*proc);
+    if ( def->module == m )
+      predicateMemory(def, &mem);
+  }
+
+  return PL_unify_term(A2,
+		       PL_FUNCTOR_CHARS, "memory", 4,
+			 PL_INT64, (int64_t)mem.clauses,
+			 PL_INT64, (int64_t)mem.indexes,
+			 PL_INT64, (int64_t)mem.code,
+			 PL_INT64, (int64_t)tables);
+}
+
+
 
 static
 PRED_IMPL("$module_property", 2, module_property, 0)
@@ -1842,6 +1881,7 @@ BeginPredDefs(module)
   PRED_DEF("set_module", 1, set_module, PL_FA_TRANSPARENT)
   PRED_DEF("$current_module", 2, current_module, PL_FA_NONDETERMINISTIC)
   PRED_DEF("$module_property", 2, module_property, 0)
+  PRED_DEF("$module_memory", 2, module_memory, 0)
   PRED_DEF("strip_module", 3, strip_module, PL_FA_TRANSPARENT)
   PRED_DEF("import", 1, import, PL_FA_TRANSPARENT)
   PRED_DEF("$import", 2, import, PL_FA_TRANSPARENT)
@@ -0,0 +1,1070 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2026, SWI-Prolog Solutions b.v.
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include "pl-arith.h"
+#include "pl-fli.h"
+#include "pl-numarray.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+This module implements _numeric arrays_: immutable, contiguous vectors of
+64-bit integers or doubles that are represented  by a blob. They provide
+elementwise operations, comparison masks  and reductions without creating
+Prolog lists or numbers for the elements.
+
+The kernels are simple loops over  plain   C  arrays  that are written to
+allow the C compiler to vectorize them. Reductions over floats use four
+independent accumulators for the same  reason,   which  implies that the
+order of summation differs from a sequential sum.
+
+Elementwise float operations follow  IEEE  semantics:   the  float flags
+(float_overflow, etc.) only apply to the  results of reductions that are
+evaluated by is/2.  Integer operations raise an int_overflow evaluation
+error if an element overflows, except  for   the  sum/1 and dot/2 where
+the result is promoted to an unbounded integer.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef enum
+{ NA_INT64 = 0,
+  NA_FLOAT64
+} na_type;
+
+typedef struct numarray
+{ na_type	type;			/* NA_INT64 or NA_FLOAT64 */
+  size_t	size;			/* # elements */
+  union
+  { int64_t	i[1];
+    double	f[1];
+  } data;				/* The elements */
+} numarray;
+
+static numarray *
+alloc_numarray(na_type type, size_t size)
+{ numarray *a;
+  size_t bytes;
+
+  if ( size > (SIZE_MAX-sizeof(*a))/sizeof(int64_t) )
+  { PL_resource_error("memory");
+    return NULL;
+  }
+  bytes = offsetof(numarray, data) + (size ? size : 1)*sizeof(int64_t);
+  if ( !(a = malloc(bytes)) )
+  { PL_no_memory();
+    return NULL;
+  }
+  a->type = type;
+  a->size = size;
+
+  return a;
+}
+
+
+		 /*******************************
+		 *	       BLOB		*
+		 *******************************/
+
+static const char *
+type_name(na_type type)
+{ return type == NA_INT64 ? "int64" : "float64";
+}
+
+static int
+write_numarray(IOSTREAM *s, atom_t aref, int flags)
+{ numarray *a = PL_blob_data(aref, NULL, NULL);
+  (void)flags;
+
+  Sfprintf(s, "<numeric_array>(%s,%zd,%p)", type_name(a->type), a->size, a);
+  return TRUE;
+}
+
+static int
+release_numarray(atom_t aref)
+{ numarray *a = PL_blob_data(aref, NULL, NULL);
+
+  free(a);
+  return TRUE;
+}
+
+static int
+save_numarray(atom_t aref, IOSTREAM *fd)
+{ numarray *a = PL_blob_data(aref, NULL, NULL);
+  (void)fd;
+
+  return PL_warning("Cannot save reference to <numeric_array>(%p)", a);
+}
+
+static atom_t
+load_numarray(IOSTREAM *fd)
+{ (void)fd;
+
+  return PL_new_atom("<saved-numeric_array-ref>");
+}
+
+static PL_blob_t numarray_blob =
+{ PL_BLOB_MAGIC,
+  PL_BLOB_NOCOPY,
+  "numeric_array",
+  release_numarray,
+  NULL,
+  write_numarray,
+  NULL,
+  save_numarray,
+  load_numarray
+};
+
+/* Note that if unification fails the new blob is reclaimed by AGC */
+
+static int
+unify_numarray(term_t t, numarray *a)
+{ return PL_unify_blob(t, a, sizeof(*a), &numarray_blob);
+}
+
+static int
+is_numarray(term_t t, numarray **ap)
+{ void *p;
+  PL_blob_t *type;
+
+  if ( PL_get_blob(t, &p, NULL, &type) && type == &numarray_blob )
+  { *ap = p;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+static int
+get_numarray(term_t t, numarray **ap)
+{ if ( is_numarray(t, ap) )
+    return TRUE;
+
+  return PL_type_error("numeric_array", t);
+}
+
+static int
+get_numarray_type(term_t t, na_type *type)
+{ atom_t name;
+
+  if ( !PL_get_atom_ex(t, &name) )
+    return FALSE;
+
+  if ( name == ATOM_int64 )
+    *type = NA_INT64;
+  else if ( name == ATOM_float64 )
+    *type = NA_FLOAT64;
+  else
+  { PL_domain_error("numeric_array_type", t);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static double *
+float_data(numarray *a, double **tmp)
+{ if ( a->type == NA_FLOAT64 )
+    return a->data.f;
+
+  if ( (*tmp = malloc((a->size ? a->size : 1)*sizeof(double))) )
+  { double *f = *tmp;
+    const int64_t *i = a->data.i;
+
+    for(size_t n=0; n<a->size; n++)
+      f[n] = (double)i[n];
+  } else
+    PL_no_memory();
+
+  return *tmp;
+}
+
+
+		 /*******************************
+		 *	      KERNELS		*
+		 *******************************/
+
+typedef enum
+{ NA_VV,				/* array op array */
+  NA_VS,				/* array op scalar */
+  NA_SV					/* scalar op array */
+} na_shape;
+
+typedef enum
+{ NA_ADD = 0,
+  NA_SUB,
+  NA_MUL,
+  NA_DIV,
+  NA_MIN,
+  NA_MAX,
+  NA_LT,
+  NA_LE,
+  NA_GT,
+  NA_GE,
+  NA_EQ,
+  NA_NE
+} na_op;
+
+#define NA_LOOP(r, n, shape, x, y, a, b, expr)	\
+	switch(shape)				\
+	{ case NA_VV:				\
+	    for(size_t i=0; i<n; i++)		\
+	    { x = a[i]; y = b[i];		\
+	      r[i] = (expr);			\
+	    }					\
+	    break;				\
+	  case NA_VS:				\
+	    y = b[0];				\
+	    for(size_t i=0; i<n; i++)		\
+	    { x = a[i];				\
+	      r[i] = (expr);			\
+	    }					\
+	    break;				\
+	  case NA_SV:				\
+	    x = a[0];				\
+	    for(size_t i=0; i<n; i++)		\
+	    { y = b[i];				\
+	      r[i] = (expr);			\
+	    }					\
+	    break;				\
+	}
+
+static void
+float_kernel(na_op op, na_shape shape, size_t n,
+	     double *restrict r, const double *a, const double *b)
+{ double x, y;
+
+  switch(op)
+  { case NA_ADD: NA_LOOP(r, n, shape, x, y, a, b, x+y); break;
+    case NA_SUB: NA_LOOP(r, n, shape, x, y, a, b, x-y); break;
+    case NA_MUL: NA_LOOP(r, n, shape, x, y, a, b, x*y); break;
+    case NA_DIV: NA_LOOP(r, n, shape, x, y, a, b, x/y); break;
+    case NA_MIN: NA_LOOP(r, n, shape, x, y, a, b, x<y ? x : y); break;
+    case NA_MAX: NA_LOOP(r, n, shape, x, y, a, b, x>y ? x : y); break;
+    default:
+      assert(0);
+  }
+}
+
+static void
+float_compare_kernel(na_op op, na_shape shape, size_t n,
+		     int64_t *restrict r, const double *a, const double *b)
+{ double x, y;
+
+  switch(op)
+  { case NA_LT: NA_LOOP(r, n, shape, x, y, a, b, x <  y); break;
+    case NA_LE: NA_LOOP(r, n, shape, x, y, a, b, x <= y); break;
+    case NA_GT: NA_LOOP(r, n, shape, x, y, a, b, x >  y); break;
+    case NA_GE: NA_LOOP(r, n, shape, x, y, a, b, x >= y); break;
+    case NA_EQ: NA_LOOP(r, n, shape, x, y, a, b, x == y); break;
+    case NA_NE: NA_LOOP(r, n, shape, x, y, a, b, x != y); break;
+    default:
+      assert(0);
+  }
+}
+
+static void
+int_compare_kernel(na_op op, na_shape shape, size_t n,
+		   int64_t *restrict r, const int64_t *a, const int64_t *b)
+{ int64_t x, y;
+
+  switch(op)
+  { case NA_LT: NA_LOOP(r, n, shape, x, y, a, b, x <  y); break;
+    case NA_LE: NA_LOOP(r, n, shape, x, y, a, b, x <= y); break;
+    case NA_GT: NA_LOOP(r, n, shape, x, y, a, b, x >  y); break;
+    case NA_GE: NA_LOOP(r, n, shape, x, y, a, b, x >= y); break;
+    case NA_EQ: NA_LOOP(r, n, shape, x, y, a, b, x == y); break;
+    case NA_NE: NA_LOOP(r, n, shape, x, y, a, b, x != y); break;
+    default:
+      assert(0);
+  }
+}
+
+/* The checked builtins were introduced together; HAVE___BUILTIN_MUL_OVERFLOW
+   implies __builtin_add_overflow() and __builtin_sub_overflow().
+*/
+
+static inline int
+add_overflow(int64_t x, int64_t y, int64_t *r)
+{
+#if HAVE___BUILTIN_MUL_OVERFLOW
+  return __builtin_add_overflow(x, y, r);
+#else
+  *r = (int64_t)((uint64_t)x+(uint64_t)y);
+  return ((x ^ *r) & (y ^ *r)) < 0;
+#endif
+}
+
+static inline int
+sub_overflow(int64_t x, int64_t y, int64_t *r)
+{
+#if HAVE___BUILTIN_MUL_OVERFLOW
+  return __builtin_sub_overflow(x, y, r);
+#else
+  *r = (int64_t)((uint64_t)x-(uint64_t)y);
+  return ((x ^ y) & (x ^ *r)) < 0;
+#endif
+}
+
+static inline int
+mul_overflow(int64_t x, int64_t y, int64_t *r)
+{
+#if HAVE___BUILTIN_MUL_OVERFLOW
+  return __builtin_mul_overflow(x, y, r);
+#else
+  *r = (int64_t)((uint64_t)x*(uint64_t)y);
+  return x != 0 && ( (x == -1 && y == INT64_MIN) || *r/x != y );
+#endif
+}
+
+/* Returns FALSE on integer overflow */
+
+static int
+int_kernel(na_op op, na_shape shape, size_t n,
+	   int64_t *restrict r, const int64_t *a, const int64_t *b)
+{ int64_t x, y;
+  int ovf = 0;
+
+  switch(op)
+  { case NA_ADD:
+      NA_LOOP(r, n, shape, x, y, a, b,
+	      (ovf |= add_overflow(x, y, &r[i]), r[i]));
+      break;
+    case NA_SUB:
+      NA_LOOP(r, n, shape, x, y, a, b,
+	      (ovf |= sub_overflow(x, y, &r[i]), r[i]));
+      break;
+    case NA_MUL:
+      NA_LOOP(r, n, shape, x, y, a, b,
+	      (ovf |= mul_overflow(x, y, &r[i]), r[i]));
+      break;
+    case NA_MIN: NA_LOOP(r, n, shape, x, y, a, b, x<y ? x : y); break;
+    case NA_MAX: NA_LOOP(r, n, shape, x, y, a, b, x>y ? x : y); break;
+    default:
+      assert(0);
+  }
+
+  return !ovf;
+}
+
+
+		 /*******************************
+		 *	     REDUCTIONS		*
+		 *******************************/
+
+static double
+sum_float(const double *a, size_t n)
+{ double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t i = 0;
+
+  for(; i+4 <= n; i += 4)
+  { s0 += a[i];
+    s1 += a[i+1];
+    s2 += a[i+2];
+    s3 += a[i+3];
+  }
+  for(; i < n; i++)
+    s0 += a[i];
+
+  return (s0+s1)+(s2+s3);
+}
+
+static double
+sum_int_as_float(const int64_t *a, size_t n)
+{ double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t i = 0;
+
+  for(; i+4 <= n; i += 4)
+  { s0 += (double)a[i];
+    s1 += (double)a[i+1];
+    s2 += (double)a[i+2];
+    s3 += (double)a[i+3];
+  }
+  for(; i < n; i++)
+    s0 += (double)a[i];
+
+  return (s0+s1)+(s2+s3);
+}
+
+static double
+dot_float(const double *a, const double *b, size_t n)
+{ double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t i = 0;
+
+  for(; i+4 <= n; i += 4)
+  { s0 += a[i]*b[i];
+    s1 += a[i+1]*b[i+1];
+    s2 += a[i+2]*b[i+2];
+    s3 += a[i+3]*b[i+3];
+  }
+  for(; i < n; i++)
+    s0 += a[i]*b[i];
+
+  return (s0+s1)+(s2+s3);
+}
+
+/* Add `i` to `r`, promoting to a big integer if needed */
+
+static int
+add_int_number(Number r, int64_t i)
+{ number n, sum;
+
+  if ( r->type == V_INTEGER &&
+       !add_overflow(r->value.i, i, &n.value.i) )
+  { r->value.i = n.value.i;
+    return TRUE;
+  }
+
+  n.type = V_INTEGER;
+  n.value.i = i;
+  if ( pl_ar_add(r, &n, &sum) )
+  { clearNumber(r);
+    *r = sum;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+static int
+sum_int(const int64_t *a, size_t n, Number r)
+{ r->type = V_INTEGER;
+  r->value.i = 0;
+
+  for(size_t i=0; i<n; i++)
+  { if ( !add_int_number(r, a[i]) )
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static int
+dot_int(const int64_t *a, const int64_t *b, size_t n, Number r)
+{ r->type = V_INTEGER;
+  r->value.i = 0;
+
+  for(size_t i=0; i<n; i++)
+  { int64_t p;
+
+    if ( !mul_overflow(a[i], b[i], &p) )
+    { if ( !add_int_number(r, p) )
+	return FALSE;
+    } else
+    { number na, nb, prod, sum;
+
+      na.type = nb.type = V_INTEGER;
+      na.value.i = a[i];
+      nb.value.i = b[i];
+      if ( !ar_mul(&na, &nb, &prod) )
+	return FALSE;
+      if ( !pl_ar_add(r, &prod, &sum) )
+      { clearNumber(&prod);
+	return FALSE;
+      }
+      clearNumber(&prod);
+      clearNumber(r);
+      *r = sum;
+    }
+  }
+
+  return TRUE;
+}
+
+#define get_numarray_arg(p, ap) LDFUNC(get_numarray_arg, p, ap)
+
+static int
+get_numarray_arg(DECL_LD Word p, numarray **ap)
+{ PL_blob_t *type;
+  void *data;
+
+  deRef(p);
+  if ( isAtom(*p) &&
+       (data = PL_blob_data(word2atom(*p), NULL, &type)) &&
+       type == &numarray_blob )
+  { *ap = data;
+    return TRUE;
+  }
+
+  if ( isVar(*p) )
+    return PL_error(NULL, 0, NULL, ERR_INSTANTIATION);
+
+  PL_error(NULL, 0, NULL, ERR_TYPE, ATOM_numeric_array, pushWordAsTermRef(p));
+  popTermRef();
+  return FALSE;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+evalNumArrayFunction() evaluates  one of  the  reductions sum/1, mean/1,
+min/1, max/1 or dot/2 for  evalExpression().  `f`  is the compound term
+whose arithmetic function satisfies isNumArrayFunction().
+
+ar_numarray1() and ar_numarray2() are   the  entries of these reductions
+in the arithmetic function table.   They   are  never called with numbers
+as evalExpression() and the compiler handle the reductions themselves.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+ar_numarray1(Number n1, Number r)
+{ (void)n1;
+  (void)r;
+
+  return PL_error(NULL, 0, NULL, ERR_NOT_IMPLEMENTED,
+		  "compiled numeric array reduction");
+}
+
+int
+ar_numarray2(Number n1, Number n2, Number r)
+{ (void)n2;
+
+  return ar_numarray1(n1, r);
+}
+
+int
+evalNumArrayFunction(DECL_LD Functor f, Number r)
+{ functor_t fd = f->definition;
+  numarray *a;
+
+  if ( !get_numarray_arg(&f->arguments[0], &a) )
+    return FALSE;
+
+  if ( fd == FUNCTOR_sum1 )
+  { if ( a->type == NA_INT64 )
+      return sum_int(a->data.i, a->size, r);
+    r->type = V_FLOAT;
+    r->value.f = sum_float(a->data.f, a->size);
+  } else if ( fd == FUNCTOR_mean1 )
+  { if ( a->size == 0 )
+      return PL_error("mean", 1, NULL, ERR_AR_UNDEF);
+    r->type = V_FLOAT;
+    r->value.f = ( a->type == NA_INT64 ? sum_int_as_float(a->data.i, a->size)
+				       : sum_float(a->data.f, a->size) )
+		 / (double)a->size;
+  } else if ( fd == FUNCTOR_min1 || fd == FUNCTOR_max1 )
+  { int max = (fd == FUNCTOR_max1);
+
+    if ( a->size == 0 )
+      return PL_error(max ? "max" : "min", 1, NULL, ERR_AR_UNDEF);
+    if ( a->type == NA_INT64 )
+    { const int64_t *d = a->data.i;
+      int64_t m = d[0];
+
+      if ( max )
+      { for(size_t i=1; i<a->size; i++)
+	  m = d[i] > m ? d[i] : m;
+      } else
+      { for(size_t i=1; i<a->size; i++)
+	  m = d[i] < m ? d[i] : m;
+      }
+      r->type = V_INTEGER;
+      r->value.i = m;
+      return TRUE;
+    } else
+    { const double *d = a->data.f;
+      double m = d[0];
+
+      if ( max )
+      { for(size_t i=1; i<a->size; i++)
+	  m = d[i] > m ? d[i] : m;
+      } else
+      { for(size_t i=1; i<a->size; i++)
+	  m = d[i] < m ? d[i] : m;
+      }
+      r->type = V_FLOAT;
+      r->value.f = m;
+    }
+  } else if ( fd == FUNCTOR_vdot2 )
+  { numarray *b;
+    double *fa, *fb, *ta = NULL, *tb = NULL;
+
+    if ( !get_numarray_arg(&f->arguments[1], &b) )
+      return FALSE;
+    if ( a->size != b->size )
+    { PL_error("dot", 2, "arrays differ in size",
+	       ERR_DOMAIN, ATOM_numeric_array,
+	       pushWordAsTermRef(&f->arguments[1]));
+      popTermRef();
+      return FALSE;
+    }
+    if ( a->type == NA_INT64 && b->type == NA_INT64 )
+      return dot_int(a->data.i, b->data.i, a->size, r);
+
+    if ( !(fa = float_data(a, &ta)) ||
+	 !(fb = float_data(b, &tb)) )
+    { free(ta);
+      return FALSE;
+    }
+    r->type = V_FLOAT;
+    r->value.f = dot_float(fa, fb, a->size);
+    free(ta);
+    free(tb);
+  } else
+  { assert(0);
+    return FALSE;
+  }
+
+  return check_float(r);
+}
+
+
+		 /*******************************
+		 *	     PREDICATES		*
+		 *******************************/
+
+/** numarray_from_list(?Type, +List, -Array)
+ *
+ * If Type is unbound it is float64 if List contains a float and int64
+ * otherwise.
+ */
+
+static
+PRED_IMPL("numarray_from_list", 3, numarray_from_list, 0)
+{ PRED_LD
+  size_t len;
+  na_type type;
+  numarray *a;
+  term_t tail = PL_copy_term_ref(A2);
+  term_t head = PL_new_term_ref();
+
+  switch(PL_skip_list(A2, 0, &len))
+  { case PL_LIST:
+      break;
+    case PL_PARTIAL_LIST:
+      return PL_instantiation_error(A2);
+    default:
+      return PL_type_error("list", A2);
+  }
+
+  if ( PL_is_variable(A1) )
+  { type = NA_INT64;
+    while( PL_get_list(tail, head, tail) )
+    { if ( PL_is_float(head) )
+      { type = NA_FLOAT64;
+	break;
+      }
+    }
+    if ( !PL_unify_atom(A1, type == NA_INT64 ? ATOM_int64 : ATOM_float64) )
+      return FALSE;
+    PL_put_term(tail, A2);
+  } else if ( !get_numarray_type(A1, &type) )
+  { return FALSE;
+  }
+
+  if ( !(a = alloc_numarray(type, len)) )
+    return FALSE;
+
+  for(size_t i=0; PL_get_list(tail, head, tail); i++)
+  { int rc;
+
+    if ( type == NA_INT64 )
+      rc = PL_get_int64_ex(head, &a->data.i[i]);
+    else
+      rc = PL_get_float_ex(head, &a->data.f[i]);
+
+    if ( !rc )
+    { free(a);
+      return FALSE;
+    }
+  }
+
+  return unify_numarray(A3, a);
+}
+
+
+static
+PRED_IMPL("numarray_to_list", 2, numarray_to_list, 0)
+{ PRED_LD
+  numarray *a;
+  term_t tail = PL_copy_term_ref(A2);
+  term_t head = PL_new_term_ref();
+
+  if ( !get_numarray(A1, &a) )
+    return FALSE;
+
+  for(size_t i=0; i<a->size; i++)
+  { if ( !PL_unify_list(tail, head, tail) ||
+	 !( a->type == NA_INT64 ? PL_unify_int64(head, a->data.i[i])
+				: PL_unify_float(head, a->data.f[i]) ) )
+      return FALSE;
+  }
+
+  return PL_unify_nil(tail);
+}
+
+
+static
+PRED_IMPL("numarray_size", 2, numarray_size, 0)
+{ numarray *a;
+
+  return ( get_numarray(A1, &a) &&
+	   PL_unify_int64(A2, a->size) );
+}
+
+
+static
+PRED_IMPL("numarray_type", 2, numarray_type, 0)
+{ numarray *a;
+
+  return ( get_numarray(A1, &a) &&
+	   PL_unify_atom(A2, a->type == NA_INT64 ? ATOM_int64 : ATOM_float64) );
+}
+
+
+/** numarray_get(+Array, +Index, -Value)
+ *
+ * Index is 0-based.  Fails silently if Index is out of range.
+ */
+
+static
+PRED_IMPL("numarray_get", 3, numarray_get, 0)
+{ numarray *a;
+  int64_t i;
+
+  if ( !get_numarray(A1, &a) ||
+       !PL_get_int64_ex(A2, &i) )
+    return FALSE;
+
+  if ( i < 0 || (uint64_t)i >= a->size )
+    return FALSE;
+
+  if ( a->type == NA_INT64 )
+    return PL_unify_int64(A3, a->data.i[i]);
+  else
+    return PL_unify_float(A3, a->data.f[i]);
+}
+
+
+typedef struct na_operand
+{ numarray     *array;			/* Array or NULL if scalar */
+  na_type	type;			/* Type of the data */
+  size_t	size;			/* # elements */
+  union
+  { int64_t	i;
+    double	f;
+  } scalar;				/* Value if scalar */
+} na_operand;
+
+#define get_operand(t, op) LDFUNC(get_operand, t, op)
+
+static int
+get_operand(DECL_LD term_t t, na_operand *op)
+{ number n;
+  int rc = TRUE;
+
+  if ( is_numarray(t, &op->array) )
+  { op->type = op->array->type;
+    op->size = op->array->size;
+    return TRUE;
+  }
+
+  if ( !valueExpression(t, &n) )
+    return FALSE;
+  op->array = NULL;
+  op->size  = 1;
+  switch(n.type)
+  { case V_INTEGER:
+      op->type = NA_INT64;
+      op->scalar.i = n.value.i;
+      break;
+    case V_FLOAT:
+      op->type = NA_FLOAT64;
+      op->scalar.f = n.value.f;
+      break;
+#ifdef O_BIGNUM
+    case V_MPZ:
+      op->type = NA_INT64;
+      if ( !mpz_to_int64(n.value.mpz, &op->scalar.i) )
+	rc = PL_error(NULL, 0, NULL, ERR_EVALUATION, ATOM_int_overflow);
+      clearNumber(&n);
+      break;
+#endif
+    default:
+      if ( (rc=promoteToFloatNumber(&n)) )
+      { op->type = NA_FLOAT64;
+	op->scalar.f = n.value.f;
+      }
+      clearNumber(&n);
+  }
+
+  return rc;
+}
+
+static const void *
+operand_data(na_operand *op)
+{ if ( op->array )
+    return op->type == NA_INT64 ? (void*)op->array->data.i
+				: (void*)op->array->data.f;
+  return &op->scalar;
+}
+
+static const double *
+operand_float_data(na_operand *op, double **tmp)
+{ if ( op->type == NA_FLOAT64 )
+    return operand_data(op);
+  if ( !op->array )
+  { op->scalar.f = (double)op->scalar.i;
+    op->type = NA_FLOAT64;
+    return &op->scalar.f;
+  }
+
+  return float_data(op->array, tmp);
+}
+
+static na_op
+get_na_op(atom_t name)
+{ if ( name == ATOM_plus )	    return NA_ADD;
+  if ( name == ATOM_minus )	    return NA_SUB;
+  if ( name == ATOM_star )	    return NA_MUL;
+  if ( name == ATOM_divide )	    return NA_DIV;
+  if ( name == ATOM_min )	    return NA_MIN;
+  if ( name == ATOM_max )	    return NA_MAX;
+  if ( name == ATOM_smaller )	    return NA_LT;
+  if ( name == ATOM_smaller_equal ) return NA_LE;
+  if ( name == ATOM_larger )	    return NA_GT;
+  if ( name == ATOM_larger_equal )  return NA_GE;
+  if ( name == ATOM_ar_equals )	    return NA_EQ;
+  if ( name == ATOM_ar_not_equal )  return NA_NE;
+
+  return (na_op)-1;
+}
+
+#define elementwise(op, A, B, R, compare) \
+	LDFUNC(elementwise, op, A, B, R, compare)
+
+static int
+elementwise(DECL_LD term_t op, term_t A, term_t B, term_t R, int compare)
+{ atom_t name;
+  na_op nop;
+  na_operand a, b;
+  na_shape shape;
+  size_t size;
+  numarray *r;
+  double *ta = NULL, *tb = NULL;
+  int rc;
+
+  if ( !PL_get_atom_ex(op, &name) )
+    return FALSE;
+  nop = get_na_op(name);
+  if ( (int)nop < 0 || (nop >= NA_LT) != compare )
+    return PL_domain_error(compare ? "numarray_compare_op" : "numarray_op",
+			   op);
+
+  if ( !get_operand(A, &a) ||
+       !get_operand(B, &b) )
+    return FALSE;
+
+  if ( a.array && b.array )
+  { if ( a.size != b.size )
+      return PL_domain_error("numeric_array_size", B);
+    shape = NA_VV;
+    size = a.size;
+  } else if ( a.array )
+  { shape = NA_VS;
+    size = a.size;
+  } else if ( b.array )
+  { shape = NA_SV;
+    size = b.size;
+  } else
+  { return PL_type_error("numeric_array", A);
+  }
+
+  if ( compare )
+  { if ( !(r = alloc_numarray(NA_INT64, size)) )
+      return FALSE;
+    if ( a.type == NA_INT64 && b.type == NA_INT64 )
+    { int_compare_kernel(nop, shape, size, r->data.i,
+			 operand_data(&a), operand_data(&b));
+    } else
+    { const double *fa, *fb;
+
+      if ( !(fa = operand_float_data(&a, &ta)) ||
+	   !(fb = operand_float_data(&b, &tb)) )
+      { rc = FALSE;
+	goto out;
+      }
+      float_compare_kernel(nop, shape, size, r->data.i, fa, fb);
+    }
+  } else if ( a.type == NA_INT64 && b.type == NA_INT64 && nop != NA_DIV )
+  { if ( !(r = alloc_numarray(NA_INT64, size)) )
+      return FALSE;
+    if ( !int_kernel(nop, shape, size, r->data.i,
+		     operand_data(&a), operand_data(&b)) )
+    { free(r);
+      return PL_error(NULL, 0, NULL, ERR_EVALUATION, ATOM_int_overflow);
+    }
+  } else
+  { const double *fa, *fb;
+
+    if ( !(r = alloc_numarray(NA_FLOAT64, size)) )
+      return FALSE;
+    if ( !(fa = operand_float_data(&a, &ta)) ||
+	 !(fb = operand_float_data(&b, &tb)) )
+    { rc = FALSE;
+      goto out;
+    }
+    float_kernel(nop, shape, size, r->data.f, fa, fb);
+  }
+
+  free(ta);
+  free(tb);
+  return unify_numarray(R, r);
+
+out:
+  free(ta);
+  free(tb);
+  free(r);
+  return rc;
+}
+
+
+/** numarray_op(+Op, +A, +B, -Result)
+ *
+ * Elementwise Op on A and B.  Either may be a number.
+ */
+
+static
+PRED_IMPL("numarray_op", 4, numarray_op, 0)
+{ PRED_LD
+
+  return elementwise(A1, A2, A3, A4, FALSE);
+}
+
+
+/** numarray_compare(+Op, +A, +B, -Mask)
+ */
+
+static
+PRED_IMPL("numarray_compare", 4, numarray_compare, 0)
+{ PRED_LD
+
+  return elementwise(A1, A2, A3, A4, TRUE);
+}
+
+
+/** numarray_read(+Stream, +Type, ?Count, -Array)
+ *
+ * Read Count elements in native byte order from Stream.  If Count is
+ * unbound, read up to the end of the file.
+ */
+
+static
+PRED_IMPL("numarray_read", 4, numarray_read, 0)
+{ PRED_LD
+  IOSTREAM *s;
+  na_type type;
+  int64_t count = -1;
+  numarray *a;
+  size_t n;
+
+  if ( !get_numarray_type(A2, &type) )
+    return FALSE;
+  if ( !PL_is_variable(A3) )
+  { if ( !PL_get_int64_ex(A3, &count) )
+      return FALSE;
+    if ( count < 0 )
+      return PL_domain_error("not_less_than_zero", A3);
+  }
+
+  if ( !(a = alloc_numarray(type, count >= 0 ? (size_t)count : 1024)) )
+    return FALSE;
+  if ( !PL_get_stream(A1, &s, SIO_INPUT) )
+  { free(a);
+    return FALSE;
+  }
+
+  for(n=0;;)
+  { n += Sfread(&a->data.i[n], sizeof(int64_t), a->size-n, s);
+    if ( n < a->size || count >= 0 )
+      break;
+
+    numarray *na = realloc(a, offsetof(numarray, data) +
+			      a->size*2*sizeof(int64_t));
+    if ( !na )
+    { free(a);
+      PL_release_stream(s);
+      return PL_no_memory();
+    }
+    a = na;
+    a->size *= 2;
+  }
+
+  if ( !PL_release_stream(s) )
+  { free(a);
+    return FALSE;
+  }
+  if ( n < a->size )
+  { if ( count >= 0 )
+    { free(a);
+      return PL_syntax_error("end_of_file", NULL);
+    }
+    a->size = n;
+  }
+
+  return ( PL_unify_int64(A3, a->size) &&
+	   unify_numarray(A4, a) );
+}
+
+
+/** numarray_write(+Stream, +Array)
+ *
+ * Write the elements of Array in native byte order to Stream.
+ */
+
+static
+PRED_IMPL("numarray_write", 2, numarray_write, 0)
+{ IOSTREAM *s;
+  numarray *a;
+
+  if ( !get_numarray(A2, &a) ||
+       !PL_get_stream(A1, &s, SIO_OUTPUT) )
+    return FALSE;
+
+  Sfwrite(a->data.i, sizeof(int64_t), a->size, s);
+
+  return PL_release_stream(s);
+}
+
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(numarray)
+  PRED_DEF("numarray_from_list", 3, numarray_from_list, 0)
+  PRED_DEF("numarray_to_list",   2, numarray_to_list,   0)
+  PRED_DEF("numarray_size",      2, numarray_size,      0)
+  PRED_DEF("numarray_type",      2, numarray_type,      0)
+  PRED_DEF("numarray_get",       3, numarray_get,       0)
+  PRED_DEF("numarray_op",        4, numarray_op,        0)
+  PRED_DEF("numarray_compare",   4, numarray_compare,   0)
+  PRED_DEF("numarray_read",      4, numarray_read,      0)
+  PRED_DEF("numarray_write",     2, numarray_write,     0)
+EndPredDefs
@@ -2576,6 +2576,8 @@ setarg(DECL_LD term_t n, term_t term, term_t value, int flags)
 					/* assignment must *not* be trailed */
   v = valTermRef(value);
   unify_vp(a, v);
+  if ( !(flags & SETARG_BACKTRACKABLE) && a < LD->gen_bar )
+    gcAssignedOld(a);
 
   return TRUE;
 }
@@ -5831,6 +5833,8 @@ swi_statistics(DECL_LD atom_t key, Number v)
     v->value.f = LD->gc.stats.totals.time;
   } else if (key == ATOM_collections)
     v->value.i = LD->gc.stats.totals.collections;
+  else if (key == ATOM_minor_collections)
+    v->value.i = LD->gc.stats.totals.minor_collections;
   else if (key == ATOM_collected)
     v->value.i = LD->gc.stats.totals.trail_gained +
 		 LD->gc.stats.totals.global_gained;
@@ -5844,18 +5848,31 @@ swi_statistics(DECL_LD atom_t key, Number v)
   else if (key == ATOM_agc_time)
   { v->type = V_FLOAT;
     v->value.f = GD->atoms.gc_time;
-  }
+  } else if (key == ATOM_agc_yields)
+    v->value.i = GD->atoms.gc_yields;
 #endif
 #ifdef O_CLAUSEGC
   else if (key == ATOM_cgc)
     v->value.i = GD->clauses.cgc_count;
   else if (key == ATOM_cgc_gained)
     v->value.i = GD->clauses.cgc_reclaimed;
+  else if (key == ATOM_cgc_pending)
+    v->value.i = GD->clauses.cgc_pending;
   else if (key == ATOM_cgc_time)
   { v->type = V_FLOAT;
     v->value.f = GD->clauses.cgc_time;
   }
+  else if (key == ATOM_erased_space)
+    v->value.i = GD->clauses.erased_size;
 #endif
+  else if (key == ATOM_slab_space)
+    v->value.i = GD->statistics.slab_space;
+  else if (key == ATOM_slab_free)
+    v->value.i = slabFreeSpace();
+  else if (key == ATOM_retired_objects)
+    v->value.i = GD->statistics.retired;
+  else if (key == ATOM_reclaimed_objects)
+    v->value.i = GD->statistics.reclaimed;
   else if (key == ATOM_global_shifts)
     v->value.i = LD->shift_status.global_shifts;
   else if (key == ATOM_local_shifts)
@@ -5880,6 +5897,8 @@ swi_statistics(DECL_LD atom_t key, Number v)
 		 GD->statistics.engines_created;
   else if ( key == ATOM_engines_created )
     v->value.i = GD->statistics.engines_created;
+  else if ( key == ATOM_engines_reused )
+    v->value.i = GD->statistics.engines_reused;
   else if ( key == ATOM_thread_cputime )
   { v->type = V_FLOAT;
     v->value.f = GD->statistics.thread_cputime;
@@ -5892,7 +5911,9 @@ swi_statistics(DECL_LD atom_t key, Number v)
       v->value.i = pool->size;
     else
       v->value.i = 0;
-  } else if (key == ATOM_indexes_created)
+  } else if (key == ATOM_private_heap)
+    v->value.i = threadHeapUsed();
+  else if (key == ATOM_indexes_created)
     v->value.i = GD->statistics.indexes.created;
   else if (key == ATOM_indexes_destroyed)
     v->value.i = GD->statistics.indexes.destroyed;
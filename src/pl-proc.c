@@ -180,6 +180,32 @@ lingerDefinition(Definition def)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+retireDefinitionData() retires data of a predicate that may still be in
+use by other threads: index tables, clause lists and supervisors. This
+is epoch based reclamation using the  global generation as epoch.  The
+object is stamped with the  current generation  and added  to the
+lingering list of the predicate.   The predicate is  registered  with
+clause GC, which finds the oldest generation in which a thread can still
+access the predicate from  its  stacks  or predicate references.  Once
+all threads have passed this point, i.e., the oldest  active generation
+is newer than the stamp, the object is freed.
+
+Before, the lingering  list was only processed if  the predicate had
+erased clauses, so predicates whose indexes or supervisor were replaced
+kept their old versions until the predicate was destroyed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+retireDefinitionData(Definition def, void (*unalloc)(void *), void *obj)
+{ GET_LD
+
+  linger_always(&def->lingering, unalloc, obj);
+  if ( HAS_LD && GD->cleaning == CLN_NORMAL )
+    registerDirtyDefinition(def);
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 destroyDefinition() is called to destroy predicates from destroyModule()
 as well as destroying thread-local  instantiations   while  a  thread is
@@ -1215,7 +1241,7 @@ release_clause(Clause cl)
 
 ClauseRef
 newClauseRef(Clause clause, word key)
-{ ClauseRef cref = allocHeapOrHalt(SIZEOF_CREF_CLAUSE);
+{ ClauseRef cref = allocSlab(SIZEOF_CREF_CLAUSE);
 
   DEBUG(MSG_CGC_CREF_PL,
 	Sdprintf("/**/ a(%p, %p, %d, '%s').\n",
@@ -1241,7 +1267,7 @@ freeClauseRef(ClauseRef cref)
 
   release_clause(cl);
 
-  freeHeap(cref, SIZEOF_CREF_CLAUSE);
+  freeSlab(cref, SIZEOF_CREF_CLAUSE);
 }
 
 
@@ -1409,6 +1435,11 @@ assertDefinition(DECL_LD Definition def, Clause clause, ClauseRef where)
   { freeClause(clause);
     return NULL;
   }
+  if ( true(def, P_LOCALISED) &&
+       !chargeThreadHeap(sizeofClause(clause->code_size) + SIZEOF_CREF_CLAUSE) )
+  { freeClause(clause);
+    return PL_no_memory(),NULL;
+  }
 
   argKey(clause->codes, 0, &key);
   if ( !(cref=newClauseRef(clause, key)) )
@@ -1449,6 +1480,8 @@ assertDefinition(DECL_LD Definition def, Clause clause, ClauseRef where)
     def->impl.clauses.number_of_rules++;
   if ( true(def, P_DIRTYREG) )
     ATOMIC_INC(&GD->clauses.dirty);
+  ATOMIC_ADD(&def->clause_space,
+	     sizeofClause(clause->code_size) + SIZEOF_CREF_CLAUSE);
 
   if ( false(def, P_DYNAMIC|P_LOCKED_SUPERVISOR) ) /* see (*) above */
     freeCodesDefinition(def, TRUE);
@@ -1610,6 +1643,9 @@ removeClausesPredicate(Definition def, int sfindex, int fromfile)
     if ( deleted )
     { if ( def->module )
 	ATOMIC_SUB(&def->module->code_size, memory);
+      ATOMIC_SUB(&def->clause_space, memory);
+      if ( true(def, P_LOCALISED) )
+	releaseThreadHeap(memory);
       ATOMIC_ADD(&GD->clauses.erased_size, memory);
       ATOMIC_ADD(&GD->clauses.erased, deleted);
       if( true(def, P_DIRTYREG) )
@@ -1628,6 +1664,7 @@ removeClausesPredicate(Definition def, int sfindex, int fromfile)
     }
     def->impl.clauses.first_clause = NULL;
     def->impl.clauses.last_clause = NULL;
+    def->clause_space = 0;
   }
 
   return deleted;
@@ -1693,6 +1730,9 @@ retract_clause(DECL_LD Clause clause, gen_t generation)
     ATOMIC_INC(&GD->clauses.db_erased_refs);
 
   ATOMIC_SUB(&def->module->code_size, size);
+  ATOMIC_SUB(&def->clause_space, size);
+  if ( true(def, P_LOCALISED) )
+    releaseThreadHeap(size);
   ATOMIC_ADD(&GD->clauses.erased_size, size);
   ATOMIC_INC(&GD->clauses.erased);
   if( true(def, P_DIRTYREG) )
@@ -1738,13 +1778,13 @@ unallocClause(Clause c)
     releaseSourceFileNo(c->source_no);
   }
 
+  size_t size = sizeofClause(c->code_size);
 #ifdef ALLOC_DEBUG
 #define ALLOC_FREE_MAGIC 0xFB
-  size_t size = sizeofClause(c->code_size);
   memset(c, ALLOC_FREE_MAGIC, size);
 #endif
 
-  PL_free(c);
+  freeSlab(c, size);
 }
 
 static int
@@ -1964,6 +2004,7 @@ reconsultFinalizePredicate(DECL_LD sf_reload *rl, Definition def, p_reload *r)
 
     if ( deleted )
     { ATOMIC_SUB(&def->module->code_size, memory);
+      ATOMIC_SUB(&def->clause_space, memory);
       ATOMIC_ADD(&GD->clauses.erased_size, memory);
       ATOMIC_ADD(&GD->clauses.erased, deleted);
       if( true(def, P_DIRTYREG) )
@@ -2261,6 +2302,8 @@ CGC builds on the following components and invariants:
 	destroy the clause.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#define CGC_RETIRED_MAX 1000	/* see retireDefinitionData() */
+
 #define considerClauseGC(_) LDFUNC(considerClauseGC, _)
 static int
 considerClauseGC(DECL_LD)
@@ -2278,6 +2321,13 @@ considerClauseGC(DECL_LD)
     return TRUE;
   }
 
+  if ( GD->statistics.retired > GD->clauses.retired_last + CGC_RETIRED_MAX &&
+       GD->cleaning == CLN_NORMAL )
+  { DEBUG(MSG_CGC_CONSIDER,
+	  Sdprintf("CGC? %zd retired objects\n", GD->statistics.retired));
+    return TRUE;
+  }
+
   if ( LD->statistics.inferences > LD->clauses.cgc_inferences )
   { int rgc;
 
@@ -2385,6 +2435,7 @@ ddi_new(Definition def)
 
   ddi->predicate = def;
   ddi->flags = 0;
+  ddi->cgc_cycle = GD->clauses.cgc_cycle-1;	/* not yet visited */
   return ddi;
 }
 
@@ -2650,10 +2701,12 @@ may leave this predicate as non-dirty while it is dirty.
 static void
 maybeUnregisterDirtyDefinition(Definition def)
 { if ( true(def, P_DIRTYREG) &&
-       def->impl.clauses.erased_clauses == 0 )
+       def->impl.clauses.erased_clauses == 0 &&
+       !def->lingering )
   { LOCKDEF(def);			/* See (*) */
     if ( true(def, P_DIRTYREG) &&
-	 def->impl.clauses.erased_clauses == 0 )
+	 def->impl.clauses.erased_clauses == 0 &&
+	 !def->lingering )
       unregisterDirtyDefinition(def);
     UNLOCKDEF(def);
   }
@@ -2664,24 +2717,57 @@ maybeUnregisterDirtyDefinition(Definition def)
 
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+garbage_collect_clauses() is the actual clause garbage collector. If
+`max_pause` is non-zero, cleaning the dirty predicates is done in time
+slices: after marking, the predicates that need cleaning are sorted by
+the number of erased clauses and cleaned until the slice exceeds
+`max_pause` seconds.  Each predicate is cleaned at most once per CGC
+`cycle` (see DirtyDefInfo.cgc_cycle), so predicates whose garbage cannot
+yet be reclaimed cannot starve the others.  If candidates remain, we ask
+for another slice using signalGCThread().  A cycle ends when a slice
+handled all remaining candidates.
+
+Marking still scans all thread stacks in each slice.  This is required
+because threads may have started using the predicates between slices.
+
 (*) We set the initial generation to   GEN_MAX  to know which predicates
 have been marked. We can only reclaim   clauses  that were erased before
 the start generation of the clause garbage collector.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-foreign_t
-pl_garbage_collect_clauses(void)
+typedef struct cgc_candidate
+{ Definition	predicate;		/* Dirty predicate */
+  size_t	garbage;		/* # erased clauses */
+} cgc_candidate;
+
+static int
+compare_cgc_candidates(const void *p1, const void *p2)
+{ const cgc_candidate *c1 = p1;
+  const cgc_candidate *c2 = p2;
+
+  return ( c1->garbage < c2->garbage ?  1 :
+	   c1->garbage > c2->garbage ? -1 : 0 );
+}
+
+static int
+garbage_collect_clauses(double max_pause)
 { GET_LD
   int rc = TRUE;
+  int again = FALSE;
 
   if ( GD->procedures.dirty->size > 0 &&
        COMPARE_AND_SWAP_INT(&GD->clauses.cgc_active, FALSE, TRUE) )
   { size_t removed = 0;
     size_t erased_pending = GD->clauses.erased_size;
     double gct, t0 = ThreadCPUTime(CPU_USER);
+    double wall0 = WallTime();
     gen_t start_gen = global_generation();
+    unsigned int cycle = GD->clauses.cgc_cycle;
     int verbose = truePrologFlag(PLFLAG_TRACE_GC) && !LD->in_print_message;
     tmp_buffer tr_starts;
+    tmp_buffer candidates;
+    cgc_candidate *cv;
+    size_t i, ncandidates;
 
     if ( verbose )
     { if ( (rc=printMessage(ATOM_informational,
@@ -2718,9 +2804,38 @@ pl_garbage_collect_clauses(void)
 
     DEBUG(MSG_CGC, Sdprintf("(marking done)\n"));
 
+    initBuffer(&candidates);
     FOR_TABLE(GD->procedures.dirty, n, v)
     { Definition def = key2ptr(n);
       DirtyDefInfo ddi = val2ptr(v);
+      int erased = ( false(def, P_FOREIGN) &&
+		     def->impl.clauses.erased_clauses > 0 );
+
+      if ( erased || def->lingering )
+      { if ( max_pause == 0.0 || ddi->cgc_cycle != cycle )
+	{ cgc_candidate c = { def,
+			      erased ? def->impl.clauses.erased_clauses : 0 };
+	  addBuffer(&candidates, c, cgc_candidate);
+	}
+      } else
+      { maybeUnregisterDirtyDefinition(def);
+      }
+    }
+
+    cv = baseBuffer(&candidates, cgc_candidate);
+    ncandidates = entriesBuffer(&candidates, cgc_candidate);
+    if ( ncandidates > 1 )
+      qsort(cv, ncandidates, sizeof(*cv), compare_cgc_candidates);
+
+    for(i=0; i<ncandidates; i++)
+    { Definition def = cv[i].predicate;
+      DirtyDefInfo ddi;
+
+      if ( i > 0 && max_pause > 0.0 && WallTime() - wall0 > max_pause )
+	break;
+      if ( !(ddi = lookupHTablePP(GD->procedures.dirty, def)) )
+	continue;
+      ddi->cgc_cycle = cycle;
 
       if ( false(def, P_FOREIGN) &&
 	   def->impl.clauses.erased_clauses > 0 )
@@ -2736,17 +2851,33 @@ pl_garbage_collect_clauses(void)
 		       ddi_generation_name(ddi),
 		       del,
 		       (int)def->impl.clauses.erased_clauses));
+      } else if ( def->lingering )
+      { gen_t active = ddi_oldest_generation(ddi);
+
+	if ( start_gen < active )
+	  active = start_gen;
+	free_lingering(&def->lingering, active);
       }
 
       maybeUnregisterDirtyDefinition(def);
     }
 
+    GD->clauses.cgc_pending = ncandidates - i;
+    if ( i == ncandidates )
+      GD->clauses.cgc_cycle++;
+    else
+      again = TRUE;
+
+    discardBuffer(&candidates);
     discardBuffer(&tr_starts);
     gcClauseRefs();
+    trimSlabs();
     GD->clauses.cgc_count++;
     GD->clauses.cgc_reclaimed	+= removed;
     GD->clauses.cgc_time        += (gct=ThreadCPUTime(CPU_USER) - t0);
     GD->clauses.erased_size_last = GD->clauses.erased_size;
+    GD->clauses.retired_last     = GD->statistics.retired;
+    GC_TELEMETRY(cgc_pause, (WallTime() - wall0)*1000000.0);
 
     DEBUG(MSG_CGC, Sdprintf("CGC: removed %ld clauses "
 			    "(%ld bytes reclaimed, %ld pending) in %2f sec.\n",
@@ -2769,9 +2900,36 @@ pl_garbage_collect_clauses(void)
     GD->clauses.cgc_active = FALSE;
   }
 
+  if ( again )
+    signalGCThread(SIG_CLAUSE_GC);
+
   return rc;
 }
 
+
+foreign_t
+pl_garbage_collect_clauses(void)
+{ return garbage_collect_clauses(0.0);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+clauseGCSlice() runs CGC as requested by considerClauseGC().  It respects
+the flag `cgc_max_pause`.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+clauseGCSlice(void)
+{ return garbage_collect_clauses(GD->clauses.cgc_max_pause);
+}
+
+
+static
+PRED_IMPL("$cgc_slice", 0, cgc_slice, 0)
+{ return clauseGCSlice();
+}
+
+
 #endif /*O_CLAUSEGC*/
 
 #ifdef O_DEBUG
@@ -3564,6 +3722,46 @@ sizeof_predicate(Definition def)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+predicateMemory() adds the memory used by   `def`  to `mem`. Unlike
+sizeof_predicate() it does not walk the   clauses, but uses the counter
+def->clause_space that is maintained by   assertDefinition()  and the
+functions that erase clauses.  Erased clauses  that are not yet reclaimed
+are no longer accounted to the predicate,  but to the statistics/2 key
+`erased_space`.  Clauses of thread-local predicates are accounted to the
+threads.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+predicateMemory(Definition def, pred_memory *mem)
+{ mem->code += sizeof(*def) + sizeof_supervisor(def->codes);
+
+  if ( false(def, P_FOREIGN|P_THREAD_LOCAL) )
+  { mem->clauses += def->clause_space;
+    mem->indexes += sizeofClauseIndexes(def);
+  }
+}
+
+
+static
+PRED_IMPL("$predicate_memory", 2, predicate_memory, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Procedure proc;
+  pred_memory mem = {0};
+
+  if ( !get_procedure(A1, &proc, 0, GP_FIND) )
+    return FALSE;
+
+  predicateMemory(proc->definition, &mem);
+
+  return PL_unify_term(A2,
+		       PL_FUNCTOR_CHARS, "memory", 3,
+			 PL_INT64, (int64_t)mem.clauses,
+			 PL_INT64, (int64_t)mem.indexes,
+			 PL_INT64, (int64_t)mem.code);
+}
+
+
 static
 PRED_IMPL("$get_predicate_attribute", 3, get_predicate_attribute,
 	  PL_FA_TRANSPARENT)
@@ -4099,7 +4297,7 @@ PRED_IMPL("copy_predicate_clauses", 2, copy_predicate_clauses, PL_FA_TRANSPARENT
 
     if ( visibleClause(cl, generation) )
     { size_t size = sizeofClause(cl->code_size);
-      Clause copy = PL_malloc_atomic(size);
+      Clause copy = allocSlab(size);
 
       memcpy(copy, cl, size);
       copy->predicate = copy_def;
@@ -4228,6 +4426,10 @@ pl_list_generations(term_t desc)
 		 *******************************/
 
 BeginPredDefs(proc)
+  PRED_DEF("$predicate_memory", 2, predicate_memory, PL_FA_TRANSPARENT)
+#ifdef O_CLAUSEGC
+  PRED_DEF("$cgc_slice", 0, cgc_slice, 0)
+#endif
   PRED_DEF("retractall", 1, retractall, PL_FA_NONDETERMINISTIC|PL_FA_ISO)
   PRED_DEF("$set_predicate_attribute", 3, set_predicate_attribute,
 	   PL_FA_TRANSPARENT)
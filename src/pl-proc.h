@@ -40,6 +40,12 @@
 #ifndef _PL_PROC_H
 #define _PL_PROC_H
 
+typedef struct pred_memory
+{ size_t	clauses;		/* Live clauses and their references */
+  size_t	indexes;		/* Clause indexes and filters */
+  size_t	code;			/* Definition and supervisor */
+} pred_memory;
+
 		 /*******************************
 		 *    FUNCTION DECLARATIONS	*
 		 *******************************/
@@ -71,6 +77,8 @@ bool		isDefinedProcedure(Procedure proc);
 void		shareDefinition(Definition def);
 int		unshareDefinition(Definition def);
 void		lingerDefinition(Definition def);
+void		retireDefinitionData(Definition def,
+				     void (*unalloc)(void *), void *obj);
 void		setLastModifiedPredicate(Definition def, gen_t gen, int flags);
 int		get_head_functor(term_t head, functor_t *fdef,
 				 int flags);
@@ -121,6 +129,7 @@ foreign_t	pl_check_procedure(term_t desc);
 void		checkDefinition(Definition def);
 Procedure	isStaticSystemProcedure(functor_t fd);
 foreign_t	pl_garbage_collect_clauses(void);
+int		clauseGCSlice(void);
 int		setDynamicDefinition(Definition def, bool isdyn);
 int		setThreadLocalDefinition(Definition def, bool isdyn);
 int		setAttrDefinition(Definition def, uint64_t attr, int val);
@@ -131,6 +140,7 @@ int		ddi_is_garbage(DirtyDefInfo ddi,
 			       gen_t start, Buffer tr_starts,
 			       Clause cl);
 size_t		sizeof_predicate(Definition def);
+void		predicateMemory(Definition def, pred_memory *mem);
 
 #undef LDFUNC_DECLARATIONS
 
@@ -52,6 +52,7 @@
 #include "pl-prims.h"
 #include "pl-write.h"
 #include "pl-read.h"
+#include "pl-index.h"
 #include "os/pl-ctype.h"
 #ifdef HAVE_SYS_PARAM_H
 #include <sys/param.h>
@@ -151,6 +152,9 @@ Below is an informal description of the format of a `.qlf' file:
 			    <# prolog vars> <# vars>
 			    <is_fact>			% 0 or 1
 			    <#n subclause> <codes>
+		      | 'I' <#args> {<arg>}		% index layout
+			    <ln_buckets> <is_list>
+			    <speedup>			% double
 		      | 'X'				% end of list
 <XR>		::=	XR_REF     <num>		% XR id from table
 			XR_NIL				% []
@@ -1423,6 +1427,7 @@ loadPredicate(DECL_LD wic_state *state, int skip)
   Clause clause;
   functor_t f = (functor_t) loadXR(state);
   SourceFile csf = NULL;
+  tmp_buffer layouts;
 
   proc = lookupProcedureToDefine(f, LD->modules.source);
   DEBUG(MSG_QLF_PREDICATE, Sdprintf("Loading %s%s",
@@ -1442,16 +1447,39 @@ loadPredicate(DECL_LD wic_state *state, int skip)
     addProcedureSourceFile(state->currentSource, proc);
   }
   loadPredicateFlags(state, def, skip);
+  initBuffer(&layouts);
 
   for(;;)
   { switch(Qgetc(fd) )
     { case 'X':
       { DEBUG(MSG_QLF_PREDICATE, Sdprintf("ok\n"));
+	if ( !skip )
+	  restoreIndexLayouts(def, baseBuffer(&layouts, hash_hints),
+			      (int)entriesBuffer(&layouts, hash_hints));
+	discardBuffer(&layouts);
 	succeed;
       }
       case 'L':
 	loadInclude(state, FALSE);
 	continue;
+      case 'I':
+      { hash_hints h;
+	unsigned int i, nargs = qlfGetUInt32(fd);
+
+	memset(&h, 0, sizeof(h));
+	for(i=0; i<nargs; i++)
+	{ unsigned int arg = qlfGetUInt32(fd);
+
+	  if ( i < MAX_MULTI_INDEX )
+	    h.args[i] = (iarg_t)arg;
+	}
+	h.ln_buckets = qlfGetUInt32(fd);
+	h.list       = (qlfGetUInt32(fd) != 0);
+	h.speedup    = (float)qlfGetDouble(fd);
+	if ( nargs <= MAX_MULTI_INDEX && h.ln_buckets < 31 )
+	  addBuffer(&layouts, h, hash_hints);
+	continue;
+      }
       case 'C':
       { int has_dicts = 0;
 	tmp_buffer buf;
@@ -1698,7 +1726,7 @@ loadPredicate(DECL_LD wic_state *state, int skip)
 	  Clause bcl    = baseBuffer(&buf, struct clause);
 
 	  bcl->code_size = ncodes;
-	  clause = (Clause)PL_malloc_atomic(csize);
+	  clause = (Clause)allocSlab(csize);
 	  memcpy(clause, bcl, csize);
 
 	  if ( has_dicts )
@@ -2947,10 +2975,46 @@ saveWicClause(wic_state *state, Clause clause)
 		*         COMPILATION           *
 		*********************************/
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+If the Prolog flag `qlf_indexes` is set,   save the layout of the clause
+indexes of the predicate such that they are rebuilt when the predicate is
+loaded (see restoreIndexLayouts()).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define MAX_SAVED_INDEXES 16
+
+static void
+saveIndexLayouts(wic_state *state, Definition def)
+{ GET_LD
+
+  if ( truePrologFlag(PLFLAG_QLF_INDEXES) )
+  { IOSTREAM *fd = state->wicFd;
+    hash_hints layouts[MAX_SAVED_INDEXES];
+    int i, count = getIndexLayouts(def, layouts, MAX_SAVED_INDEXES);
+
+    for(i=0; i<count; i++)
+    { hash_hints *h = &layouts[i];
+      unsigned int n, nargs;
+
+      for(nargs=0; nargs<MAX_MULTI_INDEX && h->args[nargs]; nargs++)
+	;
+      Sputc('I', fd);
+      qlfPutUInt32(nargs, fd);
+      for(n=0; n<nargs; n++)
+	qlfPutUInt32(h->args[n], fd);
+      qlfPutUInt32(h->ln_buckets, fd);
+      qlfPutUInt32(h->list, fd);
+      qlfPutDouble(h->speedup, fd);
+    }
+  }
+}
+
+
 static void
 closePredicateWic(wic_state *state)
 { if ( state->currentPred )
-  { Sputc('X', state->wicFd);
+  { saveIndexLayouts(state, state->currentPred);
+    Sputc('X', state->wicFd);
     state->currentPred = NULL;
   }
 }
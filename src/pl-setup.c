@@ -119,6 +119,7 @@ setupProlog(void)
   DEBUG(1, Sdprintf("Prolog Signal Handling ...\n"));
   initSignals();
   initClauseIndexing();
+  GD->clauses.cgc_max_pause = 0.01;	/* before initPrologFlags() */
   DEBUG(1, Sdprintf("Stacks ...\n"));
   if ( !initPrologStacks(GD->options.stackLimit) )
     outOfCore();
@@ -838,11 +839,18 @@ gc_tune_handler(int sig)
   call_tune_gc_hook();
 }
 
+static void
+heap_quota_handler(int sig)
+{ (void)sig;
+
+  callHeapQuotaHook();
+}
+
 static void
 cgc_handler(int sig)
 { (void)sig;
 
-  pl_garbage_collect_clauses();
+  clauseGCSlice();
 }
 
 
@@ -916,6 +924,7 @@ initSignals(DECL_LD)
 
   PL_signal(SIG_GC|PL_SIGSYNC,		  gc_handler);
   PL_signal(SIG_TUNE_GC|PL_SIGSYNC,	  gc_tune_handler);
+  PL_signal(SIG_HEAP_QUOTA|PL_SIGSYNC,	  heap_quota_handler);
   PL_signal(SIG_CLAUSE_GC|PL_SIGSYNC,     cgc_handler);
   PL_signal(SIG_PLABORT|PL_SIGSYNC,       abort_handler);
 #ifdef SIG_THREAD_SIGNAL
@@ -1500,6 +1509,7 @@ emptyStacks(void)
   emptyStack((Stack)&LD->stacks.argument);
 
   LD->mark_bar          = gTop;
+  LD->gen_bar           = NULL;
   if ( lTop && gTop )
   { int i;
 
@@ -1781,6 +1791,7 @@ freePrologLocalData(PL_local_data_t *ld)
 
   cleanAbortHooks(ld);
   unreferenceStandardStreams(ld);
+  freeSlabCache(ld);
 }
 
 /* The following definitions aren't necessary for compiling, and in fact
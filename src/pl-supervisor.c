@@ -41,6 +41,7 @@
 #include "pl-wrap.h"
 #include "pl-tabling.h"
 #include "pl-util.h"
+#include "pl-proc.h"
 
 #define MAX_FLI_ARGS 10			/* extend switches on change */
 
@@ -54,11 +55,22 @@ allocCodes(size_t n)
 }
 
 
+static void
+freeHotSwitch(Code codes)
+{ if ( codes[0] == encode(S_SWITCH) )
+  { HotSwitch hs = code2ptr(HotSwitch, codes[1]);
+
+    freeHeap(hs, sizeof(*hs) + hs->size*sizeof(hs->entries[0]));
+  }
+}
+
+
 static void
 freeCodes(Code codes)
 { size_t size = (size_t)codes[-1];
 
   unregisterWrappedSupervisor(codes); /* holds atom_t references */
+  freeHotSwitch(codes);
 
   if ( size > 0 )		/* 0: built-in, see initSupervisors() */
     freeHeap(&codes[-1], (size+1)*sizeof(code));
@@ -72,7 +84,9 @@ predicate *always* has non-NULL def->codes.
 
 If linger == FALSE, we  are  absolutely   sure  that  it  is harmless to
 deallocate the old supervisor. If TRUE,   there may be references. I.e.,
-other threads may have started executing this predicate.
+other threads may have started executing this predicate.  The definition
+inside a wrapper closure is not a  real predicate and cannot be handled
+by clause GC.  Its lingering data is freed with the closure.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static void
@@ -87,8 +101,11 @@ freeSupervisor(Definition def, Code codes, int do_linger)
 
   if ( size > 0 )		/* 0: built-in, see initSupervisors() */
   { if ( do_linger )
-      linger(&def->lingering, free_codes_ptr, codes);
-    else
+    { if ( def->codes == SUPERVISOR(wrapper) )	/* closure (pl-wrap.c) */
+	linger(&def->lingering, free_codes_ptr, codes);
+      else
+	retireDefinitionData(def, free_codes_ptr, codes);
+    } else
       freeCodes(codes);
   }
 }
@@ -311,6 +328,78 @@ listSupervisor(Definition def)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+hotSwitchSupervisor() creates a supervisor for a  static predicate whose
+clauses all have a  distinct  key  for   the  first  argument. This is a
+clause indexing optimization: after  GD->hot_predicates.threshold calls
+the S_STATIC instruction calls  createHotSupervisor()   to  replace the
+supervisor by
+
+	S_SWITCH <HotSwitch>
+
+S_SWITCH jumps directly to the  only   clause  that can match the first
+argument, avoiding the clause  search  and   the  choicepoint  logic  of
+S_STATIC.  If  the  first  argument  is  unbound,  the  clause  is not
+visible or the predicate has  erased   clauses  that  may be visible to
+older generations, it falls back to S_STATIC.  The clause body is still
+executed by the normal VMI dispatch loop.
+
+The table includes all  clauses  that  are   not  erased,  also if they
+are not yet visible.  As it is  created  with the definition locked, a
+clause that is added later  resets  the  supervisor to S_VIRGIN.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static Code
+hotSwitchSupervisor(Definition def)
+{ ClauseRef cref;
+  size_t count = 0;
+  unsigned int size = 4;
+  HotSwitch hs;
+  Code codes;
+
+  for(cref = def->impl.clauses.first_clause; cref; cref = cref->next)
+  { if ( false(cref->value.clause, CL_ERASED) )
+    { if ( !cref->d.key || ++count > HOT_SWITCH_MAX_CLAUSES )
+	return NULL;
+    }
+  }
+  if ( count < 2 )
+    return NULL;
+
+  while ( size < count*2 )
+    size *= 2;
+  hs = allocHeapOrHalt(sizeof(*hs) + size*sizeof(hs->entries[0]));
+  memset(hs, 0, sizeof(*hs) + size*sizeof(hs->entries[0]));
+  hs->size  = size;
+  hs->count = (unsigned int)count;
+
+  for(cref = def->impl.clauses.first_clause; cref; cref = cref->next)
+  { if ( false(cref->value.clause, CL_ERASED) )
+    { word key = cref->d.key;
+      unsigned int i = MurmurHashWord(key, MURMUR_SEED) & (size-1);
+
+      for(; hs->entries[i].key; i = (i+1) & (size-1))
+      { if ( hs->entries[i].key == key )	/* not deterministic */
+	{ freeHeap(hs, sizeof(*hs) + size*sizeof(hs->entries[0]));
+	  return NULL;
+	}
+      }
+      hs->entries[i].key  = key;
+      hs->entries[i].cref = cref;
+    }
+  }
+
+  DEBUG(MSG_JIT, Sdprintf("Hot switch supervisor for %s (%zd clauses)\n",
+			  predicateName(def), count));
+
+  codes = allocCodes(2);
+  codes[0] = encode(S_SWITCH);
+  codes[1] = ptr2code(hs);
+
+  return codes;
+}
+
+
 static Code
 dynamicSupervisor(Definition def)
 { if ( true(def, P_DYNAMIC) )
@@ -476,6 +565,7 @@ setDefaultSupervisor(Definition def)
     PL_LOCK(L_PREDICATE);
     old = def->codes;
     codes = createSupervisor(def);
+    def->hot_calls = 0;
     if ( equalSupervisors(old, codes) )
     { freeSupervisor(def, codes, FALSE);
     } else
@@ -490,6 +580,83 @@ setDefaultSupervisor(Definition def)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+createHotSupervisor() is called from  S_STATIC   if  a  predicate  using
+the generic static supervisor  has   been  called GD->hot_predicates.
+threshold times.  Returns TRUE if the supervisor was replaced.
+
+Counting every call would  make  all  threads   write  to  the  shared
+definition on each call.  Instead, each thread  counts down its S_STATIC
+calls in LD->hot_predicates.countdown and   calls  sampleHotPredicate()
+for one in GD->hot_predicates.sample_rate  calls.   Only  the  samples
+update def->hot_calls.  Updates to this counter   may  be lost if threads
+sample the same predicate  concurrently,  which   merely  delays  the
+switch.  The counter  stops  at   GD->hot_predicates.samples,  also  if
+createHotSupervisor() declines, such that  predicates   that  cannot be
+switched are not written to again until setDefaultSupervisor() resets
+the counter.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+createHotSupervisor(Definition def)
+{ Code codes;
+  int rc = FALSE;
+
+  if ( true(def, P_DYNAMIC|P_LOCKED_SUPERVISOR) )
+    return FALSE;
+
+  LOCKDEF(def);				/* also locks L_PREDICATE */
+  if ( def->codes == SUPERVISOR(staticp) &&
+       (codes = hotSwitchSupervisor(def)) )
+  { MEMORY_BARRIER();
+    def->codes = codes;
+    rc = TRUE;
+  }
+  UNLOCKDEF(def);
+
+  return rc;
+}
+
+
+void
+sampleHotPredicate(Definition def)
+{ unsigned int samples = GD->hot_predicates.samples;
+
+  if ( samples && def->hot_calls < samples &&
+       ++def->hot_calls == samples )
+    createHotSupervisor(def);
+}
+
+
+/* Sample one in threshold/64 calls, but at  most one in HOT_PREDICATE_SAMPLE,
+   such that small thresholds are still counted exactly.  The first call
+   of the calling thread after the change is sampled.
+*/
+
+void
+setHotPredicateThreshold(unsigned int threshold)
+{ GET_LD
+
+  GD->hot_predicates.threshold = threshold;
+  if ( HAS_LD )				/* other threads adjust at their */
+    LD->hot_predicates.countdown = 0;	/* next sample */
+
+  if ( threshold )
+  { int rate = (int)(threshold/64);
+
+    if ( rate < 1 )
+      rate = 1;
+    else if ( rate > HOT_PREDICATE_SAMPLE )
+      rate = HOT_PREDICATE_SAMPLE;
+    GD->hot_predicates.sample_rate = rate;
+    GD->hot_predicates.samples     = threshold/rate;
+  } else
+  { GD->hot_predicates.sample_rate = INT_MAX;
+    GD->hot_predicates.samples     = 0;
+  }
+}
+
+
 		 /*******************************
 		 *	      INFO		*
 		 *******************************/
@@ -516,6 +683,12 @@ size_t
 sizeof_supervisor(Code base)
 { size_t size = (size_t)base[-1];
 
+  if ( size > 0 && base[0] == encode(S_SWITCH) )
+  { HotSwitch hs = code2ptr(HotSwitch, base[1]);
+
+    return size*sizeof(code) + sizeof(*hs) + hs->size*sizeof(hs->entries[0]);
+  }
+
   return size*sizeof(code);
 }
 
@@ -553,4 +726,6 @@ initSupervisors(void)
   MAKE_SV1(staticp,      S_STATIC);
   MAKE_SV1(wrapper,      S_WRAP);
   MAKE_SV1(trie_gen,     S_TRIE_GEN);
+
+  setHotPredicateThreshold(HOT_PREDICATE_THRESHOLD);
 }
@@ -39,6 +39,21 @@
 #ifndef _PL_SUPERVISOR_H
 #define _PL_SUPERVISOR_H
 
+#define HOT_PREDICATE_THRESHOLD 1000	/* default S_STATIC calls */
+#define HOT_PREDICATE_SAMPLE	16	/* Max S_STATIC calls per sample */
+#define HOT_SWITCH_MAX_CLAUSES	256	/* Max clauses for S_SWITCH */
+
+typedef struct hot_switch_entry
+{ word		key;			/* First argument key */
+  ClauseRef	cref;			/* Only clause with this key */
+} hot_switch_entry;
+
+typedef struct hot_switch
+{ unsigned int	size;			/* #entries (power of 2) */
+  unsigned int	count;			/* #clauses */
+  hot_switch_entry entries[];
+} hot_switch, *HotSwitch;
+
 Code		allocCodes(size_t len);
 void		freeCodesDefinition(Definition def, int linger);
 void		freeSupervisor(Definition def, Code code, int linger);
@@ -47,8 +62,28 @@ int		createUndefSupervisor(Definition def);
 Code		createSupervisor(Definition def);
 int		setDefaultSupervisor(Definition def);
 void		setSupervisor(Definition def, Code codes);
+int		createHotSupervisor(Definition def);
+void		sampleHotPredicate(Definition def);
+void		setHotPredicateThreshold(unsigned int threshold);
 size_t		sizeof_supervisor(Code base);
 size_t		supervisorLength(Code base);
 void		initSupervisors(void);
 
+/* Find the clause for a first argument key in an S_SWITCH table */
+
+static inline ClauseRef
+hotSwitchClause(const HotSwitch hs, word key)
+{ unsigned int i = MurmurHashWord(key, MURMUR_SEED) & (hs->size-1);
+
+  for(;;)
+  { const hot_switch_entry *e = &hs->entries[i];
+
+    if ( e->key == key )
+      return e->cref;
+    if ( !e->key )
+      return NULL;
+    i = (i+1) & (hs->size-1);
+  }
+}
+
 #endif /*_PL_SUPERVISOR_H*/
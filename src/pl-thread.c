@@ -76,6 +76,9 @@
 #include <stdio.h>
 #include <math.h>
 #include <errno.h>
+#ifdef HAVE_SCHED_YIELD
+#include <sched.h>
+#endif
 
 #if __WINDOWS__				/* this is a stub.  Should be detected */
 #undef HAVE_PTHREAD_SETNAME_NP		/* in configure.ac */
@@ -532,6 +535,8 @@ static int will_exec;			/* process will exec soon */
 	LDFUNC(get_message_queue, t, queue)
 #define create_thread_handle(info) \
 	LDFUNC(create_thread_handle, info)
+#define send_message_lockfree(t, top, bottom, count) \
+	LDFUNC(send_message_lockfree, t, top, bottom, count)
 #endif /*USE_LD_MACROS*/
 
 #define LDFUNC_DECLARATIONS
@@ -555,6 +560,12 @@ static int	unify_queue(term_t t, message_queue *q);
 static int	get_message_queue_unlocked(term_t t, message_queue **queue);
 static int	get_message_queue(term_t t, message_queue **queue);
 static void	release_message_queue(message_queue *queue);
+#ifdef O_PLMT
+static int	send_message_lockfree(term_t t,
+				      struct thread_message *top,
+				      struct thread_message *bottom,
+				      size_t count);
+#endif
 static void	initMessageQueues(void);
 static int	get_thread(term_t t, PL_thread_info_t **info, int warn);
 static int	is_alive(int status);
@@ -2158,6 +2169,8 @@ copy_local_data(PL_local_data_t *ldnew, PL_local_data_t *ldold,
     ldnew->tabling.node_pool = new_alloc_pool(pool->name, pool->limit);
   ldnew->fli.string_buffers.tripwire
 				  = ldold->fli.string_buffers.tripwire;
+  ldnew->heap_quota.limit	  = ldold->heap_quota.limit;
+  ldnew->heap_quota.soft_limit	  = ldold->heap_quota.soft_limit;
   ldnew->statistics.start_time    = WallTime();
   ldnew->prolog_flag.mask	  = ldold->prolog_flag.mask;
   ldnew->prolog_flag.occurs_check = ldold->prolog_flag.occurs_check;
@@ -2881,29 +2894,78 @@ PRED_IMPL("thread_alias", 1, thread_alias, 0)
 }
 
 
-static size_t
-sizeof_thread(PL_thread_info_t *info)
-{ size_t size = sizeof(*info);
-  struct PL_local_data *ld = info->thread_data;
+typedef struct thread_memory
+{ size_t	thread;			/* Thread and local data */
+  size_t	stacks;			/* Prolog stacks */
+  size_t	queue;			/* Message queue */
+  size_t	predicates;		/* Thread-local predicates */
+  size_t	tables;			/* Private tables */
+} thread_memory;
+
+static int
+get_thread_memory(PL_thread_info_t *info, thread_memory *mem)
+{ struct PL_local_data *ld = info->thread_data;
 
+  memset(mem, 0, sizeof(*mem));
   if ( info->status != PL_THREAD_RUNNING )
-    return 0;
+    return FALSE;
 
+  mem->thread = sizeof(*info);
   if ( ld )
-  { size += sizeof(*ld);
-    size += sizeStackP(&ld->stacks.global)   + ld->stacks.global.spare;
-    size += sizeStackP(&ld->stacks.local)    + ld->stacks.local.spare;
-    size += sizeStackP(&ld->stacks.trail)    + ld->stacks.trail.spare;
-    size += sizeStackP(&ld->stacks.argument);
+  { mem->thread += sizeof(*ld);
+    mem->stacks += sizeStackP(&ld->stacks.global) + ld->stacks.global.spare;
+    mem->stacks += sizeStackP(&ld->stacks.local)  + ld->stacks.local.spare;
+    mem->stacks += sizeStackP(&ld->stacks.trail)  + ld->stacks.trail.spare;
+    mem->stacks += sizeStackP(&ld->stacks.argument);
 
-    size += sizeof_message_queue(&ld->thread.messages);
-    size += sizeof_local_definitions(ld);
+    mem->queue      = sizeof_message_queue(&ld->thread.messages);
+    mem->predicates = sizeof_local_definitions(ld);
 
     if ( ld->tabling.node_pool )
-      size += ld->tabling.node_pool->size;
+      mem->tables = ld->tabling.node_pool->size;
   }
 
-  return size;
+  return TRUE;
+}
+
+
+static size_t
+sizeof_thread(PL_thread_info_t *info)
+{ thread_memory mem;
+
+  if ( !get_thread_memory(info, &mem) )
+    return 0;
+
+  return mem.thread + mem.stacks + mem.queue + mem.predicates + mem.tables;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+'$thread_memory'(+Thread, -Usage) breaks  down thread_property(Thread,
+size(Bytes)).  Usage is a term memory(Stacks, Predicates, Tables, Queue,
+Thread).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static
+PRED_IMPL("$thread_memory", 2, thread_memory, 0)
+{ PRED_LD
+  PL_thread_info_t *info;
+  thread_memory mem;
+  int rc;
+
+  PL_LOCK(L_THREAD);
+  rc = ( get_thread(A1, &info, TRUE) &&
+	 get_thread_memory(info, &mem) );
+  PL_UNLOCK(L_THREAD);
+
+  return ( rc &&
+	   PL_unify_term(A2,
+			 PL_FUNCTOR_CHARS, "memory", 5,
+			   PL_INT64, (int64_t)mem.stacks,
+			   PL_INT64, (int64_t)mem.predicates,
+			   PL_INT64, (int64_t)mem.tables,
+			   PL_INT64, (int64_t)mem.queue,
+			   PL_INT64, (int64_t)mem.thread) );
 }
 
 
@@ -3254,6 +3316,8 @@ PRED_IMPL("thread_affinity", 3, thread_affinity, 0)
     { if ( (rc=get_cpuset(A3, &cpuset)) )
       { if ( (rc=sched_setaffinity(info->pid, sizeof(cpuset), &cpuset)) == 0 )
 	{ rc = TRUE;
+	  if ( info == LD->thread.info )
+	    applyStackMemoryPolicy();
 	} else
 	{ rc = PL_error(NULL, 0, ThError(rc),
 			ERR_SYSCALL, "sched_setaffinity");
@@ -3734,10 +3798,53 @@ static const PL_option_t make_engine_options[] =
 { { ATOM_stack_limit,	OPT_SIZE|OPT_INF },
   { ATOM_alias,		OPT_ATOM },
   { ATOM_inherit_from,	OPT_TERM },
+  { ATOM_reusable,	OPT_BOOL },
   { NULL_ATOM,		0 }
 };
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+start_interactor() opens the query  of   the  engine  `th` to run the
+Template+Goal term `tg` from the calling engine.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+start_interactor(thread_handle *th, term_t tg)
+{ PL_engine_t new = th->info->thread_data;
+  PL_engine_t me;
+  predicate_t pred;
+  record_t r;
+  term_t t;
+  int rc;
+
+  pred = _PL_predicate("call", 1, "system", &GD->procedures.call1);
+
+  r = PL_record(tg);
+  rc = PL_set_engine(new, &me);
+  assert(rc == PL_ENGINE_SET);
+  (void)rc;
+
+  WITH_LD(new)
+  { if  ( (t = PL_new_term_ref()) &&
+	  (th->interactor.argv = PL_new_term_refs(2)) &&
+	  PL_recorded(r, t) &&
+	  PL_get_arg(1, t, th->interactor.argv+0) &&
+	  PL_get_arg(2, t, th->interactor.argv+1) )
+    { th->interactor.query = PL_open_query(NULL,
+					   PL_Q_CATCH_EXCEPTION|
+					   PL_Q_ALLOW_YIELD|
+					   PL_Q_EXT_STATUS,
+					   pred, th->interactor.argv+1);
+      PL_set_engine(me, NULL);
+    } else
+    { assert(0);			/* TBD: copy exception */
+    }
+  }
+
+  PL_erase(r);
+}
+
+
 static
 PRED_IMPL("$engine_create", 3, engine_create, 0)
 { PRED_LD
@@ -3746,11 +3853,13 @@ PRED_IMPL("$engine_create", 3, engine_create, 0)
   size_t stack	      =	0;
   atom_t alias	      =	NULL_ATOM;
   term_t inherit_from =	0;
+  int reusable	      = FALSE;
 
   if ( !PL_scan_options(A3, 0, "engine_option", make_engine_options,
 			&stack,
 			&alias,
-			&inherit_from) )
+			&inherit_from,
+			&reusable) )
     return FALSE;
 
   if ( stack )
@@ -3759,16 +3868,14 @@ PRED_IMPL("$engine_create", 3, engine_create, 0)
     attrs.stack_limit = LD->stacks.limit;
 
   if ( (new = PL_create_engine(&attrs)) )
-  { PL_engine_t me;
-    predicate_t pred;
-    record_t r;
-    thread_handle *th;
-    term_t t;
+  { thread_handle *th;
     int rc;
 
     new->thread.info->is_engine = TRUE;
     th = create_thread_handle(new->thread.info);
     set(th, TH_IS_INTERACTOR);
+    if ( reusable )
+      set(th, TH_INTERACTOR_REUSE);
     ATOMIC_INC(&GD->statistics.engines_created);
 
     if ( alias )
@@ -3786,31 +3893,7 @@ PRED_IMPL("$engine_create", 3, engine_create, 0)
       return FALSE;
     }
     PL_unregister_atom(th->symbol);
-
-    pred = _PL_predicate("call", 1, "system", &GD->procedures.call1);
-
-    r = PL_record(A2);
-    rc = PL_set_engine(new, &me);
-    assert(rc == PL_ENGINE_SET);
-
-    WITH_LD(new)
-    { if  ( (t = PL_new_term_ref()) &&
-	    (th->interactor.argv = PL_new_term_refs(2)) &&
-	    PL_recorded(r, t) &&
-	    PL_get_arg(1, t, th->interactor.argv+0) &&
-	    PL_get_arg(2, t, th->interactor.argv+1) )
-      { th->interactor.query = PL_open_query(NULL,
-					     PL_Q_CATCH_EXCEPTION|
-					     PL_Q_ALLOW_YIELD|
-					     PL_Q_EXT_STATUS,
-					     pred, th->interactor.argv+1);
-	PL_set_engine(me, NULL);
-      } else
-      { assert(0);			/* TBD: copy exception */
-      }
-    }
-
-    PL_erase(r);
+    start_interactor(th, A2);
 
     return TRUE;
   }
@@ -3865,6 +3948,8 @@ done_interactor(thread_handle *th)
 #endif
 
   set(th, TH_INTERACTOR_DONE);
+  if ( true(th, TH_INTERACTOR_REUSE) )
+    return;				/* keep for '$engine_reset'/2 */
   PL_thread_destroy_engine();
   ATOMIC_INC(&GD->statistics.engines_finished);
   assert(th->info == NULL);
@@ -3886,6 +3971,110 @@ PRED_IMPL("engine_destroy", 1, engine_destroy, 0)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Engine reuse. An engine created  with   reusable(true)  keeps  its Prolog
+engine after it completed. '$engine_reset'/1 discards the query, posted
+term, global variables and private tables,  while the allocated stacks are
+kept. '$engine_reset'/2 prepares a  reset  engine   for  a  new goal. This
+avoids the cost of creating a   new engine (thread slot, flags, stacks and
+thread initialization) for each goal. These are used by engine pools.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+reset_interactor(thread_handle *th)
+{ PL_engine_t me;
+
+  PL_set_engine(th->info->thread_data, &me);
+  { GET_LD
+
+    if ( th->interactor.query )
+    { PL_close_query(th->interactor.query);
+      th->interactor.query = 0;
+    }
+    if ( !LD->tabling.has_scheduling_component )
+      clearThreadTablingData(LD);
+    emptyStacks();
+  }
+  PL_set_engine(me, NULL);
+
+  th->interactor.argv = 0;
+  if ( th->interactor.package )
+  { PL_erase(th->interactor.package);
+    th->interactor.package = 0;
+  }
+  clear(th, (TH_INTERACTOR_NOMORE|TH_INTERACTOR_DONE));
+}
+
+
+#define get_reusable_interactor(t, thp) LDFUNC(get_reusable_interactor, t, thp)
+static int
+get_reusable_interactor(DECL_LD term_t t, thread_handle **thp)
+{ thread_handle *th;
+
+  if ( !get_interactor(t, &th, TRUE) )
+    return FALSE;
+  if ( false(th, TH_INTERACTOR_REUSE) || !th->info ||
+       th->info->thread_data == LD )
+    return PL_permission_error("reset", "engine", t);
+
+  *thp = th;
+  return TRUE;
+}
+
+
+/** '$engine_reset'(+Engine)
+ *
+ * Reset Engine, making it idle.
+ */
+
+static
+PRED_IMPL("$engine_reset", 1, engine_reset, 0)
+{ PRED_LD
+  thread_handle *th;
+  int rc;
+
+  if ( !get_reusable_interactor(A1, &th) )
+    return FALSE;
+
+  simpleMutexLock(th->interactor.mutex);
+  if ( true(th, TH_INTERACTOR_IDLE) )
+  { rc = PL_permission_error("reset", "engine", A1);
+  } else
+  { reset_interactor(th);
+    set(th, (TH_INTERACTOR_IDLE|TH_INTERACTOR_DONE));
+    rc = TRUE;
+  }
+  simpleMutexUnlock(th->interactor.mutex);
+
+  return rc;
+}
+
+
+/** '$engine_reset'(+Engine, +TemplateAndGoal)
+ *
+ * Reset Engine if it is not idle and prepare it to run Template+Goal.
+ */
+
+static
+PRED_IMPL("$engine_reset", 2, engine_reset, 0)
+{ PRED_LD
+  thread_handle *th;
+
+  if ( !get_reusable_interactor(A1, &th) )
+    return FALSE;
+
+  simpleMutexLock(th->interactor.mutex);
+  if ( false(th, TH_INTERACTOR_IDLE) )
+    reset_interactor(th);
+  clear(th, TH_INTERACTOR_IDLE);
+  start_interactor(th, A2);
+  simpleMutexUnlock(th->interactor.mutex);
+  ATOMIC_INC(&GD->statistics.engines_reused);
+
+  return TRUE;
+}
+
+
 static void
 copy_debug_mode(PL_local_data_t *to, PL_local_data_t *from)
 { PL_local_data_t *current = PL_current_engine();
@@ -4191,11 +4380,34 @@ are not equal and there are multiple waiters we must be using broadcast.
 
 typedef struct thread_message
 { struct thread_message *next;		/* next in queue */
+  struct thread_message *prev;		/* previous in queue */
+  struct thread_message *inext;		/* next in index bucket */
   record_t            message;		/* message in queue */
   word		      key;		/* Indexing key */
+  word		      arg_key;		/* Indexing key of first argument */
   uint64_t	      sequence_id;	/* Numbered sequence */
 } thread_message;
 
+typedef struct msg_bucket
+{ thread_message     *head;		/* First message with this key */
+  thread_message     *tail;		/* Last message with this key */
+} msg_bucket;
+
+#define MSG_INDEX_MIN_SCAN 64		/* Create index after skipping */
+
+
+#define first_arg_key(msg) LDFUNC(first_arg_key, msg)
+static word
+first_arg_key(DECL_LD term_t msg)
+{ Word p = valTermRef(msg);
+
+  deRef(p);
+  if ( isTerm(*p) && arityTerm(*p) > 0 )
+    return getIndexOfWord(*argTermP(*p, 0));
+
+  return 0;
+}
+
 
 #define create_thread_message(msg) LDFUNC(create_thread_message, msg)
 static thread_message *
@@ -4208,8 +4420,11 @@ create_thread_message(DECL_LD term_t msg)
 
   if ( (msgp = allocHeap(sizeof(*msgp))) )
   { msgp->next    = NULL;
+    msgp->prev    = NULL;
+    msgp->inext   = NULL;
     msgp->message = rec;
     msgp->key     = getIndexOfTerm(msg);
+    msgp->arg_key = first_arg_key(msg);
   } else
   { freeRecord(rec);
   }
@@ -4227,6 +4442,252 @@ free_thread_message(thread_message *msg)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Message index.  A reader waiting for e.g.  reply(Id,_) on a queue that
+holds many other messages must skip all of them.  If get_message() skips
+MSG_INDEX_MIN_SCAN messages for a pattern with a bound first argument,
+it creates queue->index.  This maps the combined functor and first
+argument key to a msg_bucket holding the messages with this key in
+sequence order, chained using thread_message->inext.  Messages with an
+unbound first argument are in the bucket of the functor with key 0 and
+messages that are unbound in the bucket with both keys 0.  A reader
+merges these buckets (see msg_cursor).  The index is maintained while
+messages are added and removed and deleted if the queue becomes empty.
+All index operations require the queue mutex.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static table_key_t
+msg_index_key(word key, word arg_key)
+{ table_key_t k = (table_key_t)(key ^ (arg_key*0x9e3779b97f4a7c15ULL));
+
+  if ( !htable_valid_kv((void*)k) )
+    k = 0x3;
+
+  return k;
+}
+
+
+static void
+index_message(message_queue *queue, thread_message *msgp)
+{ GET_LD
+  table_key_t k = msg_index_key(msgp->key, msgp->arg_key);
+  msg_bucket *b;
+
+  if ( !(b=lookupHTableWP(queue->index, k)) )
+  { b = allocHeapOrHalt(sizeof(*b));
+    b->head = b->tail = NULL;
+    addNewHTableWP(queue->index, k, b);
+  }
+
+  if ( !b->tail )
+  { b->head = b->tail = msgp;
+    msgp->inext = NULL;
+  } else if ( b->tail->sequence_id < msgp->sequence_id )
+  { b->tail->inext = msgp;
+    b->tail = msgp;
+    msgp->inext = NULL;
+  } else				/* put back by get_first_message() */
+  { thread_message **pp = &b->head;
+
+    while( (*pp)->sequence_id < msgp->sequence_id )
+      pp = &(*pp)->inext;
+    msgp->inext = *pp;
+    *pp = msgp;
+  }
+}
+
+
+static void
+unindex_message(message_queue *queue, thread_message *msgp)
+{ GET_LD
+  table_key_t k = msg_index_key(msgp->key, msgp->arg_key);
+  msg_bucket *b = lookupHTableWP(queue->index, k);
+  thread_message **pp, *prev = NULL;
+
+  for(pp = &b->head; *pp != msgp; pp = &(*pp)->inext)
+    prev = *pp;				/* normally msgp is the head */
+  *pp = msgp->inext;
+  if ( b->tail == msgp )
+    b->tail = prev;
+  msgp->inext = NULL;
+
+  if ( !b->head )
+  { deleteHTableWP(queue->index, k);
+    freeHeap(b, sizeof(*b));
+  }
+}
+
+
+static void
+free_msg_bucket(table_key_t name, table_value_t value)
+{ msg_bucket *b = val2ptr(value);
+  (void)name;
+
+  freeHeap(b, sizeof(*b));
+}
+
+
+static void
+free_message_index(message_queue *queue)
+{ TableWP index;
+
+  if ( (index=queue->index) )
+  { queue->index = NULL;
+    destroyHTableWP(index);
+  }
+}
+
+
+static void
+create_message_index(message_queue *queue)
+{ thread_message *msgp;
+
+  DEBUG(MSG_QUEUE, Sdprintf("Creating index for queue %p\n", queue));
+  queue->index = newHTableWP(16);
+  queue->index->free_symbol = free_msg_bucket;
+  for(msgp = queue->head; msgp; msgp = msgp->next)
+    index_message(queue, msgp);
+}
+
+
+static void
+append_message(message_queue *queue, thread_message *msgp)
+{ msgp->sequence_id = ++queue->sequence_next;
+  msgp->next = NULL;
+  if ( !queue->head )
+  { msgp->prev = NULL;
+    queue->head = queue->tail = msgp;
+  } else
+  { msgp->prev = queue->tail;
+    queue->tail->next = msgp;
+    queue->tail = msgp;
+  }
+  queue->size++;
+  if ( queue->index )
+    index_message(queue, msgp);
+}
+
+
+/* unlink_message() removes msgp from the queue.  The message is
+   not freed.
+*/
+
+static void
+unlink_message(message_queue *queue, thread_message *msgp)
+{ if ( GD->atoms.gc_active )
+    markAtomsRecord(msgp->message);
+
+#ifdef O_PLMT
+  simpleMutexLock(&queue->gc_mutex);	/* see get_message() */
+#endif
+  if ( msgp->prev )
+    msgp->prev->next = msgp->next;
+  else
+    queue->head = msgp->next;
+  if ( msgp->next )
+    msgp->next->prev = msgp->prev;
+  else
+    queue->tail = msgp->prev;
+#ifdef O_PLMT
+  simpleMutexUnlock(&queue->gc_mutex);
+#endif
+  msgp->next = msgp->prev = NULL;
+
+  if ( queue->index )
+    unindex_message(queue, msgp);
+  if ( --queue->size == 0 )
+    free_message_index(queue);
+#ifdef O_PLMT
+  if ( queue->wait_for_drain )
+  { DEBUG(MSG_QUEUE, Sdprintf("Queue drained. wakeup writers\n"));
+    cv_signal(&queue->drain_var);
+  }
+#endif
+}
+
+
+#ifdef O_PLMT
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Sending without the queue mutex.  If a queue has no max_size, a sender
+pushes its message on queue->incoming using compare-and-swap and only
+takes the mutex if there are readers to wake up.  Readers move the
+incoming messages to the ordered list using drain_incoming() while
+holding the mutex.  This is where the message gets its sequence_id.
+As incoming is a stack, draining reverses it to restore the send order
+of each sender.  Bounded queues always use queue_message() as it must
+be able to block the sender.
+
+A reader increments queue->waiting and checks queue->incoming while
+holding the mutex before it waits on the condition variable.  The
+sender pushes before it reads queue->waiting.  As both use a full
+memory barrier, either the reader sees the message or the sender sees
+the reader and signals it while holding the mutex.
+
+queue->senders counts the senders that use the queue without holding
+its mutex.  destroy_message_queue() waits for this to drop to zero.
+Senders add to queue->pending before  publishing the messages, so the
+ATOMIC_SUB() below never makes it wrap.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+drain_incoming(message_queue *queue)
+{ thread_message *msgp, *next, *rev = NULL;
+  size_t count = 0;
+
+  if ( !queue->incoming )
+    return;
+
+  simpleMutexLock(&queue->gc_mutex);	/* see markAtomsMessageQueue() */
+  do
+  { msgp = queue->incoming;
+  } while ( !COMPARE_AND_SWAP_PTR(&queue->incoming, msgp, NULL) );
+
+  for( ; msgp; msgp = next )
+  { next = msgp->next;
+    msgp->next = rev;
+    rev = msgp;
+    count++;
+  }
+  for(msgp = rev; msgp; msgp = next)
+  { next = msgp->next;
+    msgp->next = NULL;
+    append_message(queue, msgp);
+  }
+  simpleMutexUnlock(&queue->gc_mutex);
+
+  ATOMIC_SUB(&queue->pending, count);
+}
+
+
+static void
+wakeup_readers(message_queue *queue, size_t count)
+{ if ( queue->waiting )
+  { if ( queue->waiting > 1 &&
+	 (queue->waiting > queue->waiting_var || count > 1) )
+    { DEBUG(MSG_QUEUE,
+	    Sdprintf("%d: %d of %d non-var waiters on %p; broadcasting\n",
+		     PL_thread_self(),
+		     queue->waiting - queue->waiting_var,
+		     queue->waiting,
+		     queue));
+      cv_broadcast(&queue->cond_var);
+    } else
+    { DEBUG(MSG_QUEUE, Sdprintf("%d: %d waiters on %p; signalling\n",
+				PL_thread_self(), queue->waiting, queue));
+      cv_signal(&queue->cond_var);
+    }
+  } else
+  { DEBUG(MSG_QUEUE, Sdprintf("%d: no waiters on %p\n",
+			      PL_thread_self(), queue));
+  }
+}
+
+#else
+#define drain_incoming(queue) (void)0
+#endif /*O_PLMT*/
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 queue_message() adds a message to a message queue.  The caller must hold
 the queue-mutex.
@@ -4238,7 +4699,9 @@ the queue-mutex.
 static int
 queue_message(DECL_LD message_queue *queue, thread_message *msgp,
 	      struct timespec *deadline, struct timespec *retry)
-{ if ( queue->max_size > 0 && queue->size >= queue->max_size )
+{ drain_incoming(queue);		/* keep the send order */
+
+  if ( queue->max_size > 0 && queue->size >= queue->max_size )
   {
 #ifdef O_PLMT
     queue->wait_for_drain++;
@@ -4276,34 +4739,9 @@ queue_message(DECL_LD message_queue *queue, thread_message *msgp,
 #endif
   }
 
-  msgp->sequence_id = ++queue->sequence_next;
-  if ( !queue->head )
-  { queue->head = queue->tail = msgp;
-  } else
-  { queue->tail->next = msgp;
-    queue->tail = msgp;
-  }
-  queue->size++;
-
+  append_message(queue, msgp);
 #ifdef O_PLMT
-  if ( queue->waiting )
-  { if ( queue->waiting > queue->waiting_var && queue->waiting > 1 )
-    { DEBUG(MSG_QUEUE,
-	    Sdprintf("%d: %d of %d non-var waiters on %p; broadcasting\n",
-		     PL_thread_self(),
-		     queue->waiting - queue->waiting_var,
-		     queue->waiting,
-		     queue));
-      cv_broadcast(&queue->cond_var);
-    } else
-    { DEBUG(MSG_QUEUE, Sdprintf("%d: %d waiters on %p; signalling\n",
-				PL_thread_self(), queue->waiting, queue));
-      cv_signal(&queue->cond_var);
-    }
-  } else
-  { DEBUG(MSG_QUEUE, Sdprintf("%d: no waiters on %p\n",
-			      PL_thread_self(), queue));
-  }
+  wakeup_readers(queue, 1);
 #endif
 
   return TRUE;
@@ -4599,6 +5037,214 @@ we also need to lock to avoid  get_message() destroying the record while
 markAtomsMessageQueue() scans it. This fixes the reopened Bug#142.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#ifdef O_PLMT
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+get_first_message() is the fast path of get_message() for a reader that
+accepts any message.  We unlink the head while holding the mutex and
+copy the record to the stack after releasing it, such that senders are
+not blocked while the term is copied.  While the mutex is released the
+reader is counted in queue->waiting, which prevents the queue from
+being deleted.  The record is accessible to AGC via LD->thread.in_transit
+(see markAtomsThreadMessageQueue()).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define get_first_message(queue, msg) LDFUNC(get_first_message, queue, msg)
+
+static int
+get_first_message(DECL_LD message_queue *queue, term_t msg)
+{ thread_message *msgp = queue->head;
+  message_queue *own = &LD->thread.messages;
+  term_t tmp = PL_new_term_ref();
+  int rc;
+
+  LD->thread.in_transit = msgp->message;
+  unlink_message(queue, msgp);
+
+  ATOMIC_INC(&queue->waiting);
+  queue->waiting_var++;
+  simpleMutexUnlock(&queue->mutex);
+
+  rc = PL_recorded(msgp->message, tmp);
+  if ( rc )
+    rc = PL_unify(msg, tmp);		/* msg is a plain variable */
+
+  simpleMutexLock(&own->gc_mutex);
+  LD->thread.in_transit = 0;
+  simpleMutexUnlock(&own->gc_mutex);
+
+  simpleMutexLock(&queue->mutex);
+  ATOMIC_DEC(&queue->waiting);
+  queue->waiting_var--;
+
+  if ( rc )
+  { free_thread_message(msgp);
+    return TRUE;
+  }
+
+  simpleMutexLock(&queue->gc_mutex);	/* put it back */
+  if ( (msgp->next = queue->head) )
+    queue->head->prev = msgp;
+  else
+    queue->tail = msgp;
+  queue->head = msgp;
+  simpleMutexUnlock(&queue->gc_mutex);
+  queue->size++;
+  if ( queue->index )
+    index_message(queue, msgp);
+
+  return raiseStackOverflow(GLOBAL_OVERFLOW);
+}
+#endif /*O_PLMT*/
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+wait_message() waits for a new message after a reader found no matching
+message.  It must be called with queue->mutex locked.  It returns TRUE
+if the reader must scan the queue again or one of MSG_WAIT_INTR and
+MSG_WAIT_TIMEOUT.  If the deadline has already passed, e.g., when polling
+using timeout(0), we do not call dispatch_cond_wait() as a timed wait
+with a past deadline still enters the kernel and may yield the CPU.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define wait_message(queue, isvar, deadline, retry) \
+	LDFUNC(wait_message, queue, isvar, deadline, retry)
+
+static int
+wait_message(DECL_LD message_queue *queue, int isvar,
+	     struct timespec *deadline, struct timespec *retry)
+{
+#ifdef O_PLMT
+  int rc;
+
+  ATOMIC_INC(&queue->waiting);
+  queue->waiting_var += isvar;
+  MEMORY_BARRIER();
+  if ( queue->incoming )		/* see drain_incoming() */
+  { ATOMIC_DEC(&queue->waiting);
+    queue->waiting_var -= isvar;
+    return TRUE;
+  }
+  if ( deadline )			/* polling using timeout(0) */
+  { struct timespec now;
+
+    get_current_timespec(&now);
+    if ( timespec_cmp(deadline, &now) <= 0 )
+    { ATOMIC_DEC(&queue->waiting);
+      queue->waiting_var -= isvar;
+      return MSG_WAIT_TIMEOUT;
+    }
+  }
+  DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: waiting on queue\n", PL_thread_self()));
+  rc = dispatch_cond_wait(queue, QUEUE_WAIT_READ, deadline, retry);
+  switch ( rc )
+  { case CV_INTR:
+    { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: CV_INTR\n", PL_thread_self()));
+
+      if ( !LD )			/* needed for clean exit */
+      { Sdprintf("Forced exit from get_message()\n");
+	exit(1);
+      }
+
+      if ( is_signalled() )		/* thread-signal */
+      { ATOMIC_DEC(&queue->waiting);
+	queue->waiting_var -= isvar;
+	return MSG_WAIT_INTR;
+      }
+      break;
+    }
+    case CV_TIMEDOUT:
+    { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: CV_TIMEDOUT\n", PL_thread_self()));
+
+      ATOMIC_DEC(&queue->waiting);
+      queue->waiting_var -= isvar;
+      return MSG_WAIT_TIMEOUT;
+    }
+    case CV_READY:
+    case CV_MAYBE:
+      DEBUG(MSG_QUEUE_WAIT,
+	    Sdprintf("%d: wakeup (%d) on queue\n",
+		     PL_thread_self(), rc));
+      break;
+    default:
+      assert(0);
+  }
+  ATOMIC_DEC(&queue->waiting);
+  queue->waiting_var -= isvar;
+
+  return TRUE;
+#else
+  return MSG_WAIT_TIMEOUT;
+#endif
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A msg_cursor enumerates the messages that may match a pattern in
+sequence order.  Without an index this walks the queue.  With an index
+it merges the buckets that may hold matching messages.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct msg_cursor
+{ thread_message *chain[3];		/* Candidate chains */
+  int		  indexed;		/* chain[] are index buckets */
+} msg_cursor;
+
+#define init_msg_cursor(c, queue, key, arg_key) \
+	LDFUNC(init_msg_cursor, c, queue, key, arg_key)
+
+static void
+init_msg_cursor(DECL_LD msg_cursor *c, message_queue *queue,
+		word key, word arg_key)
+{ if ( queue->index && key && arg_key )
+  { table_key_t keys[3];
+    int i, j;
+
+    keys[0] = msg_index_key(key, arg_key);
+    keys[1] = msg_index_key(key, 0);	/* unbound first argument */
+    keys[2] = msg_index_key(0, 0);	/* unbound message */
+
+    c->indexed = TRUE;
+    for(i=0; i<3; i++)
+    { msg_bucket *b = NULL;
+
+      for(j=0; j<i && keys[j] != keys[i]; j++)
+	;
+      if ( j == i )
+	b = lookupHTableWP(queue->index, keys[i]);
+      c->chain[i] = b ? b->head : NULL;
+    }
+  } else
+  { c->indexed = FALSE;
+    c->chain[0] = queue->head;
+  }
+}
+
+
+static thread_message *
+next_msg_cursor(msg_cursor *c)
+{ thread_message *msgp;
+
+  if ( c->indexed )
+  { int i, best = -1;
+
+    for(i=0; i<3; i++)
+    { if ( c->chain[i] &&
+	   (best < 0 || c->chain[i]->sequence_id < c->chain[best]->sequence_id) )
+	best = i;
+    }
+    if ( best < 0 )
+      return NULL;
+    msgp = c->chain[best];
+    c->chain[best] = msgp->inext;
+  } else
+  { if ( (msgp = c->chain[0]) )
+      c->chain[0] = msgp->next;
+  }
+
+  return msgp;
+}
+
+
 #define get_message(queue, msg, deadline, retry) \
 	LDFUNC(get_message, queue, msg, deadline, retry)
 
@@ -4606,7 +5252,9 @@ static int
 get_message(DECL_LD message_queue *queue, term_t msg,
 	    struct timespec *deadline, struct timespec *retry)
 { int isvar = PL_is_variable(msg) ? 1 : 0;
+  int anymsg = isvar && !PL_is_attvar(msg);
   word key = (isvar ? 0L : getIndexOfTerm(msg));
+  word arg_key = (isvar ? 0L : first_arg_key(msg));
   fid_t fid = PL_open_foreign_frame();
   uint64_t seen = 0;
 
@@ -4620,17 +5268,27 @@ get_message(DECL_LD message_queue *queue, term_t msg,
 
   for(;;)
   { int rc;
-    thread_message *msgp = queue->head;
-    thread_message *prev = NULL;
+    thread_message *msgp;
+    msg_cursor cursor;
+    size_t scanned = 0;
 
     if ( queue->destroyed )
       return MSG_WAIT_DESTROYED;
 
+    drain_incoming(queue);
     DEBUG(MSG_QUEUE,
 	  Sdprintf("%d: queue size=%ld\n",
 		   PL_thread_self(), (long)queue->size));
 
-    for( ; msgp; prev = msgp, msgp = msgp->next )
+#ifdef O_PLMT
+    if ( anymsg && queue->head )
+    { PL_close_foreign_frame(fid);
+      return get_first_message(queue, msg);
+    }
+#endif
+
+    init_msg_cursor(&cursor, queue, key, arg_key);
+    while( (msgp = next_msg_cursor(&cursor)) )
     { term_t tmp;
 
       if ( msgp->sequence_id < seen )
@@ -4643,8 +5301,15 @@ get_message(DECL_LD message_queue *queue, term_t msg,
 
       if ( key && msgp->key && key != msgp->key )
       { DEBUG(MSG_QUEUE, Sdprintf("Message key mismatch\n"));
+	scanned++;
 	continue;			/* fast search */
       }
+      if ( arg_key && msgp->arg_key && arg_key != msgp->arg_key &&
+	   key == msgp->key )
+      { DEBUG(MSG_QUEUE, Sdprintf("Message argument key mismatch\n"));
+	scanned++;
+	continue;
+      }
 
       QSTAT(unified);
       tmp = PL_new_term_ref();
@@ -4671,31 +5336,10 @@ get_message(DECL_LD message_queue *queue, term_t msg,
       if ( rc )
       { DEBUG(MSG_QUEUE, Sdprintf("%d: match\n", PL_thread_self()));
 
-	if (GD->atoms.gc_active)
-	  markAtomsRecord(msgp->message);
-
-#ifdef O_PLMT
-	simpleMutexLock(&queue->gc_mutex);	/* see (*) */
-#endif
-	if ( prev )
-	{ if ( !(prev->next = msgp->next) )
-	    queue->tail = prev;
-	} else
-	{ if ( !(queue->head = msgp->next) )
-	    queue->tail = NULL;
-	}
-#ifdef O_PLMT
-	simpleMutexUnlock(&queue->gc_mutex);
-#endif
-
+	unlink_message(queue, msgp);		/* see (*) */
 	free_thread_message(msgp);
-	queue->size--;
-#ifdef O_PLMT
-	if ( queue->wait_for_drain )
-	{ DEBUG(MSG_QUEUE, Sdprintf("Queue drained. wakeup writers\n"));
-	  cv_signal(&queue->drain_var);
-	}
-#endif
+	if ( !queue->index && arg_key && scanned >= MSG_INDEX_MIN_SCAN )
+	  create_message_index(queue);
 
 	PL_close_foreign_frame(fid);
 	return TRUE;
@@ -4704,53 +5348,76 @@ get_message(DECL_LD message_queue *queue, term_t msg,
 	return FALSE;
       }
 
+      scanned++;
       PL_rewind_foreign_frame(fid);
     }
 
-#ifdef O_PLMT
-    queue->waiting++;
-    queue->waiting_var += isvar;
-    DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: waiting on queue\n", PL_thread_self()));
-    rc = dispatch_cond_wait(queue, QUEUE_WAIT_READ, deadline, retry);
-    switch ( rc )
-    { case CV_INTR:
-      { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: CV_INTR\n", PL_thread_self()));
+    if ( !queue->index && arg_key && scanned >= MSG_INDEX_MIN_SCAN )
+      create_message_index(queue);
 
-	if ( !LD )			/* needed for clean exit */
-	{ Sdprintf("Forced exit from get_message()\n");
-	  exit(1);
-	}
+    if ( (rc=wait_message(queue, isvar, deadline, retry)) != TRUE )
+    { PL_discard_foreign_frame(fid);
+      return rc;
+    }
+  }
+}
 
-	if ( is_signalled() )		/* thread-signal */
-	{ queue->waiting--;
-	  queue->waiting_var -= isvar;
-	  PL_discard_foreign_frame(fid);
-	  return MSG_WAIT_INTR;
-	}
-	break;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+get_messages() unifies list with up to max messages from the head of the
+queue,  waiting  for  the  first  one  as  get_message().  All messages are
+copied before any of them is removed from the queue, such that an error
+does not lose messages.  It must be called with queue->mutex locked and
+returns as get_message().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define get_messages(queue, max, list, deadline, retry) \
+	LDFUNC(get_messages, queue, max, list, deadline, retry)
+
+static int
+get_messages(DECL_LD message_queue *queue, size_t max, term_t list,
+	     struct timespec *deadline, struct timespec *retry)
+{ for(;;)
+  { int rc;
+
+    if ( queue->destroyed )
+      return MSG_WAIT_DESTROYED;
+
+    drain_incoming(queue);
+    if ( queue->head )
+    { term_t tail = PL_copy_term_ref(list);
+      term_t head = PL_new_term_ref();
+      term_t tmp  = PL_new_term_ref();
+      term_t ex   = PL_new_term_ref();
+      thread_message *msgp, *next;
+      size_t n;
+
+      for(msgp = queue->head, n = 0; msgp && n < max; msgp = msgp->next, n++)
+      { if ( !PL_recorded(msgp->message, tmp) )
+	  return raiseStackOverflow(GLOBAL_OVERFLOW);
+	if ( !PL_unify_list(tail, head, tail) ||
+	     !PL_unify(head, tmp) )
+	  return FALSE;
+      }
+      if ( !PL_unify_nil(tail) )
+	return FALSE;
+      if ( !foreignWakeup(ex) )
+      { if ( !isVar(*valTermRef(ex)) )
+	  PL_raise_exception(ex);
+	return FALSE;
       }
-      case CV_TIMEDOUT:
-      { DEBUG(MSG_QUEUE_WAIT, Sdprintf("%d: CV_TIMEDOUT\n", PL_thread_self()));
 
-	queue->waiting--;
-	queue->waiting_var -= isvar;
-	PL_discard_foreign_frame(fid);
-	return MSG_WAIT_TIMEOUT;
+      for(msgp = queue->head; n-- > 0; msgp = next)
+      { next = msgp->next;
+	unlink_message(queue, msgp);
+	free_thread_message(msgp);
       }
-      case CV_READY:
-      case CV_MAYBE:
-	DEBUG(MSG_QUEUE_WAIT,
-	      Sdprintf("%d: wakeup (%d) on queue\n",
-		       PL_thread_self(), rc));
-	break;
-      default:
-	assert(0);
+
+      return TRUE;
     }
-    queue->waiting--;
-    queue->waiting_var -= isvar;
-#else
-    return MSG_WAIT_TIMEOUT;
-#endif
+
+    if ( (rc=wait_message(queue, TRUE, deadline, retry)) != TRUE )
+      return rc;
   }
 }
 
@@ -4761,13 +5428,19 @@ peek_message(DECL_LD message_queue *queue, term_t msg)
 { thread_message *msgp;
   term_t tmp = PL_new_term_ref();
   word key = getIndexOfTerm(msg);
+  word arg_key = first_arg_key(msg);
   fid_t fid = PL_open_foreign_frame();
+  msg_cursor cursor;
 
-  msgp = queue->head;
+  drain_incoming(queue);
 
-  for( msgp = queue->head; msgp; msgp = msgp->next )
+  init_msg_cursor(&cursor, queue, key, arg_key);
+  while( (msgp = next_msg_cursor(&cursor)) )
   { if ( key && msgp->key && key != msgp->key )
       continue;
+    if ( arg_key && msgp->arg_key && arg_key != msgp->arg_key &&
+	 key == msgp->key )
+      continue;
 
     if ( !PL_recorded(msgp->message, tmp) )
       return raiseStackOverflow(GLOBAL_OVERFLOW);
@@ -4799,6 +5472,25 @@ destroy_message_queue(message_queue *queue)
 
   assert(!queue->waiting && !queue->wait_for_drain);
 
+#ifdef O_PLMT
+  MEMORY_BARRIER();			/* see send_message_lockfree() */
+  while ( *(volatile int*)&queue->senders )
+  {
+#ifdef HAVE_SCHED_YIELD
+    sched_yield();
+#else
+    Pause(0.0001);
+#endif
+  }
+  for( msgp = queue->incoming; msgp; msgp = next )
+  { next = msgp->next;
+
+    free_thread_message(msgp);
+  }
+  queue->incoming = NULL;
+#endif
+
+  free_message_index(queue);
   for( msgp = queue->head; msgp; msgp = next )
   { next = msgp->next;
 
@@ -4871,6 +5563,10 @@ sizeof_message_queue(message_queue *queue)
   { size += sizeof(*msgp);
     size += msgp->message->size;
   }
+  for( msgp = queue->incoming; msgp; msgp = msgp->next )
+  { size += sizeof(*msgp);
+    size += msgp->message->size;
+  }
   simpleMutexUnlock(&queue->gc_mutex);
 
   return size;
@@ -5031,6 +5727,14 @@ thread_send_message(DECL_LD term_t queue, term_t msgterm,
   if ( !(msg = create_thread_message(msgterm)) )
     return PL_no_memory();
 
+#ifdef O_PLMT
+  if ( (rc=send_message_lockfree(queue, msg, msg, 1)) != -1 )
+  { if ( !rc )
+      free_thread_message(msg);
+    return rc;
+  }
+#endif
+
   if ( !get_message_queue(queue, &q) )
   { free_thread_message(msg);
     return FALSE;
@@ -5063,6 +5767,86 @@ PRED_IMPL("thread_send_message", 3, thread_send_message, 0)
 }
 
 
+static void
+free_thread_messages(thread_message *msgp)
+{ thread_message *next;
+
+  for( ; msgp; msgp = next )
+  { next = msgp->next;
+    free_thread_message(msgp);
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+thread_send_messages(+Queue, +List) records all terms before touching
+the queue.  Unbounded queues receive the batch using a single
+compare-and-swap and at most one wakeup.  Bounded queues are locked once
+and each message may have to wait for the queue to drain.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static
+PRED_IMPL("thread_send_messages", 2, thread_send_messages, 0)
+{ PRED_LD
+  term_t tail = PL_copy_term_ref(A2);
+  term_t head = PL_new_term_ref();
+  thread_message *top = NULL, *bottom = NULL, *msgp, *next;
+  message_queue *q;
+  size_t count = 0;
+  int rc;
+
+  while( PL_get_list(tail, head, tail) )
+  { if ( !(msgp = create_thread_message(head)) )
+    { free_thread_messages(top);
+      return PL_no_memory();
+    }
+    msgp->next = top;			/* reverse order, see */
+    top = msgp;				/* send_message_lockfree() */
+    if ( !bottom )
+      bottom = msgp;
+    count++;
+  }
+  if ( !PL_get_nil_ex(tail) )
+  { free_thread_messages(top);
+    return FALSE;
+  }
+
+#ifdef O_PLMT
+  if ( count > 0 &&
+       (rc=send_message_lockfree(A1, top, bottom, count)) != -1 )
+  { if ( !rc )
+      free_thread_messages(top);
+    return rc;
+  }
+#endif
+
+  if ( !get_message_queue(A1, &q) )
+  { free_thread_messages(top);
+    return FALSE;
+  }
+
+  for(msgp = top, top = NULL; msgp; msgp = next)
+  { next = msgp->next;			/* restore send order */
+    msgp->next = top;
+    top = msgp;
+  }
+
+  rc = TRUE;
+  for(msgp = top; msgp; msgp = next)
+  { next = msgp->next;
+    msgp->next = NULL;
+    if ( (rc = wait_queue_message(A1, q, msgp, NULL, NULL)) != TRUE )
+    { free_thread_message(msgp);
+      free_thread_messages(next);
+      break;
+    }
+  }
+  release_message_queue(q);
+
+  return rc;
+}
+
+
 
 static
 PRED_IMPL("thread_get_message", 1, thread_get_message, PL_FA_ISO)
@@ -5326,6 +6110,64 @@ get_message_queue_unlocked(DECL_LD term_t t, message_queue **queue)
 }
 
 
+#ifdef O_PLMT
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+send_message_lockfree() sends the messages top ... bottom without
+locking the queue (see drain_incoming()).  The messages are linked
+through thread_message->next in reverse send order.  Returns TRUE on
+success, FALSE with an exception if the queue does not exist and -1 if
+the queue must be locked, i.e., it is bounded or being destroyed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+send_message_lockfree(DECL_LD term_t t,
+		      thread_message *top, thread_message *bottom,
+		      size_t count)
+{ message_queue *q;
+  PL_blob_t *type;
+  void *data;
+  thread_message *head;
+
+  if ( PL_get_blob(t, &data, NULL, &type) && type == &message_queue_blob )
+  { mqref *ref = data;
+
+    q = ref->queue;
+    ATOMIC_INC(&q->senders);
+  } else
+  { int rc;
+
+    PL_LOCK(L_THREAD);
+    if ( (rc=get_message_queue_unlocked(t, &q)) )
+      ATOMIC_INC(&q->senders);
+    PL_UNLOCK(L_THREAD);
+    if ( !rc )
+      return FALSE;
+  }
+
+  if ( !q->initialized || q->destroyed || q->max_size > 0 )
+  { ATOMIC_DEC(&q->senders);
+    return -1;
+  }
+
+  ATOMIC_ADD(&q->pending, count);	/* before drain_incoming() can see them */
+  do
+  { head = q->incoming;
+    bottom->next = head;
+  } while ( !COMPARE_AND_SWAP_PTR(&q->incoming, head, top) );
+
+  MEMORY_BARRIER();
+  if ( q->waiting )
+  { simpleMutexLock(&q->mutex);
+    wakeup_readers(q, count);
+    simpleMutexUnlock(&q->mutex);
+  }
+  ATOMIC_DEC(&q->senders);
+
+  return TRUE;
+}
+#endif /*O_PLMT*/
+
+
 /* Get a message queue and lock it
 */
 
@@ -5489,7 +6331,11 @@ static int		/* message_queue_property(Queue, size(Size)) */
 message_queue_size_property(DECL_LD void *ctx, term_t prop)
 { message_queue *q = ctx;
 
+#ifdef O_PLMT
+  return PL_unify_integer(prop, q->size + q->pending);
+#else
   return PL_unify_integer(prop, q->size);
+#endif
 }
 
 
@@ -5745,10 +6591,10 @@ thread_get_message(-Message)
     a message from the queue implicitly associated to the thread.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-#define thread_get_message(queue, msg, deadline, retry) \
-	LDFUNC(thread_get_message, queue, msg, deadline, retry)
+#define thread_get_message(queue, msg, max, deadline, retry) \
+	LDFUNC(thread_get_message, queue, msg, max, deadline, retry)
 static int
-thread_get_message(DECL_LD term_t queue, term_t msg,
+thread_get_message(DECL_LD term_t queue, term_t msg, size_t max,
 		   struct timespec *deadline, struct timespec *retry)
 { int rc;
 
@@ -5758,7 +6604,10 @@ thread_get_message(DECL_LD term_t queue, term_t msg,
     if ( !get_message_queue(queue, &q) )
       return FALSE;
 
-    rc = get_message(q, msg, deadline, retry);
+    if ( max )
+      rc = get_messages(q, max, msg, deadline, retry);
+    else
+      rc = get_message(q, msg, deadline, retry);
     release_message_queue(q);
 
     switch(rc)
@@ -5788,7 +6637,7 @@ static
 PRED_IMPL("thread_get_message", 2, thread_get_message, 0)
 { PRED_LD
 
-    return thread_get_message(A1, A2, NULL, NULL);
+    return thread_get_message(A1, A2, 0, NULL, NULL);
 }
 
 
@@ -5799,7 +6648,24 @@ PRED_IMPL("thread_get_message", 3, thread_get_message, 0)
   struct timespec *dlop=NULL, *retry_every=NULL;
 
   return process_deadline_options(A3,&deadline,&dlop,&retry,&retry_every)
-    &&   thread_get_message(A1, A2, dlop,retry_every);
+    &&   thread_get_message(A1, A2, 0, dlop,retry_every);
+}
+
+
+static
+PRED_IMPL("thread_get_messages", 4, thread_get_messages, 0)
+{ PRED_LD
+  struct timespec deadline, retry;
+  struct timespec *dlop=NULL, *retry_every=NULL;
+  size_t max;
+
+  if ( !PL_get_size_ex(A2, &max) )
+    return FALSE;
+  if ( max == 0 )
+    return PL_error(NULL, 0, NULL, ERR_DOMAIN, ATOM_not_less_than_one, A2);
+
+  return process_deadline_options(A4,&deadline,&dlop,&retry,&retry_every)
+    &&   thread_get_message(A1, A3, max, dlop, retry_every);
 }
 
 
@@ -7511,6 +8377,11 @@ markAtomsMessageQueue(message_queue *queue)
   for(msg=queue->head; msg; msg=msg->next)
   { markAtomsRecord(msg->message);
   }
+#ifdef O_PLMT
+  for(msg=queue->incoming; msg; msg=msg->next)
+  { markAtomsRecord(msg->message);
+  }
+#endif
 }
 
 
@@ -7520,6 +8391,10 @@ markAtomsThreadMessageQueue(PL_local_data_t *ld)
 
   simpleMutexLock(&q->gc_mutex);
   markAtomsMessageQueue(q);
+#ifdef O_PLMT
+  if ( ld->thread.in_transit )		/* see get_first_message() */
+    markAtomsRecord(ld->thread.in_transit);
+#endif
   simpleMutexUnlock(&q->gc_mutex);
 }
 
@@ -7644,6 +8519,12 @@ destroyLocalDefinitions(Definition def)
 			   "with active local definitions\n",
 			   predicateName(def)));
 
+	  if ( ld )				/* credit the owner's heap quota */
+	  { Definition local = d0[tid];
+
+	    creditThreadHeap(ld, local->clause_space);
+	    clear(local, P_LOCALISED);
+	  }
 	  unregisterLocalDefinition(def, ld);
 	  destroyLocalDefinition(def, tid);
 
@@ -7686,8 +8567,10 @@ localiseDefinition(Definition def)
     memcpy(local->impl.any.args, def->impl.any.args, bytes);
   }
   clear(local, P_THREAD_LOCAL|P_DIRTYREG);	/* remains P_DYNAMIC */
+  set(local, P_LOCALISED);
   local->impl.clauses.first_clause = NULL;
   local->impl.clauses.clause_indexes = NULL;
+  local->clause_space = 0;
   ATOMIC_INC(&GD->statistics.predicates);
   ATOMIC_ADD(&local->module->code_size, sizeof(*local));
   DEBUG(MSG_PRED_COUNT, Sdprintf("Localise def[%d] %s at %p\n",
@@ -7711,12 +8594,16 @@ cleanupLocalDefinitions(PL_local_data_t *ld)
     next = ch->next;
 
     if ( def )
-    { DEBUG(MSG_CLEANUP,
+    { Definition local;
+
+      DEBUG(MSG_CLEANUP,
 	    Sdprintf("Clean local def in thread %d for %s\n",
 		     id,
 		     predicateName(def)));
 
       assert(true(def, P_THREAD_LOCAL));
+      if ( (local=getProcDefinitionForThread(def, id)) )
+	clear(local, P_LOCALISED);	/* quota dies with the thread */
       destroyLocalDefinition(def, id);
     }
     freeHeap(ch, sizeof(*ch));
@@ -8379,8 +9266,11 @@ clear_low_c_stack(DECL_LD)
 BeginPredDefs(thread)
 #ifdef O_ENGINES
   PRED_DEF("thread_property",	     2,	thread_property,       NDET|PL_FA_ISO)
+  PRED_DEF("$thread_memory",	     2,	thread_memory,	       0)
   PRED_DEF("$engine_create",	     3,	engine_create,	       0)
   PRED_DEF("engine_destroy",	     1,	engine_destroy,	       0)
+  PRED_DEF("$engine_reset",	     1,	engine_reset,	       0)
+  PRED_DEF("$engine_reset",	     2,	engine_reset,	       0)
   PRED_DEF("engine_next",	     2,	engine_next,	       0)
   PRED_DEF("engine_post",	     2,	engine_post,	       0)
   PRED_DEF("engine_post",	     3,	engine_post,	       0)
@@ -8407,9 +9297,11 @@ BeginPredDefs(thread)
 
   PRED_DEF("thread_send_message",    2,	thread_send_message,   PL_FA_ISO)
   PRED_DEF("thread_send_message",    3,	thread_send_message,   0)
+  PRED_DEF("thread_send_messages",   2,	thread_send_messages,  0)
   PRED_DEF("thread_get_message",     1,	thread_get_message,    PL_FA_ISO)
   PRED_DEF("thread_get_message",     2,	thread_get_message,    PL_FA_ISO)
   PRED_DEF("thread_get_message",     3,	thread_get_message,    PL_FA_ISO)
+  PRED_DEF("thread_get_messages",    4,	thread_get_messages,   0)
   PRED_DEF("thread_peek_message",    1,	thread_peek_message_1, PL_FA_ISO)
   PRED_DEF("thread_peek_message",    2,	thread_peek_message_2, PL_FA_ISO)
   PRED_DEF("message_queue_destroy",  1,	message_queue_destroy, PL_FA_ISO)
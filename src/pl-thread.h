@@ -151,6 +151,8 @@ typedef struct _PL_thread_info_t
 #define TH_IS_INTERACTOR	0x0001	/* Thread is an interactor (engine) */
 #define TH_INTERACTOR_NOMORE	0x0002	/* No more answers */
 #define TH_INTERACTOR_DONE	0x0004	/* Answered last */
+#define TH_INTERACTOR_REUSE	0x0008	/* Keep engine after last answer */
+#define TH_INTERACTOR_IDLE	0x0010	/* Reset, waiting for a new goal */
 
 typedef struct thread_handle
 { PL_thread_info_t     *info;		/* represented engine */
@@ -184,6 +186,12 @@ typedef struct message_queue
   int		       waiting;		/* # waiting threads */
   int		       waiting_var;	/* # waiting with unbound */
   int		       wait_for_drain;	/* # threads waiting for write */
+  TableWP	       index;		/* Index on first argument */
+#ifdef O_PLMT
+  struct thread_message *incoming;	/* Messages sent without locking */
+  size_t	       pending;		/* # terms in incoming */
+  int		       senders;		/* # senders not holding mutex */
+#endif
   unsigned	anonymous : 1;		/* <message_queue>(0x...) */
   unsigned	initialized : 1;	/* Queue is initialised */
   unsigned	destroyed : 1;		/* Thread is being destroyed */
@@ -3019,7 +3019,7 @@ create_trie_clause(Definition def, Clause *cp, trie_compile_state *state)
   //size_t clsize    = size + SIZEOF_CREF_CLAUSE;
   Clause cl;
 
-  cl = PL_malloc_atomic(size);
+  cl = allocSlab(size);
   memset(cl, 0, sizeof(*cl));
   cl->predicate = def;
   cl->code_size = code_size;
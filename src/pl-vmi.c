@@ -3413,6 +3413,12 @@ VMI(S_STATIC, 0, 0, ())
   ARGP = argFrameP(FR, 0);
   lTop = (LocalFrame)ARGP+DEF->functor->arity;
 
+  if ( DEF->codes == SUPERVISOR(staticp) &&
+       --LD->hot_predicates.countdown <= 0 )
+  { LD->hot_predicates.countdown = GD->hot_predicates.sample_rate;
+    sampleHotPredicate(DEF);
+  }
+
   DEBUG(9, Sdprintf("Searching clause ... "));
 
   if ( !(cl = firstClause(ARGP, FR, DEF, &chp)) )
@@ -3739,6 +3745,38 @@ VMI(S_LIST, 0, 2, (CA1_CLAUSEREF, CA1_CLAUSEREF))
 END_VMI
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+S_SWITCH: Hot static predicate  where  each   clause  has  a  different
+first argument key.  See createHotSupervisor().   We fall back to
+S_STATIC if the first argument  is  unbound,   the  clause  is  not
+visible  or  the  key  is  unknown  while  some  clauses  are  erased.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+VMI(S_SWITCH, 0, 1, (CA1_DATA))
+{ HotSwitch hs = code2ptr(HotSwitch, *PC++);
+  ClauseRef cref;
+  Word k;
+
+  ARGP = argFrameP(FR, 0);
+  deRef2(ARGP, k);
+  if ( canBind(*k) )
+    goto generic;
+
+  if ( (cref = hotSwitchClause(hs, getIndexOfWord(*k))) )
+  { if ( visibleClauseCNT(cref->value.clause, generationFrame(FR)) )
+    { TRUST_CLAUSE(cref);
+    }
+  } else if ( !DEF->impl.clauses.erased_clauses )
+  { FRAME_FAILED;
+  }
+
+generic:
+  PC = SUPERVISOR(staticp) + 1;
+  VMI_GOTO(S_STATIC);
+}
+END_VMI
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Meta-predicate  argument  qualification.  S_MQUAL    qualifies  the  Nth
 argument. S_LMQUAL does the same and resets   the  context module of the
@@ -4080,25 +4118,86 @@ VMI(A_ROUNDTOWARDS_V, 0, 1, (CA1_VAR))
 END_VMI
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Type specialised fast path for A_ADD, A_SUB, A_MUL and A_DIV. If both
+arguments are integers or both are   floats,  the result is computed in
+place on the arithmetic stack. This avoids  calling pl-arith.c and thus
+saving and restoring the VM  registers,  so   chains  of  operations on
+floats keep their intermediate values  unboxed   as  plain doubles. We
+fall back to the generic  function   on  integer  overflow (promotion to
+big integers) and if a  float  result   is  not  normal,  as the float
+flags decide whether infinite, NaN or subnormal results are errors.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#if HAVE___BUILTIN_MUL_OVERFLOW
+#define AR_FAST_INT(builtin)					\
+	{ Number n2 = argvArithStack(2);			\
+	  Number n1 = n2+1;	/* pushed right to left */	\
+	  int64_t r;						\
+								\
+	  if ( n1->type == V_INTEGER && n2->type == V_INTEGER &&	\
+	       !builtin(n1->value.i, n2->value.i, &r) )		\
+	  { n2->value.i = r;					\
+	    LD->arith.stack.top--;				\
+	    NEXT_INSTRUCTION;					\
+	  }							\
+	}
+#else
+#define AR_FAST_INT(builtin) (void)0
+#endif
+
+#define AR_FAST_FLOAT(op)					\
+	{ Number n2 = argvArithStack(2);			\
+	  Number n1 = n2+1;					\
+								\
+	  if ( n1->type == V_FLOAT && n2->type == V_FLOAT )	\
+	  { double r = n1->value.f op n2->value.f;		\
+								\
+	    if ( isnormal(r) || r == 0.0 )			\
+	    { n2->value.f = r;					\
+	      LD->arith.stack.top--;				\
+	      NEXT_INSTRUCTION;					\
+	    }							\
+	  }							\
+	}
+
+#define AR_BINOP(func)						\
+	{ Number argv = argvArithStack(2);			\
+	  int rc;						\
+	  number r;						\
+								\
+	  SAVE_REGISTERS(QID);					\
+	  rc = func(argv+1, argv, &r);				\
+	  LOAD_REGISTERS(QID);					\
+	  popArgvArithStack(2);					\
+	  if ( rc )						\
+	  { pushArithStack(&r);					\
+	    NEXT_INSTRUCTION;					\
+	  }							\
+								\
+	  AR_THROW_EXCEPTION;					\
+	}
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 A_ADD: Shorthand for A_FUNC2 pl_ar_add()
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 VMI(A_ADD, 0, 0, ())
-{ Number argv = argvArithStack(2);
-  int rc;
-  number r;
+{ AR_FAST_INT(__builtin_add_overflow);
+  AR_FAST_FLOAT(+);
+  AR_BINOP(pl_ar_add);
+}
+END_VMI
 
-  SAVE_REGISTERS(QID);
-  rc = pl_ar_add(argv+1, argv, &r);
-  LOAD_REGISTERS(QID);
-  popArgvArithStack(2);
-  if ( rc )
-  { pushArithStack(&r);
-    NEXT_INSTRUCTION;
-  }
 
-  AR_THROW_EXCEPTION;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A_SUB: Shorthand for A_FUNC2 ar_minus()
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+VMI(A_SUB, 0, 0, ())
+{ AR_FAST_INT(__builtin_sub_overflow);
+  AR_FAST_FLOAT(-);
+  AR_BINOP(ar_minus);
 }
 END_VMI
 
@@ -4108,20 +4207,22 @@ A_MUL: Shorthand for A_FUNC2 ar_mul()
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 VMI(A_MUL, 0, 0, ())
-{ Number argv = argvArithStack(2);
-  int rc;
-  number r;
+{ AR_FAST_INT(__builtin_mul_overflow);
+  AR_FAST_FLOAT(*);
+  AR_BINOP(ar_mul);
+}
+END_VMI
 
-  SAVE_REGISTERS(QID);
-  rc = ar_mul(argv+1, argv, &r);
-  LOAD_REGISTERS(QID);
-  popArgvArithStack(2);
-  if ( rc )
-  { pushArithStack(&r);
-    NEXT_INSTRUCTION;
-  }
 
-  AR_THROW_EXCEPTION;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A_DIV: Shorthand for A_FUNC2 ar_divide().  Only float division has a
+fast path as integer division depends on the iso and prefer_rationals
+flags.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+VMI(A_DIV, 0, 0, ())
+{ AR_FAST_FLOAT(/);
+  AR_BINOP(ar_divide);
 }
 END_VMI
 
@@ -4404,6 +4505,16 @@ VMI(A_FIRSTVAR_IS, VIF_BREAK, 1, (CA1_FVAR)) /* A is B */
   word w;
   int rc;
 
+  if ( n->type == V_INTEGER )		/* no need to box */
+  { w = consInt(n->value.i);
+    if ( valInt(w) == n->value.i )
+    { LD->arith.stack.top--;
+      AR_END();
+      *varFrameP(FR, *PC++) = w;
+      NEXT_INSTRUCTION;
+    }
+  }
+
   SAVE_REGISTERS(QID);
   if ( (rc = put_number(&w, n, ALLOW_GC)) != TRUE )
     rc = raiseStackOverflow(rc);
@@ -66,6 +66,7 @@
 #include "pl-cont.h"
 #include "pl-coverage.h"
 #include <fenv.h>
+#include <math.h>
 #ifdef _MSC_VER
 #pragma warning(disable: 4102)		/* unreferenced labels */
 #endif
@@ -1515,6 +1516,8 @@ __do_undo(DECL_LD mark *m)
 	});
 
   gTop = ngtop;
+  if ( LD->gen_bar > ngtop )
+    LD->gen_bar = ngtop;
 }
 
 
@@ -3053,7 +3056,15 @@ typedef struct register_file
  * and just before exit from an instruction (i.e. before goto/return/etc).
  * For profiling/tracing purposes only, and not applied to VMH's.
  */
+#ifdef O_VMI_PAIR_PROFILE
+#define countVMIPair(n) \
+	{ GD->vmi_profile.pairs[LD->vmi_profile.prev*I_HIGHEST+(n)]++; \
+	  LD->vmi_profile.prev = (n); \
+	}
+#define VMI_ENTER(n)		countVMIPair(n);
+#else
 #define VMI_ENTER(n)		(void)(n);
+#endif
 #define VMI_EXIT		(void)0;
 
 /* Components of VMI/VMH macro expansion. The underscore-prefix macros